@@ -10,12 +10,32 @@
  * Main Features:
  * - Endpoint to download firmware binaries:      GET /firmware/:filename
  * - Endpoint to get firmware version string:     GET /version/:filename
+ * - Endpoint to get the SHA-256 of a firmware:   GET /hash/:filename
+ *   (devices verify images fetched from peers on the LAN against it, see src/OTA_Peer.h)
+ * - Endpoint to get the manifest of a firmware:  GET /manifest/:filename
+ *   (size and SHA-256, signed with OTA_SIGNING_KEY if set, see src/OTA_Verify.h)
+ * - File list of the LittleFS files of a firmware:  GET /fsmanifest/:filename
+ *   and the files themselves:                      GET /fs/:filename/<path>
+ *   (from updates/fs/<firmware>/, devices load only changed files, see src/OTA_FileSync.h)
+ * - Sends images by UDP multicast carousel on request of the devices, see src/OTA_Multicast.h.
+ * - Answers the version query by CoAP (UDP port OTA_COAP_PORT, default 5683):
+ *   GET coap://<server>/version/:filename, see src/OTA_Coap.h.
+ * - Advertises itself by mDNS/DNS-SD as service _ota._tcp.local, so devices configured with
+ *   the OTA server "auto" find it without a fixed address, see src/OTA_Dns.h.
  * - Static access to the updates directory:      GET /updates/...
  * - Logs all incoming HTTP requests and file accesses.
+ * - Announces the versions in the updates directory as UDP multicast beacons
+ *   ("OTA1 <firmware> <version>", every 30 s and on changes), see src/OTA_Notify.h.
  *
  * Usage:
  * 1. Place your firmware binary (e.g., firmware.bin) and its version file (e.g., firmware.bin.version) in the 'updates' directory.
  * 2. Start the server with: node ota-server.js
+ *    (the environment variables OTA_PORT and OTA_UPDATES_DIR override port and updates directory)
+ *    Signed manifests: create a P-256 key once with
+ *      openssl ecparam -name prime256v1 -genkey -noout -out signing.pem
+ *    and start with OTA_SIGNING_KEY=signing.pem; the public key for OTA_VERIFY_KEY is printed at startup.
+ *    HTTPS: OTA_TLS_CERT and OTA_TLS_KEY (PEM files) serve everything over TLS instead of HTTP,
+ *    for devices built with OTA_HTTPS=1 (see src/OTA_Client.h).
  * 3. Configure your ESP8266/ESP32 devices to use this server for OTA updates.
  *
  *
@@ -39,16 +59,28 @@
 
 
 const express = require('express');
+const crypto = require('crypto');
+const https = require('https');
+const dgram = require('dgram');
 const fs = require('fs');
+const os = require('os');
 const path = require('path');
 
 const app = express();
-const PORT = 3000;
+const PORT = process.env.OTA_PORT || 3000;            // Port can be overridden, e.g. for tools/native_e2e.py
 
 // --- Configuration ---
-const UPDATES_DIR = path.join(__dirname, 'updates'); // Directory for firmware updates
+const UPDATES_DIR = process.env.OTA_UPDATES_DIR || path.join(__dirname, 'updates'); // Directory for firmware updates
 const FIRMWARE_FILE = path.join(UPDATES_DIR, 'firmware.bin');
 const VERSION_FILE = path.join(UPDATES_DIR, 'firmware.bin.version');
+const BEACON_GROUP = process.env.OTA_BEACON_GROUP || '239.255.0.88'; // OTA_NOTIFY_GROUP of the devices
+const BEACON_PORT = process.env.OTA_BEACON_PORT || 3001;              // OTA_NOTIFY_PORT of the devices
+const BEACON_INTERVAL = 30000;                                         // Heartbeat in ms (devices: OTA_NOTIFY_SILENCE = 3 intervals)
+const BEACON_INTERFACE = process.env.OTA_BEACON_INTERFACE;             // Local address of the LAN interface (default: system choice)
+const SIGNING_KEY = process.env.OTA_SIGNING_KEY;                       // PEM file of the P-256 manifest signing key (optional)
+const TLS_CERT = process.env.OTA_TLS_CERT;                             // PEM files of certificate and key: HTTPS instead of HTTP
+const TLS_KEY = process.env.OTA_TLS_KEY;
+const TLS_SESSIONS = 1000;                                             // TLS sessions kept for resumption
 
 // --- Middleware ---
 
@@ -117,11 +149,469 @@ app.get('/version/:filename', (req, res) => {
   res.send(firmwareVersion);
 });
 
+const hashCache = new Map(); // file -> { mtimeMs, size, hash }
+
+/**
+ * Returns the SHA-256 (hex) of a file, recomputed only when the file changed; null if it does not exist.
+ * @param {string} file - Path of the firmware file
+ */
+function imageHash(file) {
+  let stat;
+  try {
+    stat = fs.statSync(file);
+  } catch (err) {
+    return null;
+  }
+  let entry = hashCache.get(file);
+  if (!entry || entry.mtimeMs !== stat.mtimeMs || entry.size !== stat.size) {
+    const hash = crypto.createHash('sha256').update(fs.readFileSync(file)).digest('hex');
+    entry = { mtimeMs: stat.mtimeMs, size: stat.size, hash };
+    hashCache.set(file, entry);
+  }
+  return entry.hash;
+}
+
+/**
+ * Returns the SHA-256 (hex) of a firmware file.
+ * Example: GET /hash/firmware.bin
+ */
+app.get('/hash/:filename', (req, res) => {
+  const hash = imageHash(path.join(UPDATES_DIR, req.params.filename));
+  if (!hash) return res.status(404).send('Firmware file not found.');
+  res.send(hash);
+});
+
+// --- Signed Manifests ---
+
+let signingKey = null;
+if (SIGNING_KEY) {
+  signingKey = crypto.createPrivateKey(fs.readFileSync(SIGNING_KEY));
+  if (signingKey.asymmetricKeyType !== 'ec' ||
+      (signingKey.asymmetricKeyDetails && signingKey.asymmetricKeyDetails.namedCurve !== 'prime256v1')) {
+    console.error(`${SIGNING_KEY} is not a P-256 (prime256v1) key`);
+    process.exit(1);
+  }
+}
+
+/**
+ * Returns the manifest of a firmware file:
+ * "OTA1M <firmware> <version> <size> <sha256>" and, with a signing key, the ECDSA
+ * signature (DER, hex) of this line in a second line. The version is "-" without
+ * a version file <firmware>.version; such a manifest is not signed (404), a signed
+ * manifest without version would let any older image pass as update.
+ * Example: GET /manifest/firmware.bin
+ */
+app.get('/manifest/:filename', (req, res) => {
+  const name = path.basename(req.params.filename);
+  const file = path.join(UPDATES_DIR, name);
+  const hash = imageHash(file);
+  if (!hash) return res.status(404).send('Firmware file not found.');
+  let version = fs.existsSync(file + '.version') ? getFirmwareVersion(file + '.version') : '-';
+  if (version === 'unknown' || version.includes(' ')) version = '-';
+  if (signingKey && version === '-') return res.status(404).send('Firmware version not found, manifest not signed.');
+  const line = `OTA1M ${name} ${version} ${fs.statSync(file).size} ${hash}`;
+  const signature = signingKey ? crypto.sign('sha256', Buffer.from(line), signingKey).toString('hex') : '';
+  res.setHeader('Content-Type', 'text/plain');
+  res.send(`${line}\n${signature}\n`);
+});
+
+// --- File System Sync ---
+
+const FS_DIR = path.join(UPDATES_DIR, 'fs'); // updates/fs/<firmware>/<files>
+const FS_PATH = /^[A-Za-z0-9._\/-]+$/;      // Paths the devices accept (OTA_FileSync.cpp)
+
+/**
+ * Returns the files below dir as paths relative to root ("/data/table.bin"), sorted.
+ */
+function listFiles(root, dir = root) {
+  let files = [];
+  for (const entry of fs.readdirSync(dir, { withFileTypes: true })) {
+    const file = path.join(dir, entry.name);
+    if (entry.isDirectory()) {
+      files = files.concat(listFiles(root, file));
+    } else if (entry.isFile()) {
+      files.push('/' + path.relative(root, file).split(path.sep).join('/'));
+    }
+  }
+  return files.sort();
+}
+
+/**
+ * Returns the file list of a firmware:
+ * "OTA1F <files> <sha256 of the entries>", the signature of this line (empty without
+ * signing key) and "<sha256> <size> <path>" per file. The hash of the entries is the
+ * ETag: devices that have installed this list get 304.
+ * Example: GET /fsmanifest/firmware.bin
+ */
+app.get('/fsmanifest/:filename', (req, res) => {
+  const root = path.join(FS_DIR, path.basename(req.params.filename));
+  if (!fs.existsSync(root)) return res.status(404).send('No files for this firmware.');
+  let entries = '';
+  let count = 0;
+  listFiles(root).forEach((name) => {
+    if (!FS_PATH.test(name) || name.includes('..') || name.startsWith('/.otafs')) {
+      console.warn(`File ${name} skipped: path not supported by the devices`);
+      return;
+    }
+    const file = path.join(root, name);
+    entries += `${imageHash(file)} ${fs.statSync(file).size} ${name}\n`;
+    count++;
+  });
+  const hash = crypto.createHash('sha256').update(entries).digest('hex');
+  res.setHeader('ETag', `"${hash}"`);
+  if (req.headers['if-none-match'] === `"${hash}"`) return res.status(304).end();
+  const line = `OTA1F ${count} ${hash}`;
+  const signature = signingKey ? crypto.sign('sha256', Buffer.from(line), signingKey).toString('hex') : '';
+  res.setHeader('Content-Type', 'text/plain');
+  res.send(`${line}\n${signature}\n${entries}`);
+});
+
+app.use('/fs', express.static(FS_DIR));
+
+// --- Update Beacons ---
+
+const beacon = dgram.createSocket({ type: 'udp4', reuseAddr: true });
+
+/**
+ * Sends one beacon "OTA1 <firmware> <version>" for every firmware file <firmware>
+ * that has a version file <firmware>.version in the updates directory.
+ */
+function sendBeacons() {
+  let files;
+  try {
+    files = fs.readdirSync(UPDATES_DIR);
+  } catch (err) {
+    return;
+  }
+  files.filter((f) => f.endsWith('.version') && files.includes(f.slice(0, -8))).forEach((f) => {
+    const version = getFirmwareVersion(path.join(UPDATES_DIR, f));
+    if (version === 'unknown' || version.includes(' ')) return;
+    const msg = Buffer.from(`OTA1 ${f.slice(0, -8)} ${version}`);
+    beacon.send(msg, BEACON_PORT, BEACON_GROUP, (err) => {
+      if (err) console.error('Error sending beacon:', err.message);
+    });
+  });
+}
+
+beacon.bind(() => {
+  beacon.setMulticastTTL(1);         // LAN only
+  beacon.setMulticastLoopback(true); // Devices emulated on this machine (native build)
+  if (BEACON_INTERFACE) beacon.setMulticastInterface(BEACON_INTERFACE);
+  sendBeacons();
+  setInterval(sendBeacons, BEACON_INTERVAL);
+  // Announce new versions right away; several events of one copy are combined
+  let pending = null;
+  try {
+    fs.watch(UPDATES_DIR, () => {
+      clearTimeout(pending);
+      pending = setTimeout(sendBeacons, 500);
+    });
+  } catch (err) {
+    console.warn('Updates directory not watched:', err.message);
+  }
+});
+
+// --- Multicast Carousel ---
+// Sends an image once for all devices of the site (src/OTA_Multicast.h): on a request
+// "OTA1MR <firmware>" the server answers with an INFO packet and starts a pass after
+// MCAST_DELAY, so all devices triggered by the same beacon receive the same pass.
+// Each group of MCAST_K data blocks is followed by an XOR parity block.
+
+const MCAST_GROUP = process.env.OTA_MCAST_GROUP || '239.255.0.89';   // OTA_MCAST_GROUP of the devices
+const MCAST_PORT = Number(process.env.OTA_MCAST_PORT || 3003);        // OTA_MCAST_PORT of the devices
+const MCAST_RATE = Number(process.env.OTA_MCAST_RATE || 200);         // Send rate in kB/s
+const MCAST_DELAY = Number(process.env.OTA_MCAST_DELAY || 8000);      // Requests are collected this long (ms)
+const MCAST_BLOCK = 1024;                                             // Block size (devices: <= OTA_MCAST_BLOCK)
+const MCAST_K = 8;                                                    // Data blocks per parity block
+
+const MCAST = { INFO: 1, DATA: 2, PARITY: 3, END: 4 };
+const carousels = new Map(); // firmware -> pass state
+const mcast = dgram.createSocket({ type: 'udp4', reuseAddr: true });
+
+function mcastPacket(type, image, index, payload) {
+  const head = Buffer.alloc(20);
+  head.write('OTAM', 0);
+  head[4] = type;
+  head[5] = MCAST_K;
+  head.writeUInt16BE(MCAST_BLOCK, 6);
+  head.writeUInt32BE(image.session, 8);
+  head.writeUInt32BE(image.data.length, 12);
+  head.writeUInt32BE(index, 16);
+  return Buffer.concat([head, payload]);
+}
+
+function mcastSend(buf) {
+  mcast.send(buf, MCAST_PORT, MCAST_GROUP, (err) => {
+    if (err) console.error('Error sending multicast packet:', err.message);
+  });
+}
+
+/**
+ * Loads a firmware with hash and version for a pass, null if it has no version file.
+ */
+function mcastImage(name) {
+  const file = path.join(UPDATES_DIR, path.basename(name));
+  const hash = imageHash(file);
+  const version = getFirmwareVersion(file + '.version');
+  if (!hash || version === 'unknown') return null;
+  return { name: path.basename(name), data: fs.readFileSync(file), hash, version,
+           session: parseInt(hash.slice(0, 8), 16) };
+}
+
+function mcastInfo(image) {
+  mcastSend(mcastPacket(MCAST.INFO, image, 0, Buffer.from(`${image.name} ${image.version} ${image.hash}`)));
+}
+
+/**
+ * Sends one pass: data blocks and a parity block per group, paced to MCAST_RATE.
+ */
+function mcastPass(image) {
+  const blocks = Math.ceil(image.data.length / MCAST_BLOCK);
+  const packets = [];
+  for (let g = 0; g * MCAST_K < blocks; g++) {
+    const parity = Buffer.alloc(MCAST_BLOCK);
+    for (let i = g * MCAST_K; i < Math.min(blocks, (g + 1) * MCAST_K); i++) {
+      const block = image.data.subarray(i * MCAST_BLOCK, (i + 1) * MCAST_BLOCK);
+      for (let j = 0; j < block.length; j++) parity[j] ^= block[j];
+      packets.push(mcastPacket(MCAST.DATA, image, i, block));
+    }
+    packets.push(mcastPacket(MCAST.PARITY, image, g, parity));
+  }
+  for (let i = 0; i < 3; i++) packets.push(mcastPacket(MCAST.END, image, 0, Buffer.alloc(0)));
+
+  const started = Date.now();
+  const tick = 20; // ms
+  const perTick = Math.max(1, Math.round((MCAST_RATE * 1024 * tick) / 1000 / (MCAST_BLOCK + 20)));
+  let next = 0;
+  let bytes = 0;
+  const timer = setInterval(() => {
+    for (let i = 0; i < perTick && next < packets.length; i++, next++) {
+      mcastSend(packets[next]);
+      bytes += packets[next].length;
+    }
+    if (next < packets.length) return;
+    clearInterval(timer);
+    carousels.delete(image.name);
+    console.log(`Multicast pass of ${image.name} ${image.version}: ${packets.length} packets, ${bytes} bytes in ${(Date.now() - started) / 1000} s`);
+  }, tick);
+}
+
+mcast.on('message', (msg) => {
+  const m = /^OTA1MR (\S+)$/.exec(msg.toString());
+  if (!m) return;
+  const image = mcastImage(m[1]);
+  if (!image) return;
+  mcastInfo(image);
+  if (carousels.has(image.name)) return; // Pass scheduled or running
+  carousels.set(image.name, true);
+  console.log(`Multicast pass of ${image.name} requested, starting in ${MCAST_DELAY / 1000} s`);
+  setTimeout(() => mcastPass(mcastImage(m[1]) || image), MCAST_DELAY);
+});
+
+mcast.bind(MCAST_PORT, () => {
+  mcast.setMulticastTTL(1);
+  mcast.setMulticastLoopback(true);
+  if (BEACON_INTERFACE) mcast.setMulticastInterface(BEACON_INTERFACE);
+  mcast.addMembership(MCAST_GROUP, BEACON_INTERFACE);
+});
+
+// --- CoAP Version Check ---
+// Devices built with OTA_COAP=1 ask for the version by one CoAP request (src/OTA_Coap.h)
+// instead of an HTTP connection. Only GET /version/<file> is served; a confirmable
+// request is answered with a piggybacked ACK, a retransmitted one again (GET is safe).
+
+const COAP_PORT = Number(process.env.OTA_COAP_PORT || 5683);          // OTA_COAP_PORT of the devices
+const COAP = { CON: 0, NON: 1, ACK: 2, RST: 3, GET: 0x01, CONTENT: 0x45, NOT_FOUND: 0x84, METHOD_NOT_ALLOWED: 0x85 };
+const coap = dgram.createSocket({ type: 'udp4', reuseAddr: true });
+let coapMessageId = Math.floor(Math.random() * 0x10000);
+
+/**
+ * Parses a CoAP message: { type, code, id, token, path }, null if malformed.
+ */
+function coapParse(msg) {
+  if (msg.length < 4 || msg[0] >> 6 !== 1 || (msg[0] & 0x0f) > 8) return null;
+  const tkl = msg[0] & 0x0f;
+  const m = { type: (msg[0] >> 4) & 0x03, code: msg[1], id: msg.readUInt16BE(2), token: msg.subarray(4, 4 + tkl), path: [] };
+  let pos = 4 + tkl;
+  let number = 0;
+  while (pos < msg.length && msg[pos] !== 0xff) {
+    let delta = msg[pos] >> 4;
+    let len = msg[pos] & 0x0f;
+    pos++;
+    if (delta === 15 || len === 15) return null;
+    if (delta === 13) delta = msg[pos++] + 13;
+    else if (delta === 14) { delta = msg.readUInt16BE(pos) + 269; pos += 2; }
+    if (len === 13) len = msg[pos++] + 13;
+    else if (len === 14) { len = msg.readUInt16BE(pos) + 269; pos += 2; }
+    number += delta;
+    if (pos + len > msg.length) return null;
+    if (number === 11) m.path.push(msg.toString('utf8', pos, pos + len)); // Uri-Path
+    pos += len;
+  }
+  return m;
+}
+
+function coapReply(req, rinfo, code, payload) {
+  const con = req.type === COAP.CON;
+  const head = Buffer.from([0x40 | ((con ? COAP.ACK : COAP.NON) << 4) | req.token.length, code, 0, 0]);
+  head.writeUInt16BE(con ? req.id : (coapMessageId = (coapMessageId + 1) & 0xffff), 2);
+  const parts = [head, req.token];
+  if (payload) parts.push(Buffer.from([0xc1, 0]), Buffer.from([0xff]), Buffer.from(payload)); // Content-Format text/plain
+  coap.send(Buffer.concat(parts), rinfo.port, rinfo.address, (err) => {
+    if (err) console.error('Error sending CoAP response:', err.message);
+  });
+}
+
+coap.on('message', (msg, rinfo) => {
+  const req = coapParse(msg);
+  if (!req || req.type > COAP.NON) return;
+  if (req.code === 0) return coapReply(req, rinfo, 0, null); // Ping: empty ACK
+  if (req.code !== COAP.GET) return coapReply(req, rinfo, COAP.METHOD_NOT_ALLOWED, null);
+  if (req.path.length !== 2 || req.path[0] !== 'version') return coapReply(req, rinfo, COAP.NOT_FOUND, null);
+  console.log(`CoAP request from ${rinfo.address}: /version/${req.path[1]}`);
+  // Same answer as GET /version/:filename, the device handles both alike
+  coapReply(req, rinfo, COAP.CONTENT, getFirmwareVersion(path.join(UPDATES_DIR, path.basename(req.path[1]))));
+});
+
+coap.on('error', (err) => console.warn('CoAP not started:', err.message));
+coap.bind(COAP_PORT);
+
+// --- mDNS / DNS-SD ---
+// Answers the DNS-SD query of the devices (src/OTA_Dns.h) for MDNS_SERVICE with PTR,
+// SRV, TXT and A record, and A queries for MDNS_HOST. Queries from a port other than
+// 5353 are one-shot queries (RFC 6762, 6.7) and answered by unicast to the sender.
+
+const MDNS_ENABLED = process.env.OTA_MDNS !== '0';                    // OTA_MDNS=0 disables the responder
+const MDNS_SERVICE = '_ota._tcp.local';                               // OTA_DNS_SD_SERVICE of the devices
+const MDNS_NAME = (process.env.OTA_MDNS_NAME || os.hostname().split('.')[0]).replace(/[^A-Za-z0-9-]/g, '-');
+const MDNS_HOST = `${MDNS_NAME}.local`;
+const MDNS_INSTANCE = `${MDNS_NAME}.${MDNS_SERVICE}`;
+const MDNS_TTL = 120;                                                 // TTL of the records (s)
+
+const mdns = dgram.createSocket({ type: 'udp4', reuseAddr: true });
+
+/**
+ * Returns the address announced in the A record: BEACON_INTERFACE or the first LAN address.
+ */
+function mdnsAddress() {
+  if (BEACON_INTERFACE) return BEACON_INTERFACE;
+  for (const list of Object.values(os.networkInterfaces())) {
+    const found = list.find((a) => a.family === 'IPv4' && !a.internal);
+    if (found) return found.address;
+  }
+  return '127.0.0.1';
+}
+
+function mdnsName(name) {
+  return Buffer.concat([...name.split('.').map((l) => Buffer.concat([Buffer.from([l.length]), Buffer.from(l)])),
+                        Buffer.from([0])]);
+}
+
+function mdnsRecord(name, type, ttl, data) {
+  const head = Buffer.alloc(10);
+  head.writeUInt16BE(type, 0);
+  head.writeUInt16BE(0x8001, 2); // Class IN, cache flush
+  head.writeUInt32BE(ttl, 4);
+  head.writeUInt16BE(data.length, 8);
+  return Buffer.concat([mdnsName(name), head, data]);
+}
+
+/**
+ * Reads the questions of a query as [{ name, type, end }], null if malformed.
+ */
+function mdnsQuestions(msg) {
+  const questions = [];
+  let pos = 12;
+  for (let i = 0; i < msg.readUInt16BE(4); i++) {
+    const labels = [];
+    while (pos < msg.length && msg[pos] !== 0) {
+      if (msg[pos] >= 0xc0) return null; // No compression in questions of the devices
+      labels.push(msg.toString('latin1', pos + 1, pos + 1 + msg[pos]));
+      pos += msg[pos] + 1;
+    }
+    if (pos + 5 > msg.length) return null;
+    questions.push({ name: labels.join('.').toLowerCase(), type: msg.readUInt16BE(pos + 1) });
+    pos += 5;
+  }
+  return { questions, end: pos };
+}
+
+mdns.on('message', (msg, rinfo) => {
+  if (msg.length < 12 || msg[2] & 0x80) return; // Responses of other hosts
+  const parsed = mdnsQuestions(msg);
+  if (!parsed) return;
+  const unicast = rinfo.port !== 5353;
+  const ttl = unicast ? Math.min(MDNS_TTL, 10) : MDNS_TTL; // RFC 6762: max. 10 s in one-shot answers
+  const addr = Buffer.from(mdnsAddress().split('.').map(Number));
+  const srv = Buffer.alloc(6);
+  srv.writeUInt16BE(Number(PORT), 4);
+  const txt = Buffer.from(`\x07https=${TLS_CERT ? 1 : 0}`); // One TXT string
+  const answers = [];
+  const additional = [];
+  parsed.questions.forEach((q) => {
+    if (q.name === MDNS_SERVICE.toLowerCase() && (q.type === 12 || q.type === 255)) {
+      answers.push(mdnsRecord(MDNS_SERVICE, 12, ttl, mdnsName(MDNS_INSTANCE)));
+      additional.push(mdnsRecord(MDNS_INSTANCE, 33, ttl, Buffer.concat([srv, mdnsName(MDNS_HOST)])),
+                      mdnsRecord(MDNS_INSTANCE, 16, ttl, txt),
+                      mdnsRecord(MDNS_HOST, 1, ttl, addr));
+    } else if (q.name === MDNS_HOST.toLowerCase() && (q.type === 1 || q.type === 255)) {
+      answers.push(mdnsRecord(MDNS_HOST, 1, ttl, addr));
+    }
+  });
+  if (!answers.length) return;
+  const head = Buffer.alloc(12);
+  if (unicast) head.writeUInt16BE(msg.readUInt16BE(0), 0);
+  head.writeUInt16BE(0x8400, 2); // Response, authoritative
+  head.writeUInt16BE(unicast ? parsed.questions.length : 0, 4);
+  head.writeUInt16BE(answers.length, 6);
+  head.writeUInt16BE(additional.length, 10);
+  const reply = Buffer.concat([head, unicast ? msg.subarray(12, parsed.end) : Buffer.alloc(0), ...answers, ...additional]);
+  mdns.send(reply, unicast ? rinfo.port : 5353, unicast ? rinfo.address : '224.0.0.251', (err) => {
+    if (err) console.error('Error sending mDNS answer:', err.message);
+  });
+});
+
+if (MDNS_ENABLED) {
+  mdns.on('error', (err) => console.warn('mDNS responder not started:', err.message));
+  mdns.bind(5353, () => {
+    mdns.setMulticastTTL(255);
+    mdns.setMulticastLoopback(true);
+    if (BEACON_INTERFACE) mdns.setMulticastInterface(BEACON_INTERFACE);
+    mdns.addMembership('224.0.0.251', BEACON_INTERFACE);
+  });
+}
+
 // --- Server Startup ---
-// listen to all interfaces on the specified port
-app.listen(PORT, '0.0.0.0', () => {
-  console.log(`OTA Update Server running at http://localhost:${PORT}`);
+
+function listening() {
+  console.log(`OTA Update Server running at ${TLS_CERT ? 'https' : 'http'}://localhost:${PORT}`);
   console.log(`Firmware directory: ${UPDATES_DIR}`);
   console.log(`Firmware file: ${FIRMWARE_FILE}`);
   console.log(`Firmware version file: ${VERSION_FILE}`);
-});
+  console.log(`Update beacons to ${BEACON_GROUP}:${BEACON_PORT} every ${BEACON_INTERVAL / 1000} s`);
+  console.log(`Multicast carousel on ${MCAST_GROUP}:${MCAST_PORT} at ${MCAST_RATE} kB/s`);
+  console.log(`CoAP version check on UDP port ${COAP_PORT}`);
+  if (MDNS_ENABLED) console.log(`mDNS: ${MDNS_INSTANCE} at ${MDNS_HOST} (${mdnsAddress()}) port ${PORT}`);
+  if (signingKey) {
+    const pub = crypto.createPublicKey(signingKey).export({ type: 'spki', format: 'der' }).toString('hex');
+    console.log(`Manifests signed with ${SIGNING_KEY}, device key: -DOTA_VERIFY_KEY=\\"${pub}\\"`);
+  } else {
+    console.log('Manifests unsigned (OTA_SIGNING_KEY not set)');
+  }
+}
+
+// listen to all interfaces on the specified port
+if (TLS_CERT && TLS_KEY) {
+  const tlsServer = https.createServer({ cert: fs.readFileSync(TLS_CERT), key: fs.readFileSync(TLS_KEY) }, app);
+  // Session cache for resumption by session ID: BearSSL (ESP8266) does not use session tickets
+  const sessions = new Map();
+  tlsServer.on('newSession', (id, data, cb) => {
+    sessions.set(id.toString('hex'), data);
+    if (sessions.size > TLS_SESSIONS) sessions.delete(sessions.keys().next().value);
+    cb();
+  });
+  tlsServer.on('resumeSession', (id, cb) => cb(null, sessions.get(id.toString('hex')) || null));
+  tlsServer.listen(PORT, '0.0.0.0', listening);
+} else {
+  app.listen(PORT, '0.0.0.0', listening);
+}
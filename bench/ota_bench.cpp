@@ -0,0 +1,226 @@
+/**
+ * ota_bench.cpp
+ *
+ * Host microbenchmarks for the hot functions of the OTA Template (pio run -e native-bench).
+ * Every benchmark reports the time per call and the number and size of heap allocations
+ * per call. Allocations are counted by replacing the global operator new; the host String
+ * is based on std::string, so String allocations are included (small strings up to 15
+ * characters are stored inline, like the SSO of the ESP32 core).
+ *
+ * The results are written as JSON to stdout; tools/run_bench.py compares them with
+ * bench/baseline.json.
+ *
+ * Usage: program [--filter NAME] [--min-time MS]
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <chrono>
+#include <new>
+#include <stdlib.h>
+#include "OTA_Template.h"
+#include "OTA_WebForm.h"
+
+#ifndef BENCH_MIN_TIME
+#define BENCH_MIN_TIME 50          // Min. duration of one measurement batch in milliseconds
+#endif
+#define BENCH_BATCHES 5            // Batches per benchmark, the fastest one is reported
+
+// --- Allocation counting ---
+
+static bool counting = false;
+static uint64_t allocCount = 0;
+static uint64_t allocBytes = 0;
+
+static void *countedAlloc(size_t size) {
+  if (counting) {
+    allocCount++;
+    allocBytes += size;
+  }
+  return malloc(size ? size : 1);
+}
+
+void *operator new(size_t size) {
+  void *p = countedAlloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t size) {
+  void *p = countedAlloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+// --- Benchmarks ---
+
+static const OTAConfig benchDefaults = {
+  "bench-ssid", "bench-password", "192.168.1.10", 3000, true, 60, 80,
+  "Bench App", "firmware.bin", "1.2.3", "Benchmark configuration", ""
+};
+
+static const char *setQuery =
+  "ssid=Home+Network&password=s3cr%21t&otaServer=192.168.178.20&otaPort=3000"
+  "&otaEnabled=1&otaUpdateInterval=60&webServerPort=80";
+
+static volatile int sink;          // Keeps results alive
+
+/**
+ * Counts the bytes of the HTML form instead of sending them.
+ */
+class CountPrint : public Print {
+public:
+  size_t count = 0;
+  using Print::write;
+  size_t write(uint8_t) override { return ++count, 1; }
+  size_t write(const uint8_t *, size_t size) override { return count += size, size; }
+};
+
+static void benchSplitVersion() {
+  int parts[OTA_VERSION_PARTS];
+  sink = (int)splitVersion("1.12.3", parts, OTA_VERSION_PARTS);
+}
+
+static void benchCompareVersion() {
+  sink = compareVersion("1.2.10", "1.2.9");
+}
+
+static void benchHtmlForm() {
+  static HtmlFormValues values;
+  CountPrint out;
+  htmlFormValues(values);
+  htmlForm(out, values);
+  sink = (int)out.count;
+}
+
+static void benchHandleSet() {
+  server.hostRequest(HTTP_POST, OTA_CONFIG_SET, setQuery);
+  handleSet();
+}
+
+static void benchSaveConfig() {
+  config.otaPort ^= 1; // Changed data, so every call writes
+  saveConfigToEEPROM();
+}
+
+static void benchLoadConfig() {
+  sink = readConfigFromEEPROM().otaPort;
+}
+
+static void benchBuildUrls() {
+  char path[128];
+  char buf[128];
+  sink = otaFirmwareUrl(path, sizeof(path)) && otaVersionUrl(buf, sizeof(buf));
+}
+
+struct Benchmark {
+  const char *name;
+  void (*fn)();
+};
+
+static const Benchmark benchmarks[] = {
+  { "splitVersion", benchSplitVersion },
+  { "compareVersion", benchCompareVersion },
+  { "htmlForm", benchHtmlForm },
+  { "handleSet", benchHandleSet },
+  { "saveConfigToEEPROM", benchSaveConfig },
+  { "readConfigFromEEPROM", benchLoadConfig },
+  { "buildUrls", benchBuildUrls },
+};
+
+static double nowNs() {
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Measures one benchmark and prints its JSON object.
+ */
+static void run(const Benchmark &b, unsigned long minTimeMs, bool first) {
+  b.fn(); // Warm-up (first EEPROM.begin(), static initialisation)
+
+  // Allocations of a single call, exact
+  allocCount = allocBytes = 0;
+  uint32_t commits = EEPROM.commits;
+  counting = true;
+  b.fn();
+  counting = false;
+  uint64_t allocs = allocCount;
+  uint64_t bytes = allocBytes;
+  commits = EEPROM.commits - commits;
+
+  // Time per call, fastest of BENCH_BATCHES batches of at least minTimeMs
+  uint64_t iterations = 1;
+  double best = 0;
+  for (;;) {
+    double start = nowNs();
+    for (uint64_t i = 0; i < iterations; ++i) b.fn();
+    double elapsed = nowNs() - start;
+    if (elapsed >= minTimeMs * 1e6) {
+      best = elapsed / iterations;
+      break;
+    }
+    iterations *= 2;
+  }
+  for (int batch = 1; batch < BENCH_BATCHES; ++batch) {
+    double start = nowNs();
+    for (uint64_t i = 0; i < iterations; ++i) b.fn();
+    double perOp = (nowNs() - start) / iterations;
+    if (perOp < best) best = perOp;
+  }
+
+  printf("%s    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.1f, \"allocs_per_op\": %llu, "
+         "\"bytes_per_op\": %llu, \"flash_writes_per_op\": %u}",
+         first ? "" : ",\n", b.name, (unsigned long long)iterations, best, (unsigned long long)allocs,
+         (unsigned long long)bytes, commits);
+  fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+  const char *filter = nullptr;
+  unsigned long minTimeMs = BENCH_MIN_TIME;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+    else if (!strcmp(argv[i], "--min-time") && i + 1 < argc) minTimeMs = strtoul(argv[++i], nullptr, 10);
+    else {
+      fprintf(stderr, "usage: %s [--filter NAME] [--min-time MS]\n", argv[0]);
+      return 2;
+    }
+  }
+  setenv("OTA_HOST_QUIET", "1", 0);                   // handleSet() and others log to Serial
+  setenv("OTA_HOST_EEPROM", "/tmp/ota_bench_eeprom.bin", 0);
+
+  loadConfig(&benchDefaults);
+
+  printf("{\n  \"benchmarks\": [\n");
+  bool first = true;
+  for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i) {
+    if (filter && !strstr(benchmarks[i].name, filter)) continue;
+    run(benchmarks[i], minTimeMs, first);
+    first = false;
+  }
+  printf("\n  ]\n}\n");
+  return 0;
+}
@@ -0,0 +1,353 @@
+/**
+ * ota_soak.cpp
+ *
+ * Long uptime soak test of the OTA Template on the host (pio run -e native-soak).
+ * Runs otaLoop() for millions of iterations with a web request per iteration (form,
+ * status, form post, unknown path) and an update check against a local version server
+ * every --check-every iterations, and reports the largest free heap block over time.
+ *
+ * All allocations (operator new, which also backs the host String) are served from a
+ * model of the ESP8266 heap: a fixed pool of OTA_SOAK_HEAP bytes (environment, default
+ * 49152, about the free heap of an ESP8266 with WiFi and web server running) with first
+ * fit placement, block splitting and coalescing of neighbouring free blocks. The
+ * host allocates more than the cores (64 bit pointers, std::string), so the absolute
+ * numbers differ from a device; the trend shows whether the heap fragments.
+ * ESP.getFreeHeap() and ESP.getMaxAllocHeap() report the model, so /ota/status and the
+ * arena statistics (OTA_Arena.h) see the same figures.
+ *
+ * The test fails (exit code 1) if an allocation did not fit into the model heap or if
+ * the largest free block at the end is more than --max-drop percent below the first
+ * sample.
+ *
+ * Usage: [OTA_SOAK_HEAP=BYTES] program [--iterations N] [--check-every N] [--samples N] [--max-drop PCT]
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <new>
+#include <mutex>
+#include <thread>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "OTA_Template.h"
+
+void performOTAUpdate(); // OTA_Template.cpp, called by otaLoop()
+
+#define POOL_SIZE (1024 * 1024)    // Upper limit of OTA_SOAK_HEAP
+#define HEADER 8                   // Block header: size and size of the previous block
+#define MIN_BLOCK 16               // Header and the links of a free block
+#define NONE 0xFFFFFFFFUL          // End of the free list
+
+// --- Heap model ---
+
+static uint64_t pool[POOL_SIZE / 8];
+static uint32_t heapSize = 0;
+static bool heapReady = false;
+static uint32_t freeList = NONE;
+static uint32_t heapUsed = 0;
+static uint64_t oomCount = 0;      // Allocations that did not fit, served by malloc()
+static std::mutex heapLock;
+
+struct Block {
+  uint32_t size;                   // Incl. header, multiple of 8, bit 0: in use
+  uint32_t prevSize;               // Size of the block before, 0 for the first block
+  uint32_t next;                   // Free list links, only valid while the block is free
+  uint32_t prev;
+};
+
+static inline Block *at(uint32_t off) {
+  return (Block *)((uint8_t *)pool + off);
+}
+
+static void listRemove(uint32_t off) {
+  Block *b = at(off);
+  if (b->prev != NONE) at(b->prev)->next = b->next;
+  else freeList = b->next;
+  if (b->next != NONE) at(b->next)->prev = b->prev;
+}
+
+static void listAdd(uint32_t off) {
+  Block *b = at(off);
+  b->prev = NONE;
+  b->next = freeList;
+  if (freeList != NONE) at(freeList)->prev = off;
+  freeList = off;
+}
+
+/**
+ * Sets up the pool on the first allocation, before main() (static constructors).
+ */
+static void heapInit() {
+  heapSize = (uint32_t)hostEnvInt("OTA_SOAK_HEAP", 49152) & ~7UL;
+  if (heapSize > POOL_SIZE) heapSize = POOL_SIZE;
+  if (heapSize < MIN_BLOCK) heapSize = MIN_BLOCK;
+  Block *b = at(0);
+  b->size = heapSize;
+  b->prevSize = 0;
+  freeList = NONE;
+  listAdd(0);
+  heapReady = true;
+}
+
+static void *heapAlloc(size_t size) {
+  std::lock_guard<std::mutex> lock(heapLock);
+  if (!heapReady) heapInit();
+  uint32_t need = (uint32_t)((size + HEADER + 7) & ~(size_t)7);
+  if (need < MIN_BLOCK) need = MIN_BLOCK;
+  for (uint32_t off = freeList; off != NONE; off = at(off)->next) {
+    Block *b = at(off);
+    if (b->size < need) continue;
+    listRemove(off);
+    if (b->size - need >= MIN_BLOCK) { // Split, the rest stays free
+      uint32_t rest = off + need;
+      at(rest)->size = b->size - need;
+      at(rest)->prevSize = need;
+      if (rest + at(rest)->size < heapSize) at(rest + at(rest)->size)->prevSize = at(rest)->size;
+      listAdd(rest);
+      b->size = need;
+    }
+    heapUsed += b->size;
+    b->size |= 1;
+    return (uint8_t *)b + HEADER;
+  }
+  oomCount++;
+  return malloc(size ? size : 1);
+}
+
+static void heapFree(void *p) {
+  if (!p) return;
+  uint8_t *bytes = (uint8_t *)p;
+  if (bytes < (uint8_t *)pool || bytes >= (uint8_t *)pool + POOL_SIZE) {
+    free(p);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(heapLock);
+  uint32_t off = (uint32_t)(bytes - HEADER - (uint8_t *)pool);
+  Block *b = at(off);
+  b->size &= ~1UL;
+  heapUsed -= b->size;
+  uint32_t next = off + b->size;
+  if (next < heapSize && !(at(next)->size & 1)) { // Merge with the free block after
+    listRemove(next);
+    b->size += at(next)->size;
+  }
+  if (b->prevSize && !(at(off - b->prevSize)->size & 1)) { // Merge into the free block before
+    uint32_t before = off - b->prevSize;
+    at(before)->size += b->size;
+    off = before;
+    b = at(off);
+  } else {
+    listAdd(off);
+  }
+  next = off + b->size;
+  if (next < heapSize) at(next)->prevSize = b->size;
+}
+
+/**
+ * Returns the largest free block and the number of free blocks.
+ */
+static uint32_t largestBlock(uint32_t *blocks = nullptr) {
+  std::lock_guard<std::mutex> lock(heapLock);
+  uint32_t largest = 0;
+  uint32_t count = 0;
+  for (uint32_t off = freeList; off != NONE; off = at(off)->next) {
+    if (at(off)->size > largest) largest = at(off)->size;
+    count++;
+  }
+  if (blocks) *blocks = count;
+  return largest > HEADER ? largest - HEADER : 0;
+}
+
+void *operator new(size_t size) {
+  void *p = heapAlloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t size) {
+  void *p = heapAlloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return heapAlloc(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return heapAlloc(size); }
+void operator delete(void *p) noexcept { heapFree(p); }
+void operator delete[](void *p) noexcept { heapFree(p); }
+void operator delete(void *p, size_t) noexcept { heapFree(p); }
+void operator delete[](void *p, size_t) noexcept { heapFree(p); }
+
+// ESP.getFreeHeap() and ESP.getMaxAllocHeap() of the shim (HostRuntime.h)
+uint32_t hostHeapFree() {
+  return heapSize - heapUsed;
+}
+
+uint32_t hostHeapMaxBlock() {
+  return largestBlock();
+}
+
+// --- Version server ---
+
+static OTAConfig soakDefaults = {
+  "soak-ssid", "soak-password", "127.0.0.1", 0, false, 60, 80,
+  "Soak App", "firmware.bin", "1.2.3", "Soak test configuration", ""
+};
+
+/**
+ * Answers every request with the version of the running firmware (keep-alive), so
+ * each check ends with "up to date". Uses no heap.
+ */
+static void versionServer(int listener) {
+  for (;;) {
+    int fd = accept(listener, nullptr, nullptr);
+    if (fd < 0) continue;
+    char buf[1024];
+    size_t len = 0;
+    for (;;) {
+      ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+      if (n <= 0) break;
+      len += n;
+      buf[len] = '\0';
+      char *end = strstr(buf, "\r\n\r\n");
+      if (!end) continue;
+      char reply[160];
+      int r = snprintf(reply, sizeof(reply), "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %u\r\n"
+                       "Connection: keep-alive\r\n\r\n%s", (unsigned)strlen(soakDefaults.firmware_vers),
+                       soakDefaults.firmware_vers);
+      send(fd, reply, r, MSG_NOSIGNAL);
+      len -= end + 4 - buf;
+      memmove(buf, end + 4, len);
+    }
+    close(fd);
+  }
+}
+
+static int startVersionServer() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(sa);
+  if (fd < 0 || bind(fd, (sockaddr *)&sa, sizeof(sa)) < 0 || listen(fd, 4) < 0 ||
+      getsockname(fd, (sockaddr *)&sa, &len) < 0) {
+    perror("version server");
+    exit(2);
+  }
+  std::thread(versionServer, fd).detach();
+  return ntohs(sa.sin_port);
+}
+
+// --- Soak loop ---
+
+static char setQuery[512];
+
+/**
+ * Serves request number i of the rotation through the router, as handleWebServer() does.
+ */
+static void request(uint64_t i) {
+  switch (i % 4) {
+    case 0: server.hostRequest(HTTP_GET, OTA_CONFIG_ROOT, nullptr); break;
+    case 1: server.hostRequest(HTTP_GET, OTA_STATUS_PATH, nullptr); break;
+    case 2: server.hostRequest(HTTP_POST, OTA_CONFIG_SET, setQuery); break; // Unchanged, no flash write
+    default: server.hostRequest(HTTP_GET, "/favicon.ico", nullptr); break;
+  }
+  routerDispatch();
+}
+
+static void sample(uint64_t i, unsigned long startMs) {
+  uint32_t blocks;
+  uint32_t largest = largestBlock(&blocks);
+  uint32_t freeBytes = hostHeapFree();
+  printf("%12llu %9lu %8lu %8lu %8lu %6lu.%lu %7lu %8lu %6llu\n", (unsigned long long)i,
+         (millis() - startMs) / 1000, (unsigned long)heapUsed, (unsigned long)freeBytes, (unsigned long)largest,
+         (unsigned long)(freeBytes ? (freeBytes - largest) * 100ULL / freeBytes : 0),
+         (unsigned long)(freeBytes ? (freeBytes - largest) * 1000ULL / freeBytes % 10 : 0), (unsigned long)blocks,
+         (unsigned long)arenaStats().highWater, (unsigned long long)oomCount);
+  fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+  uint64_t iterations = 1000000;
+  uint64_t checkEvery = 100;
+  uint64_t samples = 20;
+  unsigned long maxDrop = 10;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--iterations") && i + 1 < argc) iterations = strtoull(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--check-every") && i + 1 < argc) checkEvery = strtoull(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--samples") && i + 1 < argc) samples = strtoull(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--max-drop") && i + 1 < argc) maxDrop = strtoul(argv[++i], nullptr, 10);
+    else {
+      fprintf(stderr, "usage: %s [--iterations N] [--check-every N] [--samples N] [--max-drop PCT]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (!checkEvery || !samples) {
+    fprintf(stderr, "invalid arguments\n");
+    return 2;
+  }
+
+  setenv("OTA_HOST_QUIET", "1", 0);
+  setenv("OTA_HOST_EEPROM", "/tmp/ota_soak_eeprom.bin", 0);
+  setenv("OTA_HOST_WEB_PORT", "18490", 0);
+  unlink(getenv("OTA_HOST_EEPROM")); // Starts with the defaults below
+  soakDefaults.otaPort = startVersionServer();
+  otaSetup(soakDefaults);
+  snprintf(setQuery, sizeof(setQuery),
+           "ssid=%s&password=%s&otaServer=%s&otaPort=%d&otaEnabled=0&otaUpdateInterval=%lu&webServerPort=%d",
+           config.ssid, config.password, config.otaServer, config.otaPort, config.otaUpdateInterval,
+           config.webServerPort);
+
+  printf("Heap model %lu bytes, %llu iterations, update check every %llu\n", (unsigned long)heapSize,
+         (unsigned long long)iterations, (unsigned long long)checkEvery);
+  printf("%12s %9s %8s %8s %8s %8s %7s %8s %6s\n", "iteration", "seconds", "used", "free", "maxBlock", "frag%",
+         "blocks", "arenaHW", "oom");
+  unsigned long startMs = millis();
+  uint64_t every = iterations / samples ? iterations / samples : 1;
+  uint32_t first = 0;
+  uint32_t minLargest = 0xFFFFFFFFUL;
+  for (uint64_t i = 0; i < iterations; ++i) {
+    otaLoop();
+    request(i);
+    if (i % checkEvery == checkEvery - 1) { // As otaLoop() does when the interval has passed
+      OTAArenaScope scope;
+      performOTAUpdate();
+      clientEnd();
+    }
+    uint32_t largest = largestBlock();
+    if (largest < minLargest) minLargest = largest;
+    if (i + 1 == (checkEvery < iterations ? checkEvery : iterations)) first = largest; // After the first check
+    if (i == 0 || (i + 1) % every == 0) sample(i + 1, startMs);
+  }
+  uint32_t last = largestBlock();
+  bool drop = (uint64_t)last * 100 < (uint64_t)first * (100 - maxDrop);
+  printf("Update checks %llu on %lu connections, arena scopes %lu\n", (unsigned long long)(iterations / checkEvery),
+         (unsigned long)clientStats().connects, (unsigned long)arenaStats().scopes);
+  printf("Largest free block: first %lu, last %lu, min %lu bytes (arena min %lu); %llu allocations did not fit\n",
+         (unsigned long)first, (unsigned long)last, (unsigned long)minLargest,
+         (unsigned long)arenaStats().minMaxBlock, (unsigned long long)oomCount);
+  if (drop || oomCount) {
+    printf("FAIL: %s\n", oomCount ? "heap exhausted" : "heap fragmented");
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * Arduino.h
+ *
+ * Host replacement of the Arduino core for the native build of the OTA Template.
+ * It emulates the subset of the ESP32 Arduino core used by the library:
+ * timing, GPIO stubs, Serial on stdout, the ESP object and the String class.
+ * The native environment in platformio.ini defines ESP32 and OTA_NATIVE,
+ * so the library sources compile unmodified against this shim.
+ *
+ * Runtime settings are taken from environment variables, see HostRuntime.h.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "WString.h"
+#include "Print.h"
+#include "HostRuntime.h"
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define PROGMEM
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+using std::min;
+using std::max;
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  operator bool() const { return true; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  void restart();
+  uint32_t getFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint32_t getMaxFreeBlockSize() { return getMaxAllocHeap(); }
+  uint32_t getHeapSize() { return getFreeHeap(); }
+  uint32_t getSketchSize();   // Size of the running image file (OTA_HOST_RUNNING)
+  uint64_t getEfuseMac() { return 0x0000AABBCCDDEEFFULL; }
+  uint32_t getChipId() { return 0x00DDEEFF; }
+  uint32_t getCpuFreqMHz() { return 160; }
+  const char *getSdkVersion() { return "native"; }
+  void deepSleep(uint64_t us);
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
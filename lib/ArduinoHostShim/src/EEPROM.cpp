@@ -0,0 +1,62 @@
+/**
+ * EEPROM.cpp
+ *
+ * File backed implementation of the ESP32 EEPROM class for the native build.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "EEPROM.h"
+#include <stdio.h>
+
+EEPROMClass EEPROM;
+
+static const char *eepromFile() {
+  return hostEnv("OTA_HOST_EEPROM", "eeprom.bin");
+}
+
+bool EEPROMClass::begin(size_t size) {
+  if (size == 0) return false;
+  if (data_.size() == size) return true;  // Already initialised, keep pending changes
+  data_.assign(size, 0xFF);  // Erased flash reads as 0xFF
+  dirty_ = false;
+  FILE *f = fopen(eepromFile(), "rb");
+  if (f) {
+    size_t n = fread(data_.data(), 1, size, f);
+    (void)n;
+    fclose(f);
+  }
+  return true;
+}
+
+bool EEPROMClass::commit() {
+  if (data_.empty()) return false;
+  if (!dirty_) return true;
+  FILE *f = fopen(eepromFile(), "wb");
+  if (!f) return false;
+  bool ok = fwrite(data_.data(), 1, data_.size(), f) == data_.size();
+  fclose(f);
+  dirty_ = false;
+  commits++;
+  return ok;
+}
+
+void EEPROMClass::end() {
+  commit();
+  data_.clear();
+}
@@ -0,0 +1,69 @@
+/**
+ * EEPROM.h
+ *
+ * File backed implementation of the ESP32 EEPROM class for the native build.
+ * The content is read from OTA_HOST_EEPROM on begin() and written back on commit()
+ * or end(), but only if it was changed (like the flash emulation on the target).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <vector>
+#include "Arduino.h"
+
+class EEPROMClass {
+public:
+  bool begin(size_t size);
+  bool commit();
+  void end();
+  uint8_t read(int address) const { return address >= 0 && (size_t)address < data_.size() ? data_[address] : 0; }
+  void write(int address, uint8_t value) {
+    if (address >= 0 && (size_t)address < data_.size() && data_[address] != value) {
+      data_[address] = value;
+      dirty_ = true;
+    }
+  }
+  size_t length() const { return data_.size(); }
+  uint8_t *getDataPtr() { return data_.data(); }
+
+  template <typename T> T &get(int address, T &t) {
+    if (address >= 0 && address + sizeof(T) <= data_.size()) memcpy((void *)&t, data_.data() + address, sizeof(T));
+    return t;
+  }
+  template <typename T> const T &put(int address, const T &t) {
+    if (address >= 0 && address + sizeof(T) <= data_.size() &&
+        memcmp(data_.data() + address, (const void *)&t, sizeof(T)) != 0) {
+      memcpy(data_.data() + address, (const void *)&t, sizeof(T));
+      dirty_ = true;
+    }
+    return t;
+  }
+
+  uint32_t commits = 0;   // Number of commits (flash writes on the target)
+
+private:
+  std::vector<uint8_t> data_;
+  bool dirty_ = false;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // HOST_EEPROM_H
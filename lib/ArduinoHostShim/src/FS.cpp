@@ -0,0 +1,105 @@
+/**
+ * FS.cpp
+ *
+ * Directory based file system of the native build (see FS.h, LittleFS.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "LittleFS.h"
+#include "HostRuntime.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <errno.h>
+
+LittleFSFS LittleFS;
+
+static const char *fsRoot() {
+  return hostEnv("OTA_HOST_FS", "littlefs");
+}
+
+namespace fs {
+
+int File::peek() {
+  if (!f_) return -1;
+  int c = fgetc(f_);
+  if (c >= 0) ungetc(c, f_);
+  return c;
+}
+
+size_t File::size() const {
+  struct stat st;
+  return f_ && fstat(fileno(f_), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+std::string FS::hostPath(const char *path) const {
+  std::string p(fsRoot());
+  if (*path != '/') p += '/';
+  return p + path;
+}
+
+/**
+ * Creates the parent directories of a host path.
+ */
+static void makeParents(const std::string &path) {
+  for (size_t i = path.find('/', 1); i != std::string::npos; i = path.find('/', i + 1)) {
+    ::mkdir(path.substr(0, i).c_str(), 0755);
+  }
+}
+
+File FS::open(const char *path, const char *mode, bool) {
+  if (!mounted_ || !path || strstr(path, "..")) return File();
+  std::string host = hostPath(path);
+  bool write = strchr(mode, 'w') || strchr(mode, 'a');
+  if (write) {
+    makeParents(host);
+    writes++;
+  }
+  std::string m(mode);
+  if (m.find('b') == std::string::npos) m += 'b';
+  FILE *f = fopen(host.c_str(), m.c_str());
+  return f ? File(f, path) : File();
+}
+
+bool FS::exists(const char *path) {
+  struct stat st;
+  return mounted_ && stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char *path) {
+  return mounted_ && ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char *from, const char *to) {
+  if (!mounted_) return false;
+  std::string target = hostPath(to);
+  makeParents(target);
+  return ::rename(hostPath(from).c_str(), target.c_str()) == 0;
+}
+
+bool FS::mkdir(const char *path) {
+  return mounted_ && (::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST);
+}
+
+} // namespace fs
+
+bool LittleFSFS::begin(bool) {
+  if (::mkdir(fsRoot(), 0755) != 0 && errno != EEXIST) return false;
+  mounted_ = true;
+  return true;
+}
@@ -0,0 +1,99 @@
+/**
+ * FS.h
+ *
+ * Host implementation of the Arduino file system classes (fs::FS, fs::File) for the
+ * native build. Files live below a directory of the host (OTA_HOST_FS), paths are
+ * relative to it; like LittleFS, parent directories are created when a file is opened
+ * for writing and rename() replaces an existing file.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <stdio.h>
+#include <string>
+#include "Arduino.h"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+public:
+  File() {}
+  File(FILE *f, const char *name) : f_(f), name_(name) {}
+  File(const File &o) = delete;
+  File(File &&o) : f_(o.f_), name_(o.name_) { o.f_ = nullptr; }
+  File &operator=(File &&o) {
+    close();
+    f_ = o.f_;
+    name_ = o.name_;
+    o.f_ = nullptr;
+    return *this;
+  }
+  ~File() { close(); }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override { return f_ ? fwrite(buf, 1, size, f_) : 0; }
+  using Print::write;
+  int available() override { return f_ ? (int)(size() - position()) : 0; }
+  int read() override { return f_ ? fgetc(f_) : -1; }
+  int read(uint8_t *buf, size_t size) override { return f_ ? (int)fread(buf, 1, size, f_) : -1; }
+  int peek() override;
+  void flush() override {
+    if (f_) fflush(f_);
+  }
+  bool seek(uint32_t pos, SeekMode mode = SeekSet) { return f_ && fseek(f_, pos, (int)mode) == 0; }
+  size_t position() const { return f_ ? (size_t)ftell(f_) : 0; }
+  size_t size() const;
+  const char *name() const { return name_.c_str(); }
+  void close() {
+    if (f_) fclose(f_);
+    f_ = nullptr;
+  }
+  operator bool() const { return f_ != nullptr; }
+
+private:
+  FILE *f_ = nullptr;
+  std::string name_;
+};
+
+class FS {
+public:
+  File open(const char *path, const char *mode = "r", bool create = false);
+  File open(const String &path, const char *mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+  bool exists(const char *path);
+  bool remove(const char *path);
+  bool rename(const char *from, const char *to);
+  bool mkdir(const char *path);
+
+  uint32_t writes = 0;    // Files opened for writing (flash wear on the target)
+
+protected:
+  std::string hostPath(const char *path) const;
+  bool mounted_ = false;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // HOST_FS_H
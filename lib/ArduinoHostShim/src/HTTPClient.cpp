@@ -0,0 +1,229 @@
+/**
+ * HTTPClient.cpp
+ *
+ * Host implementation of the ESP32 HTTPClient for the native build.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "HTTPClient.h"
+
+bool HTTPClient::parseUrl(const String &url) {
+  std::string u = url.c_str();
+  size_t scheme = u.find("://");
+  if (scheme == std::string::npos) return false;
+  std::string proto = u.substr(0, scheme);
+  port_ = (proto == "https") ? 443 : 80;
+  u = u.substr(scheme + 3);
+  size_t slash = u.find('/');
+  std::string hostPort = slash == std::string::npos ? u : u.substr(0, slash);
+  uri_ = slash == std::string::npos ? "/" : u.substr(slash);
+  size_t colon = hostPort.find(':');
+  if (colon != std::string::npos) {
+    port_ = (uint16_t)atoi(hostPort.c_str() + colon + 1);
+    hostPort = hostPort.substr(0, colon);
+  }
+  host_ = hostPort;
+  return !host_.empty();
+}
+
+bool HTTPClient::begin(WiFiClient &client, const String &url) {
+  if (client_ && client_ != &client) end();
+  client_ = &client;
+  return parseUrl(url);
+}
+
+bool HTTPClient::begin(WiFiClient &client, const String &host, uint16_t port, const String &uri) {
+  if (client_ && client_ != &client) end();
+  client_ = &client;
+  host_ = host.c_str();
+  port_ = port;
+  uri_ = uri.c_str();
+  return true;
+}
+
+bool HTTPClient::begin(const String &url) {
+  client_ = &ownClient_;
+  return parseUrl(url);
+}
+
+void HTTPClient::end() {
+  if (client_ && (!reuse_ || !canReuse_)) client_->stop();
+  else if (client_) {
+    while (client_->available() > 0) client_->read();
+  }
+  reqHeaders_.clear();
+  respHeaders_.clear();
+  size_ = -1;
+  chunked_ = false;
+}
+
+void HTTPClient::addHeader(const String &name, const String &value) {
+  reqHeaders_.push_back(std::make_pair(std::string(name.c_str()), std::string(value.c_str())));
+}
+
+void HTTPClient::collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {
+  collect_.clear();
+  for (size_t i = 0; i < headerKeysCount; ++i) collect_.push_back(headerKeys[i]);
+}
+
+String HTTPClient::header(const char *name) {
+  for (size_t i = 0; i < respHeaders_.size(); ++i) {
+    if (strcasecmp(respHeaders_[i].first.c_str(), name) == 0) return String(respHeaders_[i].second);
+  }
+  return String();
+}
+
+bool HTTPClient::hasHeader(const char *name) {
+  for (size_t i = 0; i < respHeaders_.size(); ++i) {
+    if (strcasecmp(respHeaders_[i].first.c_str(), name) == 0) return true;
+  }
+  return false;
+}
+
+bool HTTPClient::connect() {
+  if (client_->connected()) {
+    while (client_->available() > 0) client_->read();
+    return true;
+  }
+  client_->setTimeout(timeout_);
+  return client_->connect(host_.c_str(), port_, connectTimeout_) == 1;
+}
+
+int HTTPClient::GET() {
+  return sendRequest("GET");
+}
+
+int HTTPClient::sendRequest(const char *type, const uint8_t *payload, size_t size) {
+  if (!client_) return HTTPC_ERROR_NOT_CONNECTED;
+  if (!connect()) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+  std::string req = std::string(type) + " " + uri_ + " HTTP/1.1\r\nHost: " + host_;
+  if (port_ != 80 && port_ != 443) req += ":" + std::to_string(port_);
+  req += "\r\nUser-Agent: " + userAgent_;
+  req += reuse_ ? "\r\nConnection: keep-alive" : "\r\nConnection: close";
+  for (size_t i = 0; i < reqHeaders_.size(); ++i) {
+    req += "\r\n" + reqHeaders_[i].first + ": " + reqHeaders_[i].second;
+  }
+  if (payload && size) req += "\r\nContent-Length: " + std::to_string(size);
+  req += "\r\n\r\n";
+  if (client_->write((const uint8_t *)req.data(), req.size()) != req.size()) return HTTPC_ERROR_SEND_HEADER_FAILED;
+  if (payload && size && client_->write(payload, size) != size) return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+  return readHeaders();
+}
+
+bool HTTPClient::readLine(std::string &line) {
+  line.clear();
+  unsigned long start = millis();
+  while (millis() - start < timeout_) {
+    int c = client_->read();
+    if (c < 0) {
+      if (!client_->connected()) return false;
+      delay(1);
+      continue;
+    }
+    if (c == '\n') {
+      if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+      return true;
+    }
+    line += (char)c;
+  }
+  return false;
+}
+
+int HTTPClient::readHeaders() {
+  std::string line;
+  if (!readLine(line)) return HTTPC_ERROR_READ_TIMEOUT;
+  if (line.compare(0, 5, "HTTP/") != 0) return HTTPC_ERROR_NO_HTTP_SERVER;
+  int code = atoi(line.c_str() + line.find(' ') + 1);
+  size_ = -1;
+  chunked_ = false;
+  canReuse_ = reuse_;
+  respHeaders_.clear();
+  while (readLine(line) && !line.empty()) {
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    std::string name = line.substr(0, colon);
+    std::string value = line.substr(colon + 1);
+    while (!value.empty() && value[0] == ' ') value.erase(0, 1);
+    if (strcasecmp(name.c_str(), "Content-Length") == 0) size_ = atoi(value.c_str());
+    else if (strcasecmp(name.c_str(), "Transfer-Encoding") == 0 && value.find("chunked") != std::string::npos) chunked_ = true;
+    else if (strcasecmp(name.c_str(), "Connection") == 0 && strcasecmp(value.c_str(), "close") == 0) canReuse_ = false;
+    respHeaders_.push_back(std::make_pair(name, value));
+  }
+  return code;
+}
+
+String HTTPClient::getString() {
+  std::string body;
+  uint8_t buf[1024];
+  if (chunked_) {
+    std::string line;
+    while (readLine(line)) {
+      long chunk = strtol(line.c_str(), nullptr, 16);
+      if (chunk <= 0) {
+        readLine(line);
+        break;
+      }
+      while (chunk > 0) {
+        size_t n = client_->readBytes(buf, std::min((long)sizeof(buf), chunk));
+        if (!n) return String(body);
+        body.append((const char *)buf, n);
+        chunk -= n;
+      }
+      readLine(line);
+    }
+  } else if (size_ >= 0) {
+    long left = size_;
+    while (left > 0) {
+      size_t n = client_->readBytes(buf, std::min((long)sizeof(buf), left));
+      if (!n) break;
+      body.append((const char *)buf, n);
+      left -= n;
+    }
+  } else {
+    canReuse_ = false;
+    client_->setTimeout(timeout_);
+    size_t n;
+    while ((n = client_->readBytes(buf, sizeof(buf))) > 0) body.append((const char *)buf, n);
+  }
+  return String(body);
+}
+
+int HTTPClient::writeToStream(Stream *stream) {
+  if (!stream) return HTTPC_ERROR_NO_STREAM;
+  String body = getString();
+  return (int)stream->write((const uint8_t *)body.c_str(), body.length());
+}
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return String("connection refused");
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return String("send header failed");
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return String("send payload failed");
+    case HTTPC_ERROR_NOT_CONNECTED: return String("not connected");
+    case HTTPC_ERROR_CONNECTION_LOST: return String("connection lost");
+    case HTTPC_ERROR_NO_STREAM: return String("no stream");
+    case HTTPC_ERROR_NO_HTTP_SERVER: return String("no HTTP server");
+    case HTTPC_ERROR_TOO_LESS_RAM: return String("too less ram");
+    case HTTPC_ERROR_ENCODING: return String("Transfer-Encoding not supported");
+    case HTTPC_ERROR_STREAM_WRITE: return String("Stream write error");
+    case HTTPC_ERROR_READ_TIMEOUT: return String("read Timeout");
+    default: return String();
+  }
+}
@@ -0,0 +1,113 @@
+/**
+ * HTTPClient.h
+ *
+ * Host implementation of the ESP32 HTTPClient for the native build.
+ * Supports plain HTTP/1.1 requests with Content-Length, chunked or
+ * connection-close delimited bodies and connection reuse.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include <vector>
+#include <utility>
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+typedef enum {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_PARTIAL_CONTENT = 206,
+  HTTP_CODE_MOVED_PERMANENTLY = 301,
+  HTTP_CODE_FOUND = 302,
+  HTTP_CODE_NOT_MODIFIED = 304,
+  HTTP_CODE_BAD_REQUEST = 400,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_RANGE_NOT_SATISFIABLE = 416,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500
+} t_http_codes;
+
+class HTTPClient {
+public:
+  HTTPClient() {}
+  ~HTTPClient() { end(); }
+
+  bool begin(WiFiClient &client, const String &url);
+  bool begin(WiFiClient &client, const String &host, uint16_t port, const String &uri = "/");
+  bool begin(const String &url);
+  void end();
+
+  void setReuse(bool reuse) { reuse_ = reuse; }
+  void setTimeout(uint16_t timeout) { timeout_ = timeout; }
+  void setConnectTimeout(int32_t timeout) { connectTimeout_ = timeout; }
+  void setUserAgent(const String &ua) { userAgent_ = ua.c_str(); }
+  void useHTTP10(bool) {}
+  void addHeader(const String &name, const String &value);
+  void collectHeaders(const char *headerKeys[], const size_t headerKeysCount);
+  String header(const char *name);
+  bool hasHeader(const char *name);
+
+  int GET();
+  int HEAD() { return sendRequest("HEAD"); }
+  int POST(const String &payload) { return sendRequest("POST", (const uint8_t *)payload.c_str(), payload.length()); }
+  int sendRequest(const char *type, const uint8_t *payload = nullptr, size_t size = 0);
+
+  int getSize() { return size_; }
+  String getString();
+  WiFiClient &getStream() { return *client_; }
+  WiFiClient *getStreamPtr() { return client_; }
+  int writeToStream(Stream *stream);
+  bool connected() { return client_ && client_->connected(); }
+  static String errorToString(int error);
+
+private:
+  bool parseUrl(const String &url);
+  bool connect();
+  int readHeaders();
+  bool readLine(std::string &line);
+
+  WiFiClient *client_ = nullptr;
+  WiFiClient ownClient_;
+  std::string host_;
+  uint16_t port_ = 80;
+  std::string uri_;
+  std::string userAgent_ = "ESP32HTTPClient";
+  std::vector<std::pair<std::string, std::string> > reqHeaders_;
+  std::vector<std::string> collect_;
+  std::vector<std::pair<std::string, std::string> > respHeaders_;
+  bool reuse_ = true;
+  bool canReuse_ = false;
+  bool chunked_ = false;
+  int size_ = -1;
+  uint16_t timeout_ = 5000;
+  int32_t connectTimeout_ = 5000;
+};
+
+#endif // HOST_HTTPCLIENT_H
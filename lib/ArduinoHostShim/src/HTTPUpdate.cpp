@@ -0,0 +1,65 @@
+/**
+ * HTTPUpdate.cpp
+ *
+ * Host implementation of the ESP32 HTTPUpdate class for the native build.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "HTTPUpdate.h"
+
+HTTPUpdate httpUpdate;
+
+t_httpUpdate_return HTTPUpdate::fail(int error) {
+  lastError_ = error;
+  if (errorCb_) errorCb_(error);
+  return HTTP_UPDATE_FAILED;
+}
+
+t_httpUpdate_return HTTPUpdate::update(WiFiClient &client, const String &url, const String &) {
+  HTTPClient http;
+  http.setTimeout(timeout_);
+  http.setReuse(false);
+  if (!http.begin(client, url)) return fail(HTTPC_ERROR_CONNECTION_REFUSED);
+  int code = http.GET();
+  if (code < 0) return fail(code);
+  if (code == HTTP_CODE_NOT_MODIFIED) return HTTP_UPDATE_NO_UPDATES;
+  if (code == HTTP_CODE_NOT_FOUND) return fail(HTTP_UE_SERVER_FILE_NOT_FOUND);
+  if (code != HTTP_CODE_OK) return fail(HTTP_UE_SERVER_WRONG_HTTP_CODE);
+  int size = http.getSize();
+  if (size <= 0) return fail(HTTP_UE_SERVER_NOT_REPORT_SIZE);
+
+  if (startCb_) startCb_();
+  if (!Update.begin(size)) return fail(HTTP_UE_TOO_LESS_SPACE);
+  if (progressCb_) {
+    HTTPUpdateProgressCB cb = progressCb_;
+    Update.onProgress([cb](size_t done, size_t total) { cb((int)done, (int)total); });
+  }
+  Update.writeStream(http.getStream());
+  Update.onProgress(nullptr);
+  if (!Update.end()) return fail(Update.getError());
+  http.end();
+  if (endCb_) endCb_();
+  if (reboot_) ESP.restart();
+  return HTTP_UPDATE_OK;
+}
+
+String HTTPUpdate::getLastErrorString() const {
+  if (lastError_ >= 0) return String(Update.errorString());
+  return HTTPClient::errorToString(lastError_);
+}
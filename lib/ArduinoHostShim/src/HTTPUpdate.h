@@ -0,0 +1,82 @@
+/**
+ * HTTPUpdate.h
+ *
+ * Host implementation of the ESP32 HTTPUpdate class for the native build.
+ * Downloads the image with HTTPClient and writes it through Update into the
+ * file backed partition. A successful update with rebootOnUpdate enabled
+ * ends the process through ESP.restart().
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_HTTPUPDATE_H
+#define HOST_HTTPUPDATE_H
+
+#include <functional>
+#include "HTTPClient.h"
+#include "Update.h"
+
+#define HTTP_UE_TOO_LESS_SPACE (-100)
+#define HTTP_UE_SERVER_NOT_REPORT_SIZE (-101)
+#define HTTP_UE_SERVER_FILE_NOT_FOUND (-102)
+#define HTTP_UE_SERVER_FORBIDDEN (-103)
+#define HTTP_UE_SERVER_WRONG_HTTP_CODE (-104)
+#define HTTP_UE_SERVER_FAULTY_MD5 (-105)
+#define HTTP_UE_BIN_VERIFY_HEADER_FAILED (-106)
+#define HTTP_UE_BIN_FOR_WRONG_FLASH (-107)
+#define HTTP_UE_NO_PARTITION (-108)
+
+enum HTTPUpdateResult { HTTP_UPDATE_FAILED, HTTP_UPDATE_NO_UPDATES, HTTP_UPDATE_OK };
+typedef HTTPUpdateResult t_httpUpdate_return;
+
+typedef std::function<void(void)> HTTPUpdateStartCB;
+typedef std::function<void(void)> HTTPUpdateEndCB;
+typedef std::function<void(int)> HTTPUpdateErrorCB;
+typedef std::function<void(int, int)> HTTPUpdateProgressCB;
+
+class HTTPUpdate {
+public:
+  explicit HTTPUpdate(int httpClientTimeout = 8000) : timeout_(httpClientTimeout) {}
+
+  void rebootOnUpdate(bool reboot) { reboot_ = reboot; }
+  void followRedirects(int) {}
+  void setLedPin(int = -1, uint8_t = 0) {}
+  void onStart(HTTPUpdateStartCB cb) { startCb_ = cb; }
+  void onEnd(HTTPUpdateEndCB cb) { endCb_ = cb; }
+  void onError(HTTPUpdateErrorCB cb) { errorCb_ = cb; }
+  void onProgress(HTTPUpdateProgressCB cb) { progressCb_ = cb; }
+
+  t_httpUpdate_return update(WiFiClient &client, const String &url, const String &currentVersion = "");
+  int getLastError() const { return lastError_; }
+  String getLastErrorString() const;
+
+private:
+  t_httpUpdate_return fail(int error);
+
+  int timeout_;
+  bool reboot_ = true;
+  int lastError_ = 0;
+  HTTPUpdateStartCB startCb_;
+  HTTPUpdateEndCB endCb_;
+  HTTPUpdateErrorCB errorCb_;
+  HTTPUpdateProgressCB progressCb_;
+};
+
+extern HTTPUpdate httpUpdate;
+
+#endif // HOST_HTTPUPDATE_H
@@ -0,0 +1,160 @@
+/**
+ * HostMain.cpp
+ *
+ * Entry point and core services (timing, Serial, ESP object) of the native build.
+ * Calls setup() once and loop() until the configured limit is reached.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+#include <random>
+#include <unistd.h>
+#include <stdio.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+HostStats hostStats = {0, 0, 0, 0, 0};
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static std::mt19937 rng(12345);
+static int quiet = -1;
+
+const char *hostEnv(const char *name, const char *fallback) {
+  const char *v = getenv(name);
+  return (v && *v) ? v : fallback;
+}
+
+long hostEnvInt(const char *name, long fallback) {
+  const char *v = getenv(name);
+  return (v && *v) ? strtol(v, nullptr, 0) : fallback;
+}
+
+unsigned long millis() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+  if (ms) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {}
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return LOW; }
+
+long random(long max) { return max > 0 ? (long)(rng() % (unsigned long)max) : 0; }
+long random(long min, long max) { return max > min ? min + random(max - min) : min; }
+void randomSeed(unsigned long seed) { rng.seed(seed); }
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t size) {
+  if (quiet < 0) quiet = (int)hostEnvInt("OTA_HOST_QUIET", 0);
+  if (quiet) return size;
+  return fwrite(buf, 1, size, stdout);
+}
+
+String Stream::readStringUntil(char terminator) {
+  String s;
+  uint8_t c;
+  while (timedRead(&c, 1) == 1 && c != (uint8_t)terminator) s += (char)c;
+  return s;
+}
+
+String Stream::readString() {
+  String s;
+  uint8_t c;
+  while (timedRead(&c, 1) == 1) s += (char)c;
+  return s;
+}
+
+size_t Stream::timedRead(uint8_t *buf, size_t size) {
+  size_t n = 0;
+  unsigned long start = millis();
+  while (n < size && millis() - start < timeout_) {
+    int r = read(buf + n, size - n);
+    if (r > 0) {
+      n += r;
+      start = millis();
+    } else if (r < 0 || !available()) {
+      delay(1);
+    }
+  }
+  return n;
+}
+
+void EspClass::restart() {
+  hostExit(HOST_EXIT_RESTART, "ESP.restart()");
+}
+
+void EspClass::deepSleep(uint64_t us) {
+  fprintf(stderr, "[host] deep sleep for %llu us requested\n", (unsigned long long)us);
+  hostExit(HOST_EXIT_DEEP_SLEEP, "ESP.deepSleep()");
+}
+
+uint64_t hostSleepTimerUs = 0;
+
+__attribute__((weak)) uint32_t hostHeapFree() { return 200000; }
+__attribute__((weak)) uint32_t hostHeapMaxBlock() { return 110000; }
+
+uint32_t EspClass::getFreeHeap() { return hostHeapFree(); }
+uint32_t EspClass::getMaxAllocHeap() { return hostHeapMaxBlock(); }
+
+void hostExit(int code, const char *reason) {
+  fflush(stdout);
+  fprintf(stderr,
+          "[host] exit: %s | wall time %lu ms | rx %llu bytes | tx %llu bytes | "
+          "connections %u | accepted %u | partition written %llu bytes\n",
+          reason, millis(), (unsigned long long)hostStats.bytesRx, (unsigned long long)hostStats.bytesTx,
+          hostStats.connections, hostStats.accepted, (unsigned long long)hostStats.partitionBytes);
+  exit(code);
+}
+
+extern void setup();
+extern void loop();
+
+#ifndef HOST_NO_MAIN
+int main() {
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  long loops = hostEnvInt("OTA_HOST_LOOPS", 0);
+  long seconds = hostEnvInt("OTA_HOST_SECONDS", 0);
+  setup();
+  for (long i = 0; loops == 0 || i < loops; ++i) {
+    loop();
+    if (seconds > 0 && millis() >= (unsigned long)seconds * 1000UL) break;
+  }
+  hostExit(HOST_EXIT_DONE, "loop limit reached");
+  return 0;
+}
+#endif
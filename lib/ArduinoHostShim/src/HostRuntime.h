@@ -0,0 +1,69 @@
+/**
+ * HostRuntime.h
+ *
+ * Runtime settings and traffic counters of the native build.
+ *
+ * The native program is configured through environment variables:
+ *   OTA_HOST_EEPROM     File backing the emulated EEPROM     (default: eeprom.bin)
+ *   OTA_HOST_PARTITION  File receiving OTA images ("partition") (default: ota_partition.bin)
+ *   OTA_HOST_RUNNING    File holding the running image          (default: OTA_HOST_PARTITION)
+ *   OTA_HOST_LOOPS      Number of loop() iterations, 0 = endless (default: 0)
+ *   OTA_HOST_SECONDS    Max. run time in seconds, 0 = endless    (default: 0)
+ *   OTA_HOST_QUIET      Suppress Serial output if set to 1       (default: 0)
+ *   OTA_HOST_WIFI_DELAY Simulated WiFi association time in ms     (default: 0)
+ *   OTA_HOST_UDP_LOSS   Share of received UDP packets dropped in % (default: 0)
+ *   OTA_HOST_FS         Directory holding the LittleFS files      (default: littlefs)
+ *
+ * On exit (loop limit, ESP.restart() or ESP.deepSleep()) a summary with
+ * wall time and bytes transferred is printed to stderr.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_RUNTIME_H
+#define HOST_RUNTIME_H
+
+#include <stdint.h>
+
+// Process exit codes of the native program
+#define HOST_EXIT_DONE 0          // Loop limit reached
+#define HOST_EXIT_RESTART 3       // ESP.restart() was called (e.g. after an OTA update)
+#define HOST_EXIT_DEEP_SLEEP 4    // ESP.deepSleep() was called
+
+struct HostStats {
+  uint64_t bytesRx;          // Bytes received on all TCP/UDP sockets
+  uint64_t bytesTx;          // Bytes sent on all TCP/UDP sockets
+  uint32_t connections;      // Outgoing TCP connections
+  uint32_t accepted;         // Incoming TCP connections
+  uint64_t partitionBytes;   // Bytes written to the OTA partition file
+};
+
+extern HostStats hostStats;
+
+const char *hostEnv(const char *name, const char *fallback);
+long hostEnvInt(const char *name, long fallback);
+
+// Prints the run summary to stderr and terminates with the given exit code
+void hostExit(int code, const char *reason);
+
+// Heap figures of ESP.getFreeHeap() and ESP.getMaxAllocHeap()/getMaxFreeBlockSize().
+// Weak: fixed values, a program with a heap model (bench/ota_soak.cpp) replaces them.
+uint32_t hostHeapFree();
+uint32_t hostHeapMaxBlock();
+
+#endif // HOST_RUNTIME_H
@@ -0,0 +1,65 @@
+/**
+ * IPAddress.h
+ *
+ * Host implementation of the Arduino IPAddress class (IPv4 only).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "WString.h"
+#include "Print.h"
+
+class IPAddress : public Printable {
+public:
+  IPAddress() { bytes_[0] = bytes_[1] = bytes_[2] = bytes_[3] = 0; }
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { bytes_[0] = a; bytes_[1] = b; bytes_[2] = c; bytes_[3] = d; }
+  IPAddress(uint32_t addr) { memcpy(bytes_, &addr, 4); }  // Network byte order, as on the ESP cores
+  IPAddress(const uint8_t *addr) { memcpy(bytes_, addr, 4); }
+
+  operator uint32_t() const { uint32_t a; memcpy(&a, bytes_, 4); return a; }
+  bool operator==(const IPAddress &o) const { return memcmp(bytes_, o.bytes_, 4) == 0; }
+  bool operator!=(const IPAddress &o) const { return !(*this == o); }
+  uint8_t operator[](int i) const { return bytes_[i]; }
+  uint8_t &operator[](int i) { return bytes_[i]; }
+  bool isSet() const { return (uint32_t)(*this) != 0; }
+
+  bool fromString(const char *s) {
+    unsigned a, b, c, d;
+    char tail;
+    if (sscanf(s, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return false;
+    bytes_[0] = a; bytes_[1] = b; bytes_[2] = c; bytes_[3] = d;
+    return true;
+  }
+  bool fromString(const String &s) { return fromString(s.c_str()); }
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes_[0], bytes_[1], bytes_[2], bytes_[3]);
+    return String(buf);
+  }
+  size_t printTo(Print &p) const override { return p.print(toString()); }
+
+private:
+  uint8_t bytes_[4];
+};
+
+#endif // HOST_IPADDRESS_H
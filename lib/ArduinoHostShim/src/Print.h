@@ -0,0 +1,140 @@
+/**
+ * Print.h / Stream
+ *
+ * Host implementation of the Arduino Print and Stream base classes
+ * for the native build.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_PRINT_H
+#define HOST_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include "WString.h"
+
+class Printable;
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buf++);
+    return n;
+  }
+  size_t write(const char *s) { return s ? write((const uint8_t *)s, strlen(s)) : 0; }
+  size_t write(const char *buf, size_t size) { return write((const uint8_t *)buf, size); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write(s.c_str(), s.length()); }
+  size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = 10) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = 10) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = 10) {
+    return v < 0 && base == 10 ? print('-') + printNumber(0UL - (unsigned long)v, base) : printNumber(v, base);
+  }
+  size_t print(unsigned long v, int base = 10) { return printNumber(v, base); }
+  size_t print(double v, int digits = 2) { return print(String(v, (unsigned char)digits)); }
+  size_t print(const Printable &p);
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(const T &v) { size_t n = print(v); return n + println(); }
+  size_t println(int v, int base) { size_t n = print(v, base); return n + println(); }
+
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char stackBuf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(stackBuf, sizeof(stackBuf), fmt, ap);
+    va_end(ap);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(stackBuf)) return write((const uint8_t *)stackBuf, len);
+    std::string big(len + 1, '\0');
+    va_start(ap, fmt);
+    vsnprintf(&big[0], len + 1, fmt, ap);
+    va_end(ap);
+    return write((const uint8_t *)big.data(), len);
+  }
+  size_t printf_P(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (len < 0) return 0;
+    if ((size_t)len >= sizeof(buf)) len = sizeof(buf) - 1;
+    return write((const uint8_t *)buf, len);
+  }
+
+private:
+  // Without a String, as the cores do: numbers in a web page do not allocate
+  size_t printNumber(unsigned long v, int base) {
+    char buf[8 * sizeof(long) + 1];
+    char *p = buf + sizeof(buf);
+    if (base < 2) base = 10;
+    do {
+      int digit = v % base;
+      *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+      v /= base;
+    } while (v);
+    return write(p, buf + sizeof(buf) - p);
+  }
+};
+
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print &p) const = 0;
+};
+
+inline size_t Print::print(const Printable &p) { return p.printTo(*this); }
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual int read(uint8_t *buf, size_t size) {
+    size_t n = 0;
+    while (n < size) {
+      int c = read();
+      if (c < 0) break;
+      buf[n++] = (uint8_t)c;
+    }
+    return (int)n;
+  }
+  size_t readBytes(uint8_t *buf, size_t size) { return timedRead(buf, size); }
+  size_t readBytes(char *buf, size_t size) { return timedRead((uint8_t *)buf, size); }
+  String readStringUntil(char terminator);
+  String readString();
+  void setTimeout(unsigned long ms) { timeout_ = ms; }
+  unsigned long getTimeout() const { return timeout_; }
+
+protected:
+  size_t timedRead(uint8_t *buf, size_t size);
+  unsigned long timeout_ = 1000;
+};
+
+#endif // HOST_PRINT_H
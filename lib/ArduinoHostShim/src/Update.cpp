@@ -0,0 +1,214 @@
+/**
+ * Update.cpp
+ *
+ * File backed implementation of the ESP32 Update class for the native build.
+ * The image is written to "<partition>.tmp" and renamed on end(), so an
+ * aborted update never replaces a previously installed image.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "Update.h"
+#include "esp_ota_ops.h"
+#include <string.h>
+#include <string>
+
+UpdateClass Update;
+
+static std::string partitionFile() {
+  return hostEnv("OTA_HOST_PARTITION", "ota_partition.bin");
+}
+
+bool UpdateClass::begin(size_t size, int, int, uint8_t, const char *) {
+  if (file_) {
+    error_ = UPDATE_ERROR_BAD_ARGUMENT;
+    return false;
+  }
+  size_t maxSize = (size_t)hostEnvInt("OTA_HOST_PARTITION_SIZE", 0x1E0000);
+  if (size != UPDATE_SIZE_UNKNOWN && size > maxSize) {
+    error_ = UPDATE_ERROR_SPACE;
+    return false;
+  }
+  file_ = fopen((partitionFile() + ".tmp").c_str(), "wb");
+  if (!file_) {
+    error_ = UPDATE_ERROR_NO_PARTITION;
+    return false;
+  }
+  size_ = size;
+  progress_ = 0;
+  error_ = UPDATE_ERROR_OK;
+  return true;
+}
+
+size_t UpdateClass::write(uint8_t *data, size_t len) {
+  if (!file_ || hasError()) return 0;
+  if (size_ != UPDATE_SIZE_UNKNOWN && progress_ + len > size_) {
+    error_ = UPDATE_ERROR_SPACE;
+    return 0;
+  }
+  if (progress_ == 0 && len > 0 && data[0] != 0xE9 && hostEnvInt("OTA_HOST_CHECK_MAGIC", 0)) {
+    error_ = UPDATE_ERROR_MAGIC_BYTE;
+    return 0;
+  }
+  size_t n = fwrite(data, 1, len, file_);
+  if (n != len) error_ = UPDATE_ERROR_WRITE;
+  progress_ += n;
+  hostStats.partitionBytes += n;
+  if (progressCb_) progressCb_(progress_, size_);
+  return n;
+}
+
+size_t UpdateClass::writeStream(Stream &data) {
+  uint8_t buf[4096];
+  size_t written = 0;
+  while (size_ == UPDATE_SIZE_UNKNOWN || progress_ < size_) {
+    size_t want = sizeof(buf);
+    if (size_ != UPDATE_SIZE_UNKNOWN && size_ - progress_ < want) want = size_ - progress_;
+    size_t n = data.readBytes(buf, want);
+    if (!n) {
+      if (size_ != UPDATE_SIZE_UNKNOWN) error_ = UPDATE_ERROR_STREAM;
+      break;
+    }
+    if (write(buf, n) != n) break;
+    written += n;
+  }
+  return written;
+}
+
+bool UpdateClass::end(bool evenIfRemaining) {
+  if (!file_) return false;
+  if (!evenIfRemaining && (hasError() || (size_ != UPDATE_SIZE_UNKNOWN && progress_ != size_))) {
+    if (!hasError()) error_ = UPDATE_ERROR_SIZE;
+    abort();
+    return false;
+  }
+  fclose(file_);
+  file_ = nullptr;
+  std::string target = partitionFile();
+  if (rename((target + ".tmp").c_str(), target.c_str()) != 0) {
+    error_ = UPDATE_ERROR_ACTIVATE;
+    return false;
+  }
+  size_ = progress_;
+  return true;
+}
+
+void UpdateClass::abort() {
+  if (file_) {
+    fclose(file_);
+    file_ = nullptr;
+    remove((partitionFile() + ".tmp").c_str());
+  }
+  if (!hasError()) error_ = UPDATE_ERROR_ABORT;
+}
+
+const char *UpdateClass::errorString() {
+  static const char *const names[] = {"No Error", "Flash Write Failed", "Flash Erase Failed", "Flash Read Failed",
+                                      "Not Enough Space", "Bad Size Given", "Stream Read Timeout", "MD5 Check Failed",
+                                      "Wrong Magic Byte", "Could Not Activate The Firmware", "Partition Could Not be Found",
+                                      "Bad Argument", "Aborted"};
+  return error_ < sizeof(names) / sizeof(names[0]) ? names[error_] : "Unknown Error";
+}
+
+// ---------------------------------------------------------------------------
+// Partitions and OTA operations (esp_ota_ops.h, esp_partition.h)
+// The running partition "app0" is the file OTA_HOST_RUNNING, the update partition
+// "app1" is written to "<partition>.tmp" like the Update class and becomes
+// OTA_HOST_PARTITION in esp_ota_set_boot_partition().
+// ---------------------------------------------------------------------------
+
+static std::string runningFile() {
+  return hostEnv("OTA_HOST_RUNNING", partitionFile().c_str());
+}
+
+static esp_partition_t runningPartition = { 0, 0, "app0" };
+static esp_partition_t updatePartition = { 0, 0, "app1" };
+static FILE *otaFile = nullptr;
+
+static std::string fileOf(const esp_partition_t *partition) {
+  return partition == &updatePartition ? partitionFile() + ".tmp" : runningFile();
+}
+
+const esp_partition_t *esp_ota_get_running_partition() {
+  FILE *f = fopen(runningFile().c_str(), "rb");
+  if (!f) return nullptr;
+  fseek(f, 0, SEEK_END);
+  runningPartition.size = (uint32_t)ftell(f);
+  fclose(f);
+  return &runningPartition;
+}
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *) {
+  updatePartition.size = (uint32_t)hostEnvInt("OTA_HOST_PARTITION_SIZE", 0x1E0000);
+  return &updatePartition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t offset, void *dst, size_t size) {
+  if (!partition || offset + size > partition->size) return ESP_FAIL;
+  if (partition == &updatePartition && otaFile) fflush(otaFile);
+  FILE *f = fopen(fileOf(partition).c_str(), "rb");
+  if (!f) return ESP_FAIL;
+  bool ok = fseek(f, (long)offset, SEEK_SET) == 0 && fread(dst, 1, size, f) == size;
+  fclose(f);
+  return ok ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle) {
+  if (partition != &updatePartition || otaFile) return ESP_FAIL;
+  if (image_size != OTA_SIZE_UNKNOWN && image_size > partition->size) return ESP_ERR_INVALID_SIZE;
+  otaFile = fopen(fileOf(partition).c_str(), "w+b");
+  if (!otaFile) return ESP_FAIL;
+  // "Erase": the file gets the image size, so writes at any offset are possible
+  if (image_size != OTA_SIZE_UNKNOWN && image_size > 0) {
+    fseek(otaFile, (long)image_size - 1, SEEK_SET);
+    fputc(0xFF, otaFile);
+  }
+  *out_handle = 1;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_write_with_offset(esp_ota_handle_t handle, const void *data, size_t size, uint32_t offset) {
+  if (handle != 1 || !otaFile || offset + size > updatePartition.size) return ESP_FAIL;
+  if (fseek(otaFile, (long)offset, SEEK_SET) != 0 || fwrite(data, 1, size, otaFile) != size) return ESP_FAIL;
+  hostStats.partitionBytes += size;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle) {
+  if (handle != 1 || !otaFile) return ESP_FAIL;
+  bool ok = fclose(otaFile) == 0;
+  otaFile = nullptr;
+  return ok ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t) {
+  if (otaFile) fclose(otaFile);
+  otaFile = nullptr;
+  remove(fileOf(&updatePartition).c_str());
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition) {
+  if (partition != &updatePartition || otaFile) return ESP_FAIL;
+  return rename(fileOf(partition).c_str(), partitionFile().c_str()) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+uint32_t EspClass::getSketchSize() {
+  const esp_partition_t *running = esp_ota_get_running_partition();
+  return running ? running->size : 0;
+}
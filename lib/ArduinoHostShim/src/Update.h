@@ -0,0 +1,85 @@
+/**
+ * Update.h
+ *
+ * Host implementation of the ESP32 Update class for the native build.
+ * The OTA "partition" is a file (OTA_HOST_PARTITION), written sequentially
+ * like the flash partition on the target.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_UPDATE_H
+#define HOST_UPDATE_H
+
+#include <stdio.h>
+#include <functional>
+#include "Arduino.h"
+
+#define UPDATE_ERROR_OK 0
+#define UPDATE_ERROR_WRITE 1
+#define UPDATE_ERROR_ERASE 2
+#define UPDATE_ERROR_READ 3
+#define UPDATE_ERROR_SPACE 4
+#define UPDATE_ERROR_SIZE 5
+#define UPDATE_ERROR_STREAM 6
+#define UPDATE_ERROR_MD5 7
+#define UPDATE_ERROR_MAGIC_BYTE 8
+#define UPDATE_ERROR_ACTIVATE 9
+#define UPDATE_ERROR_NO_PARTITION 10
+#define UPDATE_ERROR_BAD_ARGUMENT 11
+#define UPDATE_ERROR_ABORT 12
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+#define U_FLASH 0
+#define U_SPIFFS 100
+
+class UpdateClass {
+public:
+  typedef std::function<void(size_t, size_t)> THandlerFunction_Progress;
+
+  bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH, int ledPin = -1, uint8_t ledOn = LOW,
+             const char *label = nullptr);
+  size_t write(uint8_t *data, size_t len);
+  size_t writeStream(Stream &data);
+  bool end(bool evenIfRemaining = false);
+  void abort();
+  bool setMD5(const char *) { return true; }
+  UpdateClass &onProgress(THandlerFunction_Progress fn) { progressCb_ = fn; return *this; }
+
+  void printError(Print &out) { out.println(errorString()); }
+  const char *errorString();
+  bool hasError() const { return error_ != UPDATE_ERROR_OK; }
+  uint8_t getError() const { return error_; }
+  void clearError() { error_ = UPDATE_ERROR_OK; }
+  bool isRunning() const { return file_ != nullptr; }
+  bool isFinished() const { return size_ != UPDATE_SIZE_UNKNOWN && progress_ == size_; }
+  size_t size() const { return size_; }
+  size_t progress() const { return progress_; }
+  size_t remaining() const { return size_ == UPDATE_SIZE_UNKNOWN ? 0 : size_ - progress_; }
+
+private:
+  FILE *file_ = nullptr;
+  size_t size_ = 0;
+  size_t progress_ = 0;
+  uint8_t error_ = UPDATE_ERROR_OK;
+  THandlerFunction_Progress progressCb_;
+};
+
+extern UpdateClass Update;
+
+#endif // HOST_UPDATE_H
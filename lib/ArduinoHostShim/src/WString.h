@@ -0,0 +1,169 @@
+/**
+ * WString.h
+ *
+ * Host implementation of the Arduino String class for the native build.
+ * Covers the subset of the ESP8266/ESP32 String API used by the OTA Template.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+#include <strings.h>
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+#define PSTR(s) (s)
+
+class String {
+public:
+  String() {}
+  String(const char *s) : s_(s ? s : "") {}
+  String(const char *s, size_t len) : s_(s, len) {}
+  String(const std::string &s) : s_(s) {}
+  String(const __FlashStringHelper *s) : s_(reinterpret_cast<const char *>(s)) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(int v, unsigned char base = 10) { fromLong(v, base); }
+  explicit String(unsigned int v, unsigned char base = 10) { fromULong(v, base); }
+  explicit String(long v, unsigned char base = 10) { fromLong(v, base); }
+  explicit String(unsigned long v, unsigned char base = 10) { fromULong(v, base); }
+  explicit String(long long v) { fromLong((long)v, 10); }
+  explicit String(unsigned long long v) { fromULong((unsigned long)v, 10); }
+  explicit String(float v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+  explicit String(double v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+
+  const char *c_str() const { return s_.c_str(); }
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  bool reserve(unsigned int size) { s_.reserve(size); return true; }
+
+  char charAt(unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  char &operator[](unsigned int i) { return s_[i]; }
+
+  String &operator=(const char *s) { s_ = s ? s : ""; return *this; }
+  String &operator+=(const String &o) { s_ += o.s_; return *this; }
+  String &operator+=(const char *s) { if (s) s_ += s; return *this; }
+  String &operator+=(const __FlashStringHelper *s) { s_ += reinterpret_cast<const char *>(s); return *this; }
+  String &operator+=(char c) { s_ += c; return *this; }
+  String &operator+=(int v) { return *this += String(v); }
+  String &operator+=(unsigned int v) { return *this += String(v); }
+  String &operator+=(long v) { return *this += String(v); }
+  String &operator+=(unsigned long v) { return *this += String(v); }
+  bool concat(const String &o) { s_ += o.s_; return true; }
+  bool concat(const char *s) { if (s) s_ += s; return true; }
+  bool concat(const char *s, unsigned int len) { s_.append(s, len); return true; }
+  bool concat(char c) { s_ += c; return true; }
+
+  bool operator==(const String &o) const { return s_ == o.s_; }
+  bool operator==(const char *s) const { return s_ == (s ? s : ""); }
+  bool operator!=(const String &o) const { return s_ != o.s_; }
+  bool operator!=(const char *s) const { return !(*this == s); }
+  bool operator<(const String &o) const { return s_ < o.s_; }
+  bool equals(const String &o) const { return s_ == o.s_; }
+  bool equalsIgnoreCase(const String &o) const { return strcasecmp(s_.c_str(), o.s_.c_str()) == 0; }
+  bool startsWith(const String &p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  bool endsWith(const String &p) const {
+    return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t p = s_.find(c, from);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  int indexOf(const String &str, unsigned int from = 0) const {
+    size_t p = s_.find(str.s_, from);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  int lastIndexOf(char c) const {
+    size_t p = s_.rfind(c);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  String substring(unsigned int from) const {
+    return from >= s_.size() ? String() : String(s_.substr(from));
+  }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from >= s_.size()) return String();
+    return String(s_.substr(from, to - from));
+  }
+
+  long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+  float toFloat() const { return (float)strtod(s_.c_str(), nullptr); }
+  void trim() {
+    size_t b = s_.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) { s_.clear(); return; }
+    size_t e = s_.find_last_not_of(" \t\r\n");
+    s_ = s_.substr(b, e - b + 1);
+  }
+  void toLowerCase() { for (size_t i = 0; i < s_.size(); ++i) s_[i] = (char)tolower((unsigned char)s_[i]); }
+  void toUpperCase() { for (size_t i = 0; i < s_.size(); ++i) s_[i] = (char)toupper((unsigned char)s_[i]); }
+  void replace(const String &from, const String &to) {
+    if (from.s_.empty()) return;
+    size_t p = 0;
+    while ((p = s_.find(from.s_, p)) != std::string::npos) {
+      s_.replace(p, from.s_.size(), to.s_);
+      p += to.s_.size();
+    }
+  }
+  void remove(unsigned int index, unsigned int count = (unsigned int)-1) {
+    if (index < s_.size()) s_.erase(index, count);
+  }
+  void toCharArray(char *buf, unsigned int size, unsigned int index = 0) const { getBytes(buf, size, index); }
+  void getBytes(char *buf, unsigned int size, unsigned int index = 0) const {
+    if (!size || !buf) return;
+    if (index >= s_.size()) { buf[0] = 0; return; }
+    size_t n = s_.size() - index;
+    if (n > size - 1) n = size - 1;
+    memcpy(buf, s_.data() + index, n);
+    buf[n] = 0;
+  }
+
+  friend String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+  friend String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+  friend String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+  friend String operator+(const String &a, char c) { String r(a); r += c; return r; }
+
+private:
+  void fromLong(long v, unsigned char base) {
+    if (v < 0 && base == 10) { s_ = "-"; fromULongAppend((unsigned long)(-v), base); }
+    else fromULong((unsigned long)v, base);
+  }
+  void fromULong(unsigned long v, unsigned char base) { s_.clear(); fromULongAppend(v, base); }
+  void fromULongAppend(unsigned long v, unsigned char base) {
+    char buf[72];
+    int i = 0;
+    do { unsigned d = v % base; buf[i++] = (char)(d < 10 ? '0' + d : 'a' + d - 10); v /= base; } while (v);
+    while (i) s_ += buf[--i];
+  }
+  void fromDouble(double v, unsigned char decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    s_ = buf;
+  }
+
+  std::string s_;
+};
+
+#endif // HOST_WSTRING_H
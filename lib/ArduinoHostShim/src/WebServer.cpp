@@ -0,0 +1,239 @@
+/**
+ * WebServer.cpp
+ *
+ * Host implementation of the synchronous ESP32 WebServer for the native build.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "WebServer.h"
+
+static const char *statusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 416: return "Range Not Satisfiable";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+void WebServer::begin() {
+  server_.begin((uint16_t)port_);
+}
+
+void WebServer::on(const String &uri, HTTPMethod method, THandlerFunction fn) {
+  Handler h;
+  h.uri = uri.c_str();
+  h.method = method;
+  h.fn = fn;
+  handlers_.push_back(h);
+}
+
+std::string WebServer::urlDecode(const std::string &s) {
+  std::string out;
+  out.reserve(s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '+') out += ' ';
+    else if (s[i] == '%' && i + 2 < s.size()) {
+      out += (char)strtol(s.substr(i + 1, 2).c_str(), nullptr, 16);
+      i += 2;
+    } else out += s[i];
+  }
+  return out;
+}
+
+void WebServer::parseArgs(const std::string &data) {
+  size_t pos = 0;
+  while (pos < data.size()) {
+    size_t amp = data.find('&', pos);
+    if (amp == std::string::npos) amp = data.size();
+    std::string pair = data.substr(pos, amp - pos);
+    size_t eq = pair.find('=');
+    if (!pair.empty()) {
+      if (eq == std::string::npos) args_.push_back(std::make_pair(urlDecode(pair), std::string()));
+      else args_.push_back(std::make_pair(urlDecode(pair.substr(0, eq)), urlDecode(pair.substr(eq + 1))));
+    }
+    pos = amp + 1;
+  }
+}
+
+bool WebServer::readRequest() {
+  client_.setTimeout(2000);
+  String line = client_.readStringUntil('\n');
+  line.trim();
+  int sp1 = line.indexOf(' ');
+  int sp2 = line.indexOf(' ', sp1 + 1);
+  if (sp1 < 0 || sp2 < 0) return false;
+  String m = line.substring(0, sp1);
+  std::string url = line.substring(sp1 + 1, sp2).c_str();
+
+  method_ = HTTP_ANY;
+  if (m == "GET") method_ = HTTP_GET;
+  else if (m == "HEAD") method_ = HTTP_HEAD;
+  else if (m == "POST") method_ = HTTP_POST;
+  else if (m == "PUT") method_ = HTTP_PUT;
+  else if (m == "PATCH") method_ = HTTP_PATCH;
+  else if (m == "DELETE") method_ = HTTP_DELETE;
+  else if (m == "OPTIONS") method_ = HTTP_OPTIONS;
+
+  args_.clear();
+  headers_.clear();
+  size_t q = url.find('?');
+  uri_ = url.substr(0, q);
+  if (q != std::string::npos) parseArgs(url.substr(q + 1));
+
+  long contentLength = 0;
+  std::string contentType;
+  for (;;) {
+    String h = client_.readStringUntil('\n');
+    h.trim();
+    if (h.length() == 0) break;
+    int colon = h.indexOf(':');
+    if (colon < 0) continue;
+    String name = h.substring(0, colon);
+    String value = h.substring(colon + 1);
+    value.trim();
+    headers_.push_back(std::make_pair(std::string(name.c_str()), std::string(value.c_str())));
+    if (name.equalsIgnoreCase("Content-Length")) contentLength = value.toInt();
+    if (name.equalsIgnoreCase("Content-Type")) contentType = value.c_str();
+  }
+
+  if (contentLength > 0) {
+    std::string body((size_t)contentLength, '\0');
+    size_t n = client_.readBytes((uint8_t *)&body[0], (size_t)contentLength);
+    body.resize(n);
+    if (contentType.find("application/x-www-form-urlencoded") != std::string::npos) parseArgs(body);
+    else args_.push_back(std::make_pair(std::string("plain"), body));
+  }
+  return true;
+}
+
+void WebServer::handleClient() {
+  WiFiClient c = server_.available();
+  if (!c) return;
+  client_ = c;
+  if (readRequest()) {
+    respHeaders_.clear();
+    contentLength_ = CONTENT_LENGTH_NOT_SET;
+    chunked_ = false;
+    bool handled = false;
+    for (size_t i = 0; i < handlers_.size(); ++i) {
+      if (handlers_[i].uri == uri_ && (handlers_[i].method == HTTP_ANY || handlers_[i].method == method_)) {
+        handlers_[i].fn();
+        handled = true;
+        break;
+      }
+    }
+    if (!handled) {
+      if (notFound_) notFound_();
+      else send(404, "text/plain", String("Not found: ") + uri_.c_str());
+    }
+    if (chunked_) sendContent("", 0);  // Terminating chunk
+  }
+  client_ = WiFiClient();  // Drop the reference, handlers may keep their own copy
+}
+
+void WebServer::hostRequest(HTTPMethod method, const char *uri, const char *query) {
+  method_ = method;
+  uri_ = uri ? uri : "";
+  args_.clear();
+  headers_.clear();
+  if (query && *query) parseArgs(query);
+  client_ = WiFiClient();
+}
+
+String WebServer::arg(const String &name) const {
+  for (size_t i = 0; i < args_.size(); ++i) {
+    if (args_[i].first == name.c_str()) return String(args_[i].second);
+  }
+  return String();
+}
+
+String WebServer::arg(int i) const {
+  return i >= 0 && (size_t)i < args_.size() ? String(args_[i].second) : String();
+}
+
+String WebServer::argName(int i) const {
+  return i >= 0 && (size_t)i < args_.size() ? String(args_[i].first) : String();
+}
+
+bool WebServer::hasArg(const String &name) const {
+  for (size_t i = 0; i < args_.size(); ++i) {
+    if (args_[i].first == name.c_str()) return true;
+  }
+  return false;
+}
+
+String WebServer::header(const String &name) const {
+  for (size_t i = 0; i < headers_.size(); ++i) {
+    if (strcasecmp(headers_[i].first.c_str(), name.c_str()) == 0) return String(headers_[i].second);
+  }
+  return String();
+}
+
+bool WebServer::hasHeader(const String &name) const {
+  for (size_t i = 0; i < headers_.size(); ++i) {
+    if (strcasecmp(headers_[i].first.c_str(), name.c_str()) == 0) return true;
+  }
+  return false;
+}
+
+void WebServer::sendHeader(const String &name, const String &value, bool first) {
+  std::string h = std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+  if (first) respHeaders_ = h + respHeaders_;
+  else respHeaders_ += h;
+}
+
+void WebServer::send(int code, const char *contentType, const String &content) {
+  std::string head = "HTTP/1.1 " + std::to_string(code) + " " + statusText(code) + "\r\n";
+  if (contentType && *contentType) head += std::string("Content-Type: ") + contentType + "\r\n";
+  if (contentLength_ == CONTENT_LENGTH_UNKNOWN) {
+    head += "Transfer-Encoding: chunked\r\n";
+    chunked_ = true;
+  } else {
+    size_t len = contentLength_ == CONTENT_LENGTH_NOT_SET ? content.length() : contentLength_;
+    head += "Content-Length: " + std::to_string(len) + "\r\n";
+  }
+  head += respHeaders_;
+  head += "Connection: close\r\n\r\n";
+  respHeaders_.clear();
+  client_.write((const uint8_t *)head.data(), head.size());
+  if (content.length()) sendContent(content);
+}
+
+void WebServer::sendContent(const char *content, size_t size) {
+  if (chunked_) {
+    char hdr[16];
+    int n = snprintf(hdr, sizeof(hdr), "%zx\r\n", size);
+    client_.write((const uint8_t *)hdr, n);
+    if (size) client_.write((const uint8_t *)content, size);
+    client_.write((const uint8_t *)"\r\n", 2);
+    if (!size) chunked_ = false;
+  } else if (size) {
+    client_.write((const uint8_t *)content, size);
+  }
+}
@@ -0,0 +1,111 @@
+/**
+ * WebServer.h
+ *
+ * Host implementation of the synchronous ESP32 WebServer for the native build.
+ * Like on the target, handleClient() serves at most one request per call and
+ * closes the connection after the response, unless the handler keeps a copy
+ * of server.client() (e.g. for Server-Sent Events).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_WEBSERVER_H
+#define HOST_WEBSERVER_H
+
+#include <functional>
+#include <vector>
+#include <string>
+#include <utility>
+#include "WiFi.h"
+#include "HTTP_Method.h"
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80) : server_((uint16_t)port), port_(port) {}
+
+  void begin();
+  void begin(uint16_t port) { port_ = port; begin(); }
+  void stop() { server_.close(); }
+  void close() { server_.close(); }
+  void handleClient();
+
+  void on(const String &uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+  void on(const String &uri, HTTPMethod method, THandlerFunction fn);
+  void onNotFound(THandlerFunction fn) { notFound_ = fn; }
+
+  String uri() const { return String(uri_); }
+  HTTPMethod method() const { return method_; }
+  WiFiClient &client() { return client_; }
+
+  String arg(const String &name) const;
+  String arg(int i) const;
+  String argName(int i) const;
+  int args() const { return (int)args_.size(); }
+  bool hasArg(const String &name) const;
+  String header(const String &name) const;
+  bool hasHeader(const String &name) const;
+  String hostHeader() const { return header("Host"); }
+
+  void send(int code, const char *contentType = nullptr, const String &content = String());
+  void send(int code, const String &contentType, const String &content) { send(code, contentType.c_str(), content); }
+  void send(int code, const char *contentType, const char *content) { send(code, contentType, String(content)); }
+  void send_P(int code, const char *contentType, const char *content) { send(code, contentType, String(content)); }
+  void sendHeader(const String &name, const String &value, bool first = false);
+  void setContentLength(size_t length) { contentLength_ = length; }
+  void sendContent(const String &content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char *content, size_t size);
+  void sendContent_P(const char *content) { sendContent(content, strlen(content)); }
+
+  // Port the emulated server listens on (OTA_HOST_WEB_PORT overrides the configured port)
+  uint16_t port() const { return (uint16_t)port_; }
+
+  // Sets method, URI and form arguments (url-encoded) as if a request had been received,
+  // without a client connection; used to call handlers directly (e.g. in benchmarks)
+  void hostRequest(HTTPMethod method, const char *uri, const char *query);
+
+private:
+  bool readRequest();
+  void parseArgs(const std::string &data);
+  static std::string urlDecode(const std::string &s);
+
+  WiFiServer server_;
+  int port_;
+  WiFiClient client_;
+  std::string uri_;
+  HTTPMethod method_ = HTTP_GET;
+  std::vector<std::pair<std::string, std::string> > args_;
+  std::vector<std::pair<std::string, std::string> > headers_;
+  std::string respHeaders_;
+  size_t contentLength_ = CONTENT_LENGTH_NOT_SET;
+  bool chunked_ = false;
+
+  struct Handler {
+    std::string uri;
+    HTTPMethod method;
+    THandlerFunction fn;
+  };
+  std::vector<Handler> handlers_;
+  THandlerFunction notFound_;
+};
+
+#endif // HOST_WEBSERVER_H
@@ -0,0 +1,491 @@
+/**
+ * WiFi.cpp
+ *
+ * Socket based implementation of WiFi, WiFiClient, WiFiServer and WiFiUDP
+ * for the native build.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "WiFi.h"
+#include "HostRuntime.h"
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+
+// Loopback multicast group used to emulate LAN broadcasts between native instances
+#define HOST_BROADCAST_GROUP "239.255.77.77"
+
+WiFiClass WiFi;
+
+namespace {
+struct IgnoreSigpipe {
+  IgnoreSigpipe() { signal(SIGPIPE, SIG_IGN); }
+} ignoreSigpipe;
+
+sockaddr_in toSockaddr(IPAddress ip, uint16_t port) {
+  sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  sa.sin_addr.s_addr = (uint32_t)ip;
+  return sa;
+}
+}
+
+// ---------------------------------------------------------------------------
+// WiFiClient
+// ---------------------------------------------------------------------------
+
+struct WiFiClient::Socket {
+  explicit Socket(int f) : fd(f) {}
+  ~Socket() { if (fd >= 0) ::close(fd); }
+  int fd;
+  int peeked = -1;
+};
+
+WiFiClient::WiFiClient() {}
+
+WiFiClient::WiFiClient(int fd) : sock_(std::make_shared<Socket>(fd)) {
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+WiFiClient::~WiFiClient() {}
+
+int WiFiClient::fd() const {
+  return sock_ ? sock_->fd : -1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip, port, (int32_t)timeout_);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+  stop();
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return 0;
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  sockaddr_in sa = toSockaddr(ip, port);
+  int r = ::connect(fd, (sockaddr *)&sa, sizeof(sa));
+  if (r < 0 && errno == EINPROGRESS) {
+    pollfd p = {fd, POLLOUT, 0};
+    if (poll(&p, 1, timeoutMs > 0 ? timeoutMs : 5000) == 1) {
+      int err = 0;
+      socklen_t len = sizeof(err);
+      getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+      r = err ? -1 : 0;
+    }
+  }
+  if (r < 0) {
+    ::close(fd);
+    return 0;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+  sock_ = std::make_shared<Socket>(fd);
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  hostStats.connections++;
+  return 1;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+  return connect(host, port, (int32_t)timeout_);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port, int32_t timeoutMs) {
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip)) return 0;
+  return connect(ip, port, timeoutMs);
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size) {
+  if (!sock_ || sock_->fd < 0) return 0;
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t n = ::send(sock_->fd, buf + sent, size - sent, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN) {
+        pollfd p = {sock_->fd, POLLOUT, 0};
+        if (poll(&p, 1, (int)timeout_) <= 0) break;
+        continue;
+      }
+      break;
+    }
+    sent += n;
+  }
+  hostStats.bytesTx += sent;
+  return sent;
+}
+
+int WiFiClient::availableForWrite() {
+  if (!connected()) return 0;
+  int queued = 0;
+  int sndbuf = 0;
+  socklen_t len = sizeof(sndbuf);
+  ioctl(sock_->fd, TIOCOUTQ, &queued);
+  getsockopt(sock_->fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, &len);
+  int free = sndbuf / 2 - queued;
+  return free > 0 ? free : 0;
+}
+
+int WiFiClient::available() {
+  if (!sock_ || sock_->fd < 0) return 0;
+  int n = 0;
+  if (ioctl(sock_->fd, FIONREAD, &n) < 0) return 0;
+  return n + (sock_->peeked >= 0 ? 1 : 0);
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size) {
+  if (!sock_ || sock_->fd < 0 || size == 0) return -1;
+  size_t off = 0;
+  if (sock_->peeked >= 0) {
+    buf[off++] = (uint8_t)sock_->peeked;
+    sock_->peeked = -1;
+    if (off == size) return 1;
+  }
+  ssize_t n = ::recv(sock_->fd, buf + off, size - off, MSG_DONTWAIT);
+  if (n <= 0) return off ? (int)off : -1;
+  hostStats.bytesRx += n;
+  return (int)(off + n);
+}
+
+int WiFiClient::peek() {
+  if (!sock_ || sock_->fd < 0) return -1;
+  if (sock_->peeked < 0) {
+    uint8_t c;
+    if (::recv(sock_->fd, &c, 1, MSG_DONTWAIT) == 1) {
+      hostStats.bytesRx++;
+      sock_->peeked = c;
+    }
+  }
+  return sock_->peeked;
+}
+
+void WiFiClient::stop() {
+  if (sock_ && sock_->fd >= 0) {
+    ::shutdown(sock_->fd, SHUT_RDWR);
+    ::close(sock_->fd);
+    sock_->fd = -1;
+  }
+  sock_.reset();
+}
+
+uint8_t WiFiClient::connected() {
+  if (!sock_ || sock_->fd < 0) return 0;
+  if (sock_->peeked >= 0) return 1;
+  char c;
+  ssize_t n = ::recv(sock_->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n == 0) return 0;                                    // Orderly shutdown by peer
+  if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) return 0;
+  return 1;
+}
+
+void WiFiClient::setNoDelay(bool noDelay) {
+  if (!sock_ || sock_->fd < 0) return;
+  int v = noDelay ? 1 : 0;
+  setsockopt(sock_->fd, IPPROTO_TCP, TCP_NODELAY, &v, sizeof(v));
+}
+
+IPAddress WiFiClient::remoteIP() const {
+  sockaddr_in sa;
+  socklen_t len = sizeof(sa);
+  if (!sock_ || getpeername(sock_->fd, (sockaddr *)&sa, &len) < 0) return IPAddress();
+  return IPAddress((uint32_t)sa.sin_addr.s_addr);
+}
+
+uint16_t WiFiClient::remotePort() const {
+  sockaddr_in sa;
+  socklen_t len = sizeof(sa);
+  if (!sock_ || getpeername(sock_->fd, (sockaddr *)&sa, &len) < 0) return 0;
+  return ntohs(sa.sin_port);
+}
+
+IPAddress WiFiClient::localIP() const {
+  sockaddr_in sa;
+  socklen_t len = sizeof(sa);
+  if (!sock_ || getsockname(sock_->fd, (sockaddr *)&sa, &len) < 0) return IPAddress();
+  return IPAddress((uint32_t)sa.sin_addr.s_addr);
+}
+
+// ---------------------------------------------------------------------------
+// WiFiServer
+// ---------------------------------------------------------------------------
+
+void WiFiServer::begin(uint16_t port) {
+  if (port) port_ = port;
+  // Port 80 needs root on the host, OTA_HOST_WEB_PORT moves it
+  long override = hostEnvInt("OTA_HOST_WEB_PORT", 0);
+  if (port_ == 80 && override > 0) port_ = (uint16_t)override;
+  close();
+  fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in sa = toSockaddr(IPAddress(0, 0, 0, 0), port_);
+  if (bind(fd_, (sockaddr *)&sa, sizeof(sa)) < 0 || listen(fd_, 16) < 0) {
+    fprintf(stderr, "[host] cannot listen on port %u: %s\n", port_, strerror(errno));
+    ::close(fd_);
+    fd_ = -1;
+    return;
+  }
+  fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+  fprintf(stderr, "[host] listening on port %u\n", port_);
+}
+
+void WiFiServer::close() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+}
+
+WiFiClient WiFiServer::available() {
+  if (fd_ < 0) return WiFiClient();
+  int c = ::accept(fd_, nullptr, nullptr);
+  if (c < 0) return WiFiClient();
+  hostStats.accepted++;
+  return WiFiClient(c);
+}
+
+// ---------------------------------------------------------------------------
+// WiFiUDP
+// ---------------------------------------------------------------------------
+
+bool WiFiUDP::ensureSocket() {
+  if (fd_ >= 0) return true;
+  fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd_ < 0) return false;
+  int one = 1;
+  setsockopt(fd_, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+  in_addr lo;
+  lo.s_addr = htonl(INADDR_LOOPBACK);
+  setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_IF, &lo, sizeof(lo));
+  unsigned char loop = 1;
+  setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+  fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+  return true;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+  stop();
+  if (!ensureSocket()) return 0;
+  int one = 1;
+  setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+  sockaddr_in sa = toSockaddr(IPAddress(0, 0, 0, 0), port);
+  if (bind(fd_, (sockaddr *)&sa, sizeof(sa)) < 0) {
+    stop();
+    return 0;
+  }
+  localPort_ = port;
+  // Join the emulated broadcast group, so broadcasts of other instances arrive here
+  ip_mreq mreq;
+  mreq.imr_multiaddr.s_addr = inet_addr(HOST_BROADCAST_GROUP);
+  mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+  setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+  return 1;
+}
+
+uint8_t WiFiUDP::beginMulticast(IPAddress multicast, uint16_t port) {
+  if (!begin(port)) return 0;
+  ip_mreq mreq;
+  mreq.imr_multiaddr.s_addr = (uint32_t)multicast;
+  mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+  setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+  return 1;
+}
+
+void WiFiUDP::stop() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+  rx_.clear();
+  rxPos_ = 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+  if (!ensureSocket()) return 0;
+  tx_.clear();
+  txIp_ = ip;
+  txPort_ = port;
+  return 1;
+}
+
+int WiFiUDP::beginPacket(const char *host, uint16_t port) {
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip)) return 0;
+  return beginPacket(ip, port);
+}
+
+int WiFiUDP::endPacket() {
+  if (fd_ < 0) return 0;
+  IPAddress dest = txIp_;
+  if (dest == IPAddress(255, 255, 255, 255)) {
+    IPAddress group;
+    group.fromString(HOST_BROADCAST_GROUP);
+    dest = group;
+  }
+  sockaddr_in sa = toSockaddr(dest, txPort_);
+  ssize_t n = sendto(fd_, tx_.data(), tx_.size(), 0, (sockaddr *)&sa, sizeof(sa));
+  if (n > 0) hostStats.bytesTx += n;
+  tx_.clear();
+  return n >= 0 ? 1 : 0;
+}
+
+size_t WiFiUDP::write(uint8_t c) {
+  tx_.push_back(c);
+  return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t *buf, size_t size) {
+  tx_.insert(tx_.end(), buf, buf + size);
+  return size;
+}
+
+int WiFiUDP::parsePacket() {
+  if (fd_ < 0) return 0;
+  uint8_t buf[1500];
+  sockaddr_in sa;
+  socklen_t len = sizeof(sa);
+  ssize_t n = recvfrom(fd_, buf, sizeof(buf), MSG_DONTWAIT, (sockaddr *)&sa, &len);
+  static long lossPercent = hostEnvInt("OTA_HOST_UDP_LOSS", 0);
+  static unsigned lossSeed = (unsigned)getpid();
+  if (n > 0 && lossPercent > 0 && rand_r(&lossSeed) % 100 < lossPercent) n = 0; // Emulated packet loss
+  if (n <= 0) {
+    rx_.clear();
+    rxPos_ = 0;
+    return 0;
+  }
+  hostStats.bytesRx += n;
+  rx_.assign(buf, buf + n);
+  rxPos_ = 0;
+  remoteIp_ = IPAddress((uint32_t)sa.sin_addr.s_addr);
+  remotePort_ = ntohs(sa.sin_port);
+  return (int)n;
+}
+
+int WiFiUDP::available() {
+  return (int)(rx_.size() - rxPos_);
+}
+
+int WiFiUDP::read() {
+  return rxPos_ < rx_.size() ? rx_[rxPos_++] : -1;
+}
+
+int WiFiUDP::read(uint8_t *buf, size_t size) {
+  size_t n = std::min(size, rx_.size() - rxPos_);
+  memcpy(buf, rx_.data() + rxPos_, n);
+  rxPos_ += n;
+  return (int)n;
+}
+
+int WiFiUDP::peek() {
+  return rxPos_ < rx_.size() ? rx_[rxPos_] : -1;
+}
+
+// ---------------------------------------------------------------------------
+// WiFiClass
+// ---------------------------------------------------------------------------
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *, int32_t channel, const uint8_t *bssid, bool connect) {
+  ssid_ = ssid ? ssid : "";
+  if (bssid && channel > 0) {
+    directConnects++;
+    // A cached BSSID that does not match the emulated AP fails like on real hardware
+    if (memcmp(bssid, bssid_, 6) != 0) {
+      status_ = WL_NO_SSID_AVAIL;
+      return status_;
+    }
+    connectAt_ = millis() + (unsigned long)hostEnvInt("OTA_HOST_WIFI_DELAY", 0) / 4;
+  } else {
+    fullScans++;
+    connectAt_ = millis() + (unsigned long)hostEnvInt("OTA_HOST_WIFI_DELAY", 0);
+  }
+  connecting_ = connect;
+  status_ = connect ? WL_DISCONNECTED : WL_IDLE_STATUS;
+  return status_;
+}
+
+bool WiFiClass::config(IPAddress, IPAddress, IPAddress, IPAddress, IPAddress) {
+  return true;
+}
+
+bool WiFiClass::disconnect(bool, bool) {
+  status_ = WL_DISCONNECTED;
+  connecting_ = false;
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  if (status_ == WL_DISCONNECTED && connecting_ && millis() >= connectAt_) status_ = WL_CONNECTED;
+  return status_;
+}
+
+uint8_t WiFiClass::waitForConnectResult(unsigned long timeoutMs) {
+  unsigned long start = millis();
+  while (status() == WL_DISCONNECTED && millis() - start < timeoutMs) delay(10);
+  return status();
+}
+
+IPAddress WiFiClass::localIP() const {
+  return status_ == WL_CONNECTED ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+uint8_t *WiFiClass::BSSID() {
+  return bssid_;
+}
+
+String WiFiClass::BSSIDstr() {
+  char buf[18];
+  snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X",
+           bssid_[0], bssid_[1], bssid_[2], bssid_[3], bssid_[4], bssid_[5]);
+  return String(buf);
+}
+
+uint8_t *WiFiClass::macAddress(uint8_t *mac) {
+  static const uint8_t m[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+  memcpy(mac, m, 6);
+  return mac;
+}
+
+int WiFiClass::hostByName(const char *host, IPAddress &result) {
+  if (result.fromString(host)) return 1;
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  addrinfo *res = nullptr;
+  if (getaddrinfo(host, nullptr, &hints, &res) != 0 || !res) return 0;
+  result = IPAddress((uint32_t)((sockaddr_in *)res->ai_addr)->sin_addr.s_addr);
+  freeaddrinfo(res);
+  return 1;
+}
@@ -0,0 +1,188 @@
+/**
+ * WiFi.h
+ *
+ * Host implementation of the ESP32 WiFi API for the native build.
+ * The station is always "connected" to the loopback network; WiFiClient,
+ * WiFiServer and WiFiUDP are backed by POSIX sockets. UDP broadcasts are
+ * mapped to a loopback multicast group, so several native instances on one
+ * machine receive each other's broadcasts.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <memory>
+#include <vector>
+#include "Arduino.h"
+#include "IPAddress.h"
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+typedef enum { WIFI_PS_NONE = 0, WIFI_PS_MIN_MODEM = 1, WIFI_PS_MAX_MODEM = 2 } wifi_ps_type_t;
+
+class WiFiClient : public Stream {
+public:
+  WiFiClient();
+  explicit WiFiClient(int fd);
+  virtual ~WiFiClient();
+
+  virtual int connect(IPAddress ip, uint16_t port);
+  virtual int connect(const char *host, uint16_t port);
+  virtual int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+  virtual int connect(const char *host, uint16_t port, int32_t timeoutMs);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+  int availableForWrite() override;
+  int available() override;
+  int read() override;
+  int read(uint8_t *buf, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  virtual void stop();
+  virtual uint8_t connected();
+  operator bool() { return connected(); }
+  bool operator==(const WiFiClient &o) const { return sock_ == o.sock_; }
+  void setNoDelay(bool noDelay);
+  IPAddress remoteIP() const;
+  uint16_t remotePort() const;
+  IPAddress localIP() const;
+  int fd() const;
+
+protected:
+  struct Socket;
+  std::shared_ptr<Socket> sock_;
+};
+
+class WiFiServer {
+public:
+  explicit WiFiServer(uint16_t port = 80) : port_(port) {}
+  ~WiFiServer() { close(); }
+  void begin(uint16_t port = 0);
+  void close();
+  void stop() { close(); }
+  WiFiClient available();
+  WiFiClient accept() { return available(); }
+  void setNoDelay(bool) {}
+  uint16_t port() const { return port_; }
+  int fd() const { return fd_; }
+
+private:
+  uint16_t port_;
+  int fd_ = -1;
+};
+
+class WiFiUDP : public Stream {
+public:
+  WiFiUDP() {}
+  ~WiFiUDP() { stop(); }
+  uint8_t begin(uint16_t port);
+  uint8_t begin(IPAddress ip, uint16_t port) { (void)ip; return begin(port); }
+  uint8_t beginMulticast(IPAddress multicast, uint16_t port);
+  void stop();
+  int beginPacket(IPAddress ip, uint16_t port);
+  int beginPacket(const char *host, uint16_t port);
+  int endPacket();
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+  int parsePacket();
+  int available() override;
+  int read() override;
+  int read(uint8_t *buf, size_t size) override;
+  int read(char *buf, size_t size) { return read((uint8_t *)buf, size); }
+  int peek() override;
+  void flush() override {}
+  IPAddress remoteIP() const { return remoteIp_; }
+  uint16_t remotePort() const { return remotePort_; }
+
+private:
+  bool ensureSocket();
+  int fd_ = -1;
+  uint16_t localPort_ = 0;
+  std::vector<uint8_t> tx_;
+  IPAddress txIp_;
+  uint16_t txPort_ = 0;
+  std::vector<uint8_t> rx_;
+  size_t rxPos_ = 0;
+  IPAddress remoteIp_;
+  uint16_t remotePort_ = 0;
+};
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) { mode_ = m; return true; }
+  wifi_mode_t getMode() const { return mode_; }
+  wl_status_t begin(const char *ssid, const char *passphrase = nullptr, int32_t channel = 0,
+                    const uint8_t *bssid = nullptr, bool connect = true);
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet,
+              IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+  bool disconnect(bool wifiOff = false, bool eraseAp = false);
+  bool reconnect() { return begin(ssid_.c_str(), nullptr) == WL_CONNECTED; }
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  uint8_t waitForConnectResult(unsigned long timeoutMs = 60000);
+  bool setAutoReconnect(bool) { return true; }
+  bool persistent(bool) { return true; }
+  bool setSleep(bool enabled) { sleep_ = enabled ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE; return true; }
+  bool setSleep(wifi_ps_type_t type) { sleep_ = type; return true; }
+  wifi_ps_type_t getSleep() const { return sleep_; }
+  bool setHostname(const char *) { return true; }
+
+  IPAddress localIP() const;
+  IPAddress gatewayIP() const { return IPAddress(127, 0, 0, 1); }
+  IPAddress subnetMask() const { return IPAddress(255, 0, 0, 0); }
+  IPAddress dnsIP(uint8_t = 0) const { return IPAddress(127, 0, 0, 53); }
+  IPAddress broadcastIP() const { return IPAddress(255, 255, 255, 255); }
+  String SSID() const { return String(ssid_.c_str()); }
+  uint8_t *BSSID();
+  String BSSIDstr();
+  int32_t channel() const { return 6; }
+  int32_t RSSI() const { return -55; }
+  String macAddress() const { return String("AA:BB:CC:DD:EE:FF"); }
+  uint8_t *macAddress(uint8_t *mac);
+
+  int hostByName(const char *host, IPAddress &result);
+
+  // Counters of the emulation, used by the host tools
+  uint32_t fullScans = 0;        // begin() calls without BSSID/channel
+  uint32_t directConnects = 0;   // begin() calls with BSSID and channel
+
+private:
+  wifi_mode_t mode_ = WIFI_OFF;
+  wl_status_t status_ = WL_DISCONNECTED;
+  wifi_ps_type_t sleep_ = WIFI_PS_MIN_MODEM;
+  unsigned long connectAt_ = 0;
+  bool connecting_ = false;
+  std::string ssid_;
+  uint8_t bssid_[6] = {0x02, 0x00, 0x5E, 0x10, 0x00, 0x01};
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
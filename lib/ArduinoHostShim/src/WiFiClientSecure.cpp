@@ -0,0 +1,187 @@
+/**
+ * WiFiClientSecure.cpp
+ *
+ * OpenSSL based implementation of WiFiClientSecure for the native build.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "WiFiClientSecure.h"
+#include "HostRuntime.h"
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include <fcntl.h>
+#include <poll.h>
+
+namespace {
+// Counts the encrypted bytes on the socket in hostStats, like WiFiClient does for plain data
+long countBytes(BIO *, int oper, const char *, size_t, int, long, int ret, size_t *processed) {
+  if (ret > 0 && processed) {
+    if (oper == (BIO_CB_READ | BIO_CB_RETURN)) hostStats.bytesRx += *processed;
+    if (oper == (BIO_CB_WRITE | BIO_CB_RETURN)) hostStats.bytesTx += *processed;
+  }
+  return ret;
+}
+
+bool waitSocket(int fd, int err, int timeoutMs) {
+  pollfd p = {fd, (short)(err == SSL_ERROR_WANT_WRITE ? POLLOUT : POLLIN), 0};
+  return poll(&p, 1, timeoutMs) == 1;
+}
+}
+
+WiFiClientSecure::~WiFiClientSecure() {
+  stop();
+  if (session_) SSL_SESSION_free(session_);
+  if (ctx_) SSL_CTX_free(ctx_);
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+  stop();
+  if (!WiFiClient::connect(ip, port, timeoutMs)) return 0;
+  return handshake(nullptr, timeoutMs);
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port, int32_t timeoutMs) {
+  stop();
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip) || !WiFiClient::connect(ip, port, timeoutMs)) return 0;
+  return handshake(host, timeoutMs);
+}
+
+int WiFiClientSecure::handshake(const char *host, int32_t timeoutMs) {
+  if (!ctx_) {
+    ctx_ = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_max_proto_version(ctx_, TLS1_2_VERSION); // Like BearSSL: TLS 1.2, session IDs
+    SSL_CTX_set_options(ctx_, SSL_OP_NO_TICKET);
+    SSL_CTX_set_session_cache_mode(ctx_, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    if (!ca_.empty()) {
+      BIO *bio = BIO_new_mem_buf(ca_.data(), (int)ca_.size());
+      X509 *cert;
+      while ((cert = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr)) != nullptr) {
+        X509_STORE_add_cert(SSL_CTX_get_cert_store(ctx_), cert);
+        X509_free(cert);
+      }
+      BIO_free(bio);
+      ERR_clear_error();
+    }
+  }
+  if (!insecure_ && ca_.empty()) {
+    fprintf(stderr, "[host] WiFiClientSecure: no CA certificate and not insecure\n");
+    WiFiClient::stop();
+    return 0;
+  }
+  // Non-blocking, so that available() does not wait for the next record
+  fcntl(fd(), F_SETFL, fcntl(fd(), F_GETFL) | O_NONBLOCK);
+  ssl_ = SSL_new(ctx_);
+  SSL_set_fd(ssl_, fd());
+  BIO_set_callback_ex(SSL_get_rbio(ssl_), countBytes);
+  if (host) SSL_set_tlsext_host_name(ssl_, host);
+  if (!insecure_) {
+    SSL_set_verify(ssl_, SSL_VERIFY_PEER, nullptr);
+    if (host && !X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl_), host)) SSL_set1_host(ssl_, host);
+  }
+  if (session_) SSL_set_session(ssl_, session_);
+  unsigned long start = millis();
+  unsigned long limit = timeoutMs > 0 && (unsigned long)timeoutMs < handshakeTimeout_ ? timeoutMs : handshakeTimeout_;
+  int r;
+  while ((r = SSL_connect(ssl_)) != 1) {
+    int err = SSL_get_error(ssl_, r);
+    long left = (long)(limit - (millis() - start));
+    if ((err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) || left <= 0 || !waitSocket(fd(), err, left)) {
+      fprintf(stderr, "[host] TLS handshake failed: %s\n", ERR_reason_error_string(ERR_get_error()));
+      stop();
+      return 0;
+    }
+  }
+  resumed_ = SSL_session_reused(ssl_) == 1;
+  if (!resumed_) {
+    if (session_) SSL_SESSION_free(session_);
+    session_ = SSL_get1_session(ssl_);
+  }
+  return 1;
+}
+
+/**
+ * Reads the next TLS record into rx_ without blocking. Returns true if data is buffered.
+ */
+bool WiFiClientSecure::fill() {
+  if (rxPos_ < rx_.size()) return true;
+  if (!ssl_) return false;
+  rx_.resize(16384);
+  rxPos_ = 0;
+  int n = SSL_read(ssl_, rx_.data(), (int)rx_.size());
+  rx_.resize(n > 0 ? n : 0);
+  return n > 0;
+}
+
+size_t WiFiClientSecure::write(const uint8_t *buf, size_t size) {
+  if (!ssl_) return 0;
+  size_t sent = 0;
+  while (sent < size) {
+    int n = SSL_write(ssl_, buf + sent, (int)(size - sent));
+    if (n > 0) {
+      sent += n;
+      continue;
+    }
+    int err = SSL_get_error(ssl_, n);
+    if ((err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) || !waitSocket(fd(), err, (int)timeout_)) break;
+  }
+  return sent;
+}
+
+int WiFiClientSecure::available() {
+  if (!fill()) return 0;
+  return (int)(rx_.size() - rxPos_) + SSL_pending(ssl_);
+}
+
+int WiFiClientSecure::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClientSecure::read(uint8_t *buf, size_t size) {
+  if (size == 0 || !fill()) return -1;
+  size_t n = rx_.size() - rxPos_;
+  if (n > size) n = size;
+  memcpy(buf, rx_.data() + rxPos_, n);
+  rxPos_ += n;
+  return (int)n;
+}
+
+int WiFiClientSecure::peek() {
+  return fill() ? rx_[rxPos_] : -1;
+}
+
+void WiFiClientSecure::stop() {
+  if (ssl_) {
+    SSL_shutdown(ssl_);
+    SSL_free(ssl_);
+    ssl_ = nullptr;
+  }
+  rx_.clear();
+  rxPos_ = 0;
+  WiFiClient::stop();
+}
+
+uint8_t WiFiClientSecure::connected() {
+  if (rxPos_ < rx_.size()) return 1;
+  if (!ssl_ || (SSL_get_shutdown(ssl_) & SSL_RECEIVED_SHUTDOWN)) return 0;
+  return WiFiClient::connected();
+}
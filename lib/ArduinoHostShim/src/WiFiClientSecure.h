@@ -0,0 +1,81 @@
+/**
+ * WiFiClientSecure.h
+ *
+ * Host implementation of the ESP32 WiFiClientSecure class for the native build,
+ * based on OpenSSL (link with -lssl -lcrypto). Like BearSSL on the ESP8266 it
+ * speaks TLS 1.2 without session tickets: the session (ID) of the last handshake is
+ * kept in the client and offered again on the next connect, so the server can
+ * resume it with an abbreviated handshake.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef HOST_WIFICLIENTSECURE_H
+#define HOST_WIFICLIENTSECURE_H
+
+#include <string>
+#include <vector>
+#include "WiFi.h"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_session_st SSL_SESSION;
+
+class WiFiClientSecure : public WiFiClient {
+public:
+  WiFiClientSecure() {}
+  WiFiClientSecure(const WiFiClientSecure &) = delete;
+  WiFiClientSecure &operator=(const WiFiClientSecure &) = delete;
+  ~WiFiClientSecure();
+
+  void setInsecure() { insecure_ = true; }
+  void setCACert(const char *pem) { ca_ = pem ? pem : ""; insecure_ = false; }
+  void setHandshakeTimeout(unsigned long seconds) { handshakeTimeout_ = seconds * 1000; }
+
+  using WiFiClient::connect;
+  int connect(IPAddress ip, uint16_t port, int32_t timeoutMs) override;
+  int connect(const char *host, uint16_t port, int32_t timeoutMs) override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t *buf, size_t size) override;
+  int peek() override;
+  void stop() override;
+  uint8_t connected() override;
+
+  // Host extension: true if the last handshake resumed the cached session
+  bool sessionResumed() const { return resumed_; }
+
+private:
+  int handshake(const char *host, int32_t timeoutMs);
+  bool fill();
+
+  SSL_CTX *ctx_ = nullptr;
+  SSL *ssl_ = nullptr;
+  SSL_SESSION *session_ = nullptr;
+  bool insecure_ = false;
+  bool resumed_ = false;
+  std::string ca_;
+  unsigned long handshakeTimeout_ = 10000;
+  std::vector<uint8_t> rx_;
+  size_t rxPos_ = 0;
+};
+
+#endif // HOST_WIFICLIENTSECURE_H
@@ -0,0 +1,66 @@
+/**
+ * esp_sleep.h
+ *
+ * Timer wakeup, light sleep and deep sleep of ESP-IDF for the native build.
+ * Light sleep is emulated with delay(), deep sleep terminates the program
+ * (exit code HOST_EXIT_DEEP_SLEEP).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef HOST_ESP_SLEEP_H
+#define HOST_ESP_SLEEP_H
+
+#include "Arduino.h"
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+  ESP_SLEEP_WAKEUP_TIMER = 4
+} esp_sleep_wakeup_cause_t;
+
+extern uint64_t hostSleepTimerUs;
+
+inline esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) {
+  hostSleepTimerUs = us;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_light_sleep_start() {
+  delay((unsigned long)(hostSleepTimerUs / 1000));
+  return ESP_OK;
+}
+
+inline void esp_deep_sleep(uint64_t us) {
+  ESP.deepSleep(us);
+}
+
+inline void esp_deep_sleep_start() {
+  ESP.deepSleep(hostSleepTimerUs);
+}
+
+inline esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return ESP_SLEEP_WAKEUP_UNDEFINED; // Every start of the program is a cold boot
+}
+
+#endif // HOST_ESP_SLEEP_H
@@ -0,0 +1,66 @@
+/**
+ * OTA_Arena.cpp
+ *
+ * Implementation of the scratch memory (see OTA_Arena.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Arena.h"
+#include "OTA_Platform.h"
+
+#define ALIGN 8
+
+static uint64_t arena[(OTA_ARENA_SIZE + ALIGN - 1) / ALIGN]; // uint64_t for the alignment
+static size_t used = 0;
+static uint8_t depth = 0;
+static OTAArenaStats stats = { 0, 0, 0, 0, 0 };
+
+OTAArenaScope::OTAArenaScope() : mark(used) {
+  depth++;
+}
+
+OTAArenaScope::~OTAArenaScope() {
+  used = mark;
+  if (--depth) return;
+  used = 0; // Also releases allocations made outside of any scope
+  stats.scopes++;
+  stats.maxBlock = arenaMaxFreeBlock();
+  if (stats.minMaxBlock == 0 || stats.maxBlock < stats.minMaxBlock) stats.minMaxBlock = stats.maxBlock;
+}
+
+void *arenaAlloc(size_t size) {
+  size = (size + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+  if (size > sizeof(arena) - used) {
+    stats.failures++;
+    Serial.printf("Arena: %u bytes requested, %u free\n", (unsigned)size, (unsigned)(sizeof(arena) - used));
+    return nullptr;
+  }
+  void *p = (uint8_t *)arena + used;
+  used += size;
+  if (used > stats.highWater) stats.highWater = used;
+  return p;
+}
+
+uint32_t arenaMaxFreeBlock() {
+  return OTAPlatform::maxFreeBlock();
+}
+
+const OTAArenaStats &arenaStats() {
+  return stats;
+}
@@ -0,0 +1,84 @@
+/**
+ * OTA_Arena.h
+ *
+ * Scratch memory of the OTA Template. On the ESP8266 the heap is fragmented by the
+ * many short lived Strings of web requests and update checks; after weeks of uptime
+ * HTTPUpdate can no longer get a contiguous buffer although enough memory is free.
+ * Buffers that are only needed while a request or an update check runs (status JSON,
+ * HTML chunks, manifest text) are therefore taken from a static arena instead of the
+ * heap:
+ *
+ *  - arenaAlloc() hands out memory from the arena, there is no free()
+ *  - an OTAArenaScope releases everything allocated during its lifetime; the router
+ *    (OTA_Router.h) opens one per request, otaLoop() one per update check
+ *  - at the end of the outermost scope the arena is empty again and the largest free
+ *    heap block is sampled, its minimum is reported on /ota/status
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_ARENA_H
+#define OTA_ARENA_H
+
+#include <Arduino.h>
+
+#ifndef OTA_ARENA_SIZE
+#define OTA_ARENA_SIZE 3072                // Scratch memory of a request or update check (bytes)
+#endif
+
+struct OTAArenaStats {
+  uint32_t highWater;     // Max. bytes of the arena in use at the same time
+  uint32_t failures;      // Allocations that did not fit into the arena
+  uint32_t scopes;        // Requests and update checks served
+  uint32_t maxBlock;      // Largest free heap block at the end of the last scope
+  uint32_t minMaxBlock;   // Smallest of these samples since boot
+};
+
+/**
+ * Releases all memory taken from the arena while the scope exists. Scopes may be
+ * nested, e.g. a web request served during an update check.
+ */
+class OTAArenaScope {
+public:
+  OTAArenaScope();
+  ~OTAArenaScope();
+
+private:
+  OTAArenaScope(const OTAArenaScope &);
+  OTAArenaScope &operator=(const OTAArenaScope &);
+  size_t mark;
+};
+
+/**
+ * Returns size bytes (aligned for any type) from the arena, valid until the
+ * innermost OTAArenaScope ends.
+ * @return nullptr if the arena is full
+ */
+void *arenaAlloc(size_t size);
+
+/**
+ * Returns the largest block that can be allocated from the heap.
+ */
+uint32_t arenaMaxFreeBlock();
+
+/**
+ * Returns the arena and heap statistics of the current boot.
+ */
+const OTAArenaStats &arenaStats();
+
+#endif // OTA_ARENA_H
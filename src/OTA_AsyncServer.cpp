@@ -0,0 +1,706 @@
+/**
+ * OTA_AsyncServer.cpp
+ *
+ * Implementation of the event driven web server backend (see OTA_AsyncServer.h).
+ *
+ * Each connection runs through a small state machine:
+ *   CONN_READING  - request bytes are collected in the receive buffer until the
+ *                   headers and the announced body are complete
+ *   CONN_SENDING  - the handler has been called, the queued response is written
+ *                   in pieces of at most OTA_ASYNC_TX_CHUNK bytes per call
+ * After the response the connection either returns to CONN_READING (keep-alive)
+ * or is closed. Requests are parsed in place: the URI and the arguments are
+ * zero terminated and URL decoded inside the receive buffer.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_AsyncServer.h"
+
+#define LENGTH_NOT_SET ((size_t)-2)
+#define TX_NONE 0xFF
+#define FILL_OVERHEAD 16             // Chunk header, chunk end and terminating chunk
+#define FILL_MIN 64                  // Smallest piece requested from a content filler
+// Blocks content fillers leave free, a response queued by send() always fits
+#define FILL_RESERVE ((OTA_ASYNC_TX_LIMIT + OTA_ASYNC_TX_BLOCK - 1) / OTA_ASYNC_TX_BLOCK)
+
+static_assert(OTA_ASYNC_TX_BLOCKS < TX_NONE, "OTA_ASYNC_TX_BLOCKS must be below 255");
+static_assert(OTA_ASYNC_TX_LIMIT <= 0xFFFF, "OTA_ASYNC_TX_LIMIT must fit into 16 bits");
+static_assert(OTA_ASYNC_TX_BLOCKS > FILL_RESERVE, "OTA_ASYNC_TX_BLOCKS must exceed OTA_ASYNC_TX_LIMIT / OTA_ASYNC_TX_BLOCK");
+
+static const char *statusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/**
+ * URL decodes a zero terminated string in place.
+ */
+static void urlDecode(char *s) {
+  char *out = s;
+  for (; *s; ++s) {
+    if (*s == '+') {
+      *out++ = ' ';
+    } else if (*s == '%' && hexValue(s[1]) >= 0 && hexValue(s[2]) >= 0) {
+      *out++ = (char)(hexValue(s[1]) * 16 + hexValue(s[2]));
+      s += 2;
+    } else {
+      *out++ = *s;
+    }
+  }
+  *out = '\0';
+}
+
+OTAAsyncServer::OTAAsyncServer(int port) : tcpServer((uint16_t)port), port((uint16_t)port), current(nullptr) {
+  for (uint8_t i = 0; i < OTA_ASYNC_MAX_CLIENTS; ++i) {
+    conns[i].state = CONN_FREE;
+    conns[i].txHead = TX_NONE;
+    conns[i].txTail = TX_NONE;
+    conns[i].txQueued = 0;
+  }
+  for (uint8_t i = 0; i < OTA_ASYNC_TX_BLOCKS; ++i) txBlocks[i].next = i + 1 < OTA_ASYNC_TX_BLOCKS ? i + 1 : TX_NONE;
+  txFree = 0;
+  txFreeCount = OTA_ASYNC_TX_BLOCKS;
+}
+
+void OTAAsyncServer::begin() {
+  tcpServer.begin(port);
+  tcpServer.setNoDelay(true);
+}
+
+void OTAAsyncServer::begin(uint16_t newPort) {
+  port = newPort;
+  begin();
+}
+
+void OTAAsyncServer::stop() {
+  for (uint8_t i = 0; i < OTA_ASYNC_MAX_CLIENTS; ++i) {
+    if (conns[i].state != CONN_FREE) release(conns[i], true);
+  }
+  tcpServer.stop();
+}
+
+void OTAAsyncServer::on(const String &uri, THandlerFunction handler) {
+  on(uri, HTTP_ANY, handler);
+}
+
+void OTAAsyncServer::on(const String &uri, HTTPMethod method, THandlerFunction handler) {
+  Handler h;
+  h.uri = uri;
+  h.method = method;
+  h.fn = handler;
+  handlers.push_back(h);
+}
+
+uint8_t OTAAsyncServer::connections() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < OTA_ASYNC_MAX_CLIENTS; ++i) {
+    if (conns[i].state != CONN_FREE) ++n;
+  }
+  return n;
+}
+
+/**
+ * handleClient()
+ * Performs one non-blocking step for the listening socket and every connection.
+ */
+void OTAAsyncServer::handleClient() {
+  acceptClients();
+  for (uint8_t i = 0; i < OTA_ASYNC_MAX_CLIENTS; ++i) {
+    Connection &c = conns[i];
+    if (c.state == CONN_FREE) continue;
+    if (c.state == CONN_READING) readRequest(c);
+    if (c.state == CONN_SENDING) writeResponse(c);
+    if (c.state != CONN_FREE && millis() - c.lastActivity > OTA_ASYNC_IDLE_TIMEOUT) {
+      release(c, true); // Idle keep-alive connection or stalled client
+    }
+  }
+}
+
+void OTAAsyncServer::acceptClients() {
+  for (;;) {
+    Connection *slot = nullptr;
+    Connection *idle = nullptr;
+    for (uint8_t i = 0; i < OTA_ASYNC_MAX_CLIENTS && !slot; ++i) {
+      Connection &c = conns[i];
+      if (c.state == CONN_FREE) slot = &c;
+      else if (c.idle && (!idle || c.lastActivity < idle->lastActivity)) idle = &c;
+    }
+    // All slots busy: leave new connections in the listen backlog of the TCP stack
+    if (!slot && !idle) return;
+    WiFiClient incoming = tcpServer.available();
+    if (!incoming) return;
+    if (!slot) {
+      release(*idle, true); // Make room by closing the longest idle keep-alive connection
+      slot = idle;
+    }
+    slot->client = incoming;
+    slot->client.setNoDelay(true);
+    slot->state = CONN_READING;
+    slot->idle = false;
+    slot->rxLen = 0;
+    slot->headerLen = 0;
+    slot->lastActivity = millis();
+  }
+}
+
+void OTAAsyncServer::readRequest(Connection &c) {
+  int avail = c.client.available();
+  if (avail > 0) {
+    // One byte is kept free to zero terminate the request body
+    size_t space = OTA_ASYNC_RX_BUFFER - 1 - c.rxLen;
+    if (space == 0) {
+      sendError(c, c.headerLen ? 413 : 431);
+      return;
+    }
+    int n = c.client.read((uint8_t *)c.rx + c.rxLen, (size_t)avail < space ? (size_t)avail : space);
+    if (n > 0) {
+      c.rxLen += n;
+      c.idle = false;
+      c.lastActivity = millis();
+    }
+  } else if (!c.client.connected()) {
+    release(c, true);
+    return;
+  }
+  if (c.rxLen > 0 && parseRequest(c)) dispatch(c);
+}
+
+/**
+ * Parses the request in the receive buffer.
+ * Returns true once headers and body are complete.
+ */
+bool OTAAsyncServer::parseRequest(Connection &c) {
+  if (c.headerLen == 0) {
+    c.rx[c.rxLen] = '\0';
+    char *end = strstr(c.rx, "\r\n\r\n");
+    if (!end) return false;
+    c.headerLen = (uint16_t)(end - c.rx + 4);
+
+    // Request line: METHOD SP URI SP VERSION
+    char *eol = strstr(c.rx, "\r\n");
+    char *sp1 = strchr(c.rx, ' ');
+    char *sp2 = sp1 ? strchr(sp1 + 1, ' ') : nullptr;
+    c.headerOff = (uint16_t)(eol + 2 - c.rx);
+    if (!sp1 || !sp2 || sp2 > eol) {
+      sendError(c, 400);
+      return false;
+    }
+    size_t mlen = sp1 - c.rx;
+    c.method = HTTP_ANY;
+    if (mlen == 3 && !strncmp(c.rx, "GET", 3)) c.method = HTTP_GET;
+    else if (mlen == 4 && !strncmp(c.rx, "POST", 4)) c.method = HTTP_POST;
+    else if (mlen == 4 && !strncmp(c.rx, "HEAD", 4)) c.method = HTTP_HEAD;
+    else if (mlen == 3 && !strncmp(c.rx, "PUT", 3)) c.method = HTTP_PUT;
+    else if (mlen == 5 && !strncmp(c.rx, "PATCH", 5)) c.method = HTTP_PATCH;
+    else if (mlen == 6 && !strncmp(c.rx, "DELETE", 6)) c.method = HTTP_DELETE;
+    else if (mlen == 7 && !strncmp(c.rx, "OPTIONS", 7)) c.method = HTTP_OPTIONS;
+    c.keepAlive = strncmp(sp2 + 1, "HTTP/1.0", 8) != 0;
+    c.argCount = 0;
+    c.uriOff = (uint16_t)(sp1 + 1 - c.rx);
+    *sp2 = '\0';
+
+    c.contentLength = 0;
+    const char *value = findHeader(c, "Content-Length");
+    if (value) {
+      // Plain decimal only, checked against the buffer before it is narrowed
+      char *last = (char *)value;
+      unsigned long length = isdigit((unsigned char)*value) ? strtoul(value, &last, 10) : 0;
+      while (*last == ' ' || *last == '\t') ++last;
+      if (last == value || *last != '\r') {
+        sendError(c, 400);
+        return false;
+      }
+      if (length > OTA_ASYNC_RX_BUFFER) {
+        sendError(c, 413);
+        return false;
+      }
+      c.contentLength = (uint16_t)length;
+    }
+    value = findHeader(c, "Connection");
+    if (value) {
+      if (!strncasecmp(value, "close", 5)) c.keepAlive = false;
+      else if (!strncasecmp(value, "keep-alive", 10)) c.keepAlive = true;
+    }
+    if ((size_t)c.headerLen + c.contentLength > OTA_ASYNC_RX_BUFFER - 1) {
+      sendError(c, 413);
+      return false;
+    }
+
+    char *query = strchr(c.rx + c.uriOff, '?');
+    if (query) {
+      *query = '\0';
+      parseArgs(c, (uint16_t)(query + 1 - c.rx), (uint16_t)(sp2 - query - 1));
+    }
+    urlDecode(c.rx + c.uriOff);
+  }
+
+  if (c.rxLen < c.headerLen + c.contentLength) return false;
+
+  if (c.contentLength > 0) {
+    // The body is terminated until the response is complete, the byte this replaces
+    // (start of a pipelined request) is put back by writeResponse()
+    c.pipelined = c.rx[c.headerLen + c.contentLength];
+    c.rx[c.headerLen + c.contentLength] = '\0';
+    const char *type = findHeader(c, "Content-Type");
+    if (type && !strncasecmp(type, "application/x-www-form-urlencoded", 33)) {
+      parseArgs(c, c.headerLen, c.contentLength);
+    }
+  }
+  return true;
+}
+
+/**
+ * Splits "a=1&b=2" at rx[off..off+len) into zero terminated, URL decoded arguments.
+ */
+void OTAAsyncServer::parseArgs(Connection &c, uint16_t off, uint16_t len) {
+  char *p = c.rx + off;
+  char *end = p + len;
+  *end = '\0';
+  while (p < end && c.argCount < OTA_ASYNC_MAX_ARGS) {
+    char *amp = strchr(p, '&');
+    if (amp) *amp = '\0';
+    if (*p) {
+      char *eq = strchr(p, '=');
+      c.argName[c.argCount] = (uint16_t)(p - c.rx);
+      if (eq) {
+        *eq = '\0';
+        c.argValue[c.argCount] = (uint16_t)(eq + 1 - c.rx);
+        urlDecode(eq + 1);
+      } else {
+        c.argValue[c.argCount] = (uint16_t)(p + strlen(p) - c.rx); // Empty value
+      }
+      urlDecode(p);
+      ++c.argCount;
+    }
+    if (!amp) break;
+    p = amp + 1;
+  }
+}
+
+/**
+ * Returns the value of a request header (terminated by '\r') or nullptr.
+ */
+const char *OTAAsyncServer::findHeader(const Connection &c, const char *name) const {
+  // The request line is modified in place, header lines start at headerOff
+  size_t nameLen = strlen(name);
+  const char *line = c.rx + c.headerOff;
+  const char *end = c.rx + c.headerLen;
+  while (line && line + 2 < end) {
+    if (!strncasecmp(line, name, nameLen) && line[nameLen] == ':') {
+      const char *value = line + nameLen + 1;
+      while (*value == ' ') ++value;
+      return value;
+    }
+    line = strstr(line, "\r\n");
+    if (line) line += 2;
+  }
+  return nullptr;
+}
+
+void OTAAsyncServer::dispatch(Connection &c) {
+  current = &c;
+  pendingHeaders = String();
+  clearTx(c);
+  c.chunked = false;
+  c.responded = false;
+  c.overflow = false;
+  c.contentLengthOut = LENGTH_NOT_SET;
+
+  const char *path = c.rx + c.uriOff;
+  bool handled = false;
+  for (size_t i = 0; i < handlers.size(); ++i) {
+    if ((handlers[i].method == HTTP_ANY || handlers[i].method == c.method) && handlers[i].uri == path) {
+      handlers[i].fn();
+      handled = true;
+      break;
+    }
+  }
+  if (!handled) {
+    if (notFoundHandler) notFoundHandler();
+    else send(404, "text/plain", "Not Found");
+  }
+  if (c.chunked && !c.filler && c.method != HTTP_HEAD) queue("0\r\n\r\n", 5);
+  current = nullptr;
+
+  if (c.overflow) {
+    Serial.printf("Web server: response to %s exceeds the transmit queue, use sendContentFiller()\n", path);
+    sendError(c, 500);
+    writeResponse(c);
+    return;
+  }
+  if (!c.responded && c.txQueued == 0) {
+    // The handler wrote to client() directly or kept it (e.g. event streams)
+    release(c, false);
+    return;
+  }
+  c.state = CONN_SENDING;
+  c.lastActivity = millis();
+  writeResponse(c);
+}
+
+void OTAAsyncServer::writeResponse(Connection &c) {
+  fill(c);
+  size_t budget = OTA_ASYNC_TX_CHUNK;
+  while (c.txQueued && budget) {
+    uint16_t end = c.txHead == c.txTail ? c.txEnd : OTA_ASYNC_TX_BLOCK;
+    size_t n = end - c.txStart;
+    if (n > budget) n = budget;
+    // Never blocks: only what fits into the TCP send buffer is taken
+    size_t written = OTAPlatform::tcpWrite(c.client, (const uint8_t *)txBlocks[c.txHead].data + c.txStart, n);
+    if (written == 0) {
+      if (!c.client.connected()) release(c, true);
+      return;
+    }
+    c.lastActivity = millis();
+    c.txStart += written;
+    c.txQueued -= written;
+    budget -= written;
+    if (c.txStart == end) {
+      uint8_t next = txBlocks[c.txHead].next;
+      txBlocks[c.txHead].next = txFree;
+      txFree = c.txHead;
+      txFreeCount++;
+      c.txHead = next;
+      c.txStart = 0;
+      if (c.txHead == TX_NONE) {
+        c.txTail = TX_NONE;
+        c.txEnd = 0;
+      }
+    }
+    if (written < n) return; // Send buffer full, the rest follows in the next call
+    fill(c);
+  }
+  if (c.txQueued || c.filler) return;
+
+  // Response complete
+  if (!c.keepAlive) {
+    release(c, true);
+    return;
+  }
+  // Keep-alive: keep bytes of a pipelined follow-up request
+  uint16_t consumed = c.headerLen + c.contentLength;
+  uint16_t rest = c.rxLen > consumed ? c.rxLen - consumed : 0;
+  if (rest) {
+    memmove(c.rx, c.rx + consumed, rest);
+    if (c.contentLength) c.rx[0] = c.pipelined;
+  }
+  c.rxLen = rest;
+  c.headerLen = 0;
+  c.idle = rest == 0;
+  c.state = CONN_READING;
+}
+
+/**
+ * Takes the next pieces of the body from the content filler while the transmit
+ * queue of the connection has room. Fillers share the blocks above FILL_RESERVE.
+ */
+void OTAAsyncServer::fill(Connection &c) {
+  bool chunked = c.fillLength == CONTENT_LENGTH_UNKNOWN;
+  while (c.filler) {
+    size_t room = txRoom(c);
+    size_t shared = txFreeCount > FILL_RESERVE ? (size_t)(txFreeCount - FILL_RESERVE) * OTA_ASYNC_TX_BLOCK : 0;
+    if (c.txTail != TX_NONE) shared += OTA_ASYNC_TX_BLOCK - c.txEnd;
+    if (shared < room) room = shared;
+    if (room < FILL_OVERHEAD + FILL_MIN) return; // Wait until queued data is sent
+    char buf[OTA_ASYNC_TX_BLOCK];
+    size_t max = room - FILL_OVERHEAD < sizeof(buf) ? room - FILL_OVERHEAD : sizeof(buf);
+    if (!chunked && c.fillLength - c.fillOffset < max) max = c.fillLength - c.fillOffset;
+    size_t n = max ? c.filler(buf, max, c.fillOffset) : 0;
+    if (n > max) n = max;
+    if (n == 0) {
+      if (chunked) append(c, "0\r\n\r\n", 5);
+      else if (c.fillOffset < c.fillLength) c.keepAlive = false; // Body incomplete, the client sees the close
+      c.filler = nullptr;
+      return;
+    }
+    if (chunked) {
+      char head[8];
+      int len = snprintf(head, sizeof(head), "%x\r\n", (unsigned)n);
+      append(c, head, len);
+      append(c, buf, n);
+      append(c, "\r\n", 2);
+    } else {
+      append(c, buf, n);
+    }
+    c.fillOffset += n;
+    if (!chunked && c.fillOffset == c.fillLength) c.filler = nullptr;
+  }
+}
+
+void OTAAsyncServer::release(Connection &c, bool close) {
+  if (close) c.client.stop();
+  c.client = WiFiClient();
+  clearTx(c);
+  c.state = CONN_FREE;
+}
+
+void OTAAsyncServer::sendError(Connection &c, int code) {
+  c.keepAlive = false;
+  current = &c;
+  clearTx(c);
+  c.chunked = false;
+  c.overflow = false;
+  c.contentLengthOut = LENGTH_NOT_SET;
+  pendingHeaders = String();
+  send(code, "text/plain", statusText(code));
+  current = nullptr;
+  c.state = CONN_SENDING;
+  c.lastActivity = millis();
+}
+
+/**
+ * Appends response data to the current connection. Data that does not fit into the
+ * transmit queue marks the response as overflowed, dispatch() replaces it by an error.
+ */
+void OTAAsyncServer::queue(const char *data, size_t len) {
+  if (!current) return;
+  if (!append(*current, data, len)) current->overflow = true;
+}
+
+/**
+ * Copies data into the transmit blocks of the connection.
+ * Returns false if the connection limit or the block pool is exhausted.
+ */
+bool OTAAsyncServer::append(Connection &c, const char *data, size_t len) {
+  if (c.overflow || len > txRoom(c)) return false;
+  while (len > 0) {
+    if (c.txTail == TX_NONE || c.txEnd == OTA_ASYNC_TX_BLOCK) {
+      uint8_t b = txFree;
+      txFree = txBlocks[b].next;
+      txFreeCount--;
+      txBlocks[b].next = TX_NONE;
+      if (c.txTail == TX_NONE) {
+        c.txHead = b;
+        c.txStart = 0;
+      } else {
+        txBlocks[c.txTail].next = b;
+      }
+      c.txTail = b;
+      c.txEnd = 0;
+    }
+    size_t n = OTA_ASYNC_TX_BLOCK - c.txEnd;
+    if (n > len) n = len;
+    memcpy(txBlocks[c.txTail].data + c.txEnd, data, n);
+    c.txEnd += n;
+    c.txQueued += n;
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+/**
+ * Returns the number of bytes that can still be queued for the connection.
+ */
+size_t OTAAsyncServer::txRoom(const Connection &c) const {
+  size_t pool = (size_t)txFreeCount * OTA_ASYNC_TX_BLOCK;
+  if (c.txTail != TX_NONE) pool += OTA_ASYNC_TX_BLOCK - c.txEnd;
+  size_t limit = OTA_ASYNC_TX_LIMIT - c.txQueued;
+  return pool < limit ? pool : limit;
+}
+
+/**
+ * Returns the transmit blocks of the connection to the pool.
+ */
+void OTAAsyncServer::clearTx(Connection &c) {
+  while (c.txHead != TX_NONE) {
+    uint8_t next = txBlocks[c.txHead].next;
+    txBlocks[c.txHead].next = txFree;
+    txFree = c.txHead;
+    txFreeCount++;
+    c.txHead = next;
+  }
+  c.txTail = TX_NONE;
+  c.txStart = 0;
+  c.txEnd = 0;
+  c.txQueued = 0;
+  c.filler = nullptr;
+}
+
+String OTAAsyncServer::uri() const {
+  return current ? String(current->rx + current->uriOff) : String();
+}
+
+HTTPMethod OTAAsyncServer::method() const {
+  return current ? current->method : HTTP_ANY;
+}
+
+WiFiClient &OTAAsyncServer::client() {
+  static WiFiClient none;
+  return current ? current->client : none;
+}
+
+String OTAAsyncServer::arg(const String &name) const {
+  if (!current) return String();
+  for (uint8_t i = 0; i < current->argCount; ++i) {
+    if (name == current->rx + current->argName[i]) return String(current->rx + current->argValue[i]);
+  }
+  return String();
+}
+
+String OTAAsyncServer::arg(int i) const {
+  if (!current || i < 0 || i >= current->argCount) return String();
+  return String(current->rx + current->argValue[i]);
+}
+
+String OTAAsyncServer::argName(int i) const {
+  if (!current || i < 0 || i >= current->argCount) return String();
+  return String(current->rx + current->argName[i]);
+}
+
+const char *OTAAsyncServer::argValue(const char *name) const {
+  if (!current) return nullptr;
+  for (uint8_t i = 0; i < current->argCount; ++i) {
+    if (strcmp(name, current->rx + current->argName[i]) == 0) return current->rx + current->argValue[i];
+  }
+  return nullptr;
+}
+
+int OTAAsyncServer::args() const {
+  return current ? current->argCount : 0;
+}
+
+bool OTAAsyncServer::hasArg(const String &name) const {
+  if (!current) return false;
+  for (uint8_t i = 0; i < current->argCount; ++i) {
+    if (name == current->rx + current->argName[i]) return true;
+  }
+  return false;
+}
+
+String OTAAsyncServer::header(const String &name) const {
+  if (!current) return String();
+  const char *value = findHeader(*current, name.c_str());
+  if (!value) return String();
+  // Header values end at '\r', terminate temporarily to build the String
+  char *end = const_cast<char *>(strchr(value, '\r'));
+  if (!end) return String();
+  *end = '\0';
+  String result(value);
+  *end = '\r';
+  return result;
+}
+
+bool OTAAsyncServer::hasHeader(const String &name) const {
+  return current && findHeader(*current, name.c_str()) != nullptr;
+}
+
+void OTAAsyncServer::send(int code, const char *contentType, const String &content) {
+  if (!current) return;
+  Connection &c = *current;
+  c.responded = true;
+  char head[160];
+  int n = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\n", code, statusText(code));
+  queue(head, n);
+  if (contentType && *contentType) {
+    n = snprintf(head, sizeof(head), "Content-Type: %s\r\n", contentType);
+    queue(head, n);
+  }
+  if (c.contentLengthOut == CONTENT_LENGTH_UNKNOWN) {
+    c.chunked = true;
+    queue("Transfer-Encoding: chunked\r\n", 28);
+  } else {
+    size_t len = c.contentLengthOut == LENGTH_NOT_SET ? content.length() : c.contentLengthOut;
+    n = snprintf(head, sizeof(head), "Content-Length: %u\r\n", (unsigned)len);
+    queue(head, n);
+  }
+  if (pendingHeaders.length()) {
+    queue(pendingHeaders.c_str(), pendingHeaders.length());
+    pendingHeaders = String();
+  }
+  if (c.keepAlive) queue("Connection: keep-alive\r\n\r\n", 26);
+  else queue("Connection: close\r\n\r\n", 21);
+  if (c.method != HTTP_HEAD && content.length()) sendContent(content);
+}
+
+void OTAAsyncServer::send(int code, const String &contentType, const String &content) {
+  send(code, contentType.c_str(), content);
+}
+
+void OTAAsyncServer::send(int code, const char *contentType, const char *content) {
+  send(code, contentType, String(content));
+}
+
+void OTAAsyncServer::send_P(int code, const char *contentType, const char *content) {
+  send(code, contentType, String(FPSTR(content)));
+}
+
+void OTAAsyncServer::sendHeader(const String &name, const String &value, bool first) {
+  String line = name + ": " + value + "\r\n";
+  if (first) pendingHeaders = line + pendingHeaders;
+  else pendingHeaders += line;
+}
+
+void OTAAsyncServer::setContentLength(size_t length) {
+  if (current) current->contentLengthOut = length;
+}
+
+void OTAAsyncServer::sendContent(const String &content) {
+  sendContent(content.c_str(), content.length());
+}
+
+void OTAAsyncServer::sendContent(const char *content, size_t size) {
+  if (!current || current->method == HTTP_HEAD) return;
+  if (current->chunked) {
+    if (size == 0) return; // The terminating chunk is added after the handler
+    char len[12];
+    int n = snprintf(len, sizeof(len), "%x\r\n", (unsigned)size);
+    queue(len, n);
+    queue(content, size);
+    queue("\r\n", 2);
+  } else {
+    queue(content, size);
+  }
+}
+
+void OTAAsyncServer::sendContent_P(const char *content) {
+  sendContent(String(FPSTR(content)));
+}
+
+void OTAAsyncServer::sendContentFiller(int code, const char *contentType, size_t length, TContentFiller filler) {
+  if (!current) return;
+  Connection &c = *current;
+  c.contentLengthOut = length;
+  send(code, contentType, String());
+  if (c.method == HTTP_HEAD || length == 0) return;
+  c.filler = filler;
+  c.fillOffset = 0;
+  c.fillLength = length;
+}
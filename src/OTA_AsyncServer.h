@@ -0,0 +1,198 @@
+/**
+ * OTA_AsyncServer.h
+ *
+ * Event driven web server backend for the configuration interface.
+ * OTAAsyncServer serves several (keep-alive) connections concurrently: every
+ * call of handleClient() accepts new connections, reads whatever request data
+ * has arrived and writes the next part of pending responses, but never waits
+ * for a client. The main loop therefore keeps running while pages are sent.
+ *
+ * The class implements the subset of the ESP8266WebServer/WebServer API used
+ * by the OTA Template and typical user handlers (on(), send(), arg(), uri(), ...),
+ * so startWebServer(), registerCustomEndpoint() and existing handlers work
+ * unchanged. It is selected instead of the synchronous server by defining
+ * OTA_ASYNC_WEBSERVER in the build_flags of an environment (see platformio.ini).
+ *
+ * Memory is bounded and static: requests are parsed in place in a fixed receive
+ * buffer per connection (OTA_ASYNC_RX_BUFFER); pending response data is queued in
+ * blocks of a pool shared by all connections (OTA_ASYNC_TX_BLOCKS), at most
+ * OTA_ASYNC_TX_LIMIT bytes per connection. Sockets are only written as far as the
+ * TCP send buffer takes the data (OTAPlatform::tcpWrite()), the unsent rest stays
+ * queued. Larger responses (e.g. a firmware image) are produced piece by piece by
+ * a content filler (sendContentFiller()) whenever the queue has room again.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_ASYNCSERVER_H
+#define OTA_ASYNCSERVER_H
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+// The synchronous server headers provide HTTPMethod and CONTENT_LENGTH_UNKNOWN
+#include "OTA_Platform.h"
+
+#ifndef OTA_ASYNC_MAX_CLIENTS
+#define OTA_ASYNC_MAX_CLIENTS 4         // Max. number of concurrent connections
+#endif
+#ifndef OTA_ASYNC_RX_BUFFER
+#define OTA_ASYNC_RX_BUFFER 1024        // Receive buffer per connection (request line, headers and body)
+#endif
+#ifndef OTA_ASYNC_TX_BLOCK
+#define OTA_ASYNC_TX_BLOCK 256          // Size of a transmit block
+#endif
+#ifndef OTA_ASYNC_TX_BLOCKS
+#define OTA_ASYNC_TX_BLOCKS 20          // Transmit blocks shared by all connections
+#endif
+#ifndef OTA_ASYNC_TX_LIMIT
+#define OTA_ASYNC_TX_LIMIT 3072         // Max. pending response bytes per connection
+#endif
+#ifndef OTA_ASYNC_TX_CHUNK
+#define OTA_ASYNC_TX_CHUNK 1024         // Max. bytes written per connection and handleClient() call
+#endif
+#ifndef OTA_ASYNC_MAX_ARGS
+#define OTA_ASYNC_MAX_ARGS 16           // Max. number of query/form arguments per request
+#endif
+#ifndef OTA_ASYNC_IDLE_TIMEOUT
+#define OTA_ASYNC_IDLE_TIMEOUT 5000     // Keep-alive / request timeout in milliseconds
+#endif
+
+class OTAAsyncServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+  // Writes the body bytes from offset on into buf (at most size, at least 64 unless fewer
+  // are left) and returns their number; 0 ends a response of unknown length
+  typedef std::function<size_t(char *buf, size_t size, size_t offset)> TContentFiller;
+
+  explicit OTAAsyncServer(int port = 80);
+
+  void begin();
+  void begin(uint16_t port);
+  void stop();
+  void close() { stop(); }
+  void handleClient();
+
+  void on(const String &uri, THandlerFunction handler);
+  void on(const String &uri, HTTPMethod method, THandlerFunction handler);
+  void onNotFound(THandlerFunction handler) { notFoundHandler = handler; }
+
+  // Request of the handler currently running
+  String uri() const;
+  HTTPMethod method() const;
+  WiFiClient &client();
+  String arg(const String &name) const;
+  String arg(int i) const;
+  String argName(int i) const;
+  const char *argValue(const char *name) const; // In the request buffer, nullptr if missing
+  int args() const;
+  bool hasArg(const String &name) const;
+  String header(const String &name) const;
+  bool hasHeader(const String &name) const;
+
+  // Response of the handler currently running (queued, sent by handleClient())
+  void send(int code, const char *contentType = nullptr, const String &content = String());
+  void send(int code, const String &contentType, const String &content);
+  void send(int code, const char *contentType, const char *content);
+  void send_P(int code, const char *contentType, const char *content);
+  void sendHeader(const String &name, const String &value, bool first = false);
+  void setContentLength(size_t length);
+  void sendContent(const String &content);
+  void sendContent(const char *content, size_t size);
+  void sendContent_P(const char *content);
+  // Sends the headers, the body of length bytes (CONTENT_LENGTH_UNKNOWN: chunked) is
+  // taken from filler while the response is written
+  void sendContentFiller(int code, const char *contentType, size_t length, TContentFiller filler);
+
+  // Number of currently open connections
+  uint8_t connections() const;
+
+private:
+  enum ConnState : uint8_t { CONN_FREE, CONN_READING, CONN_SENDING };
+
+  struct Connection {
+    WiFiClient client;
+    ConnState state;
+    bool keepAlive;
+    bool idle;                       // Waiting for the next request of a keep-alive connection
+    bool chunked;                    // Response uses chunked transfer encoding
+    bool responded;                  // Handler called send()
+    bool overflow;                   // Response did not fit into the transmit queue
+    HTTPMethod method;
+    uint16_t rxLen;                  // Bytes in rx
+    uint16_t headerLen;              // Length of request line + headers, 0 while incomplete
+    uint16_t headerOff;              // Start of the first header line
+    uint16_t contentLength;          // Length of the request body
+    char pipelined;                  // First byte after the body, replaced by the terminator of the last argument
+    uint16_t uriOff;                 // Request URI (zero terminated in rx)
+    uint8_t argCount;
+    uint16_t argName[OTA_ASYNC_MAX_ARGS];
+    uint16_t argValue[OTA_ASYNC_MAX_ARGS];
+    unsigned long lastActivity;
+    uint8_t txHead;                  // First block of the pending response data, TX_NONE if empty
+    uint8_t txTail;                  // Last block
+    uint16_t txStart;                // First unsent byte in txHead
+    uint16_t txEnd;                  // Bytes used in txTail
+    uint16_t txQueued;               // Pending bytes
+    size_t contentLengthOut;         // Content length set by setContentLength()
+    TContentFiller filler;           // Produces the rest of the body, empty when done
+    size_t fillOffset;               // Body bytes taken from the filler
+    size_t fillLength;               // Body length of the filler, CONTENT_LENGTH_UNKNOWN: chunked
+    char rx[OTA_ASYNC_RX_BUFFER];
+  };
+
+  struct TxBlock {
+    uint8_t next;
+    char data[OTA_ASYNC_TX_BLOCK];
+  };
+
+  struct Handler {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction fn;
+  };
+
+  void acceptClients();
+  void readRequest(Connection &c);
+  bool parseRequest(Connection &c);
+  void parseArgs(Connection &c, uint16_t off, uint16_t len);
+  void dispatch(Connection &c);
+  void writeResponse(Connection &c);
+  void fill(Connection &c);
+  void release(Connection &c, bool close);
+  void sendError(Connection &c, int code);
+  void queue(const char *data, size_t len);
+  bool append(Connection &c, const char *data, size_t len);
+  size_t txRoom(const Connection &c) const;
+  void clearTx(Connection &c);
+  const char *findHeader(const Connection &c, const char *name) const;
+
+  WiFiServer tcpServer;
+  uint16_t port;
+  Connection conns[OTA_ASYNC_MAX_CLIENTS];
+  TxBlock txBlocks[OTA_ASYNC_TX_BLOCKS];
+  uint8_t txFree;                    // First free transmit block
+  uint8_t txFreeCount;
+  Connection *current;               // Connection of the running handler
+  String pendingHeaders;             // Headers added by sendHeader() before send()
+  std::vector<Handler> handlers;
+  THandlerFunction notFoundHandler;
+};
+
+#endif // OTA_ASYNCSERVER_H
@@ -0,0 +1,163 @@
+/**
+ * OTA_Client.cpp
+ *
+ * Implementation of the shared OTA server connection (see OTA_Client.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Client.h"
+#include "OTA_Mirror.h"
+#include "OTA_Dns.h"
+
+#if OTA_HTTPS
+  #include <WiFiClientSecure.h>
+#endif
+
+static OTAClientStats stats = { 0, 0, 0, 0, 0 };
+
+#if !OTA_HTTPS
+static WiFiClient client;
+#elif defined(ESP8266)
+static BearSSL::WiFiClientSecure client;
+static BearSSL::Session session;     // Session of the last full handshake, offered on the next connect
+static bool configured = false;
+#else
+static WiFiClientSecure client;
+static bool configured = false;
+#endif
+
+#if OTA_HTTPS
+
+/**
+ * Sets trust anchor, session cache and buffer sizes before the first handshake.
+ */
+static void configure() {
+#if defined(ESP8266)
+  #ifdef OTA_TLS_CA_CERT
+  static BearSSL::X509List ca(OTA_TLS_CA_CERT);
+  client.setTrustAnchors(&ca);
+  #else
+  client.setInsecure();
+  #endif
+  client.setSession(&session);
+  // Small receive buffers need the max. fragment length extension of the server
+  const OTAMirror &target = mirrorCurrent();
+  bool mfl = client.probeMaxFragmentLength(target.host, target.port, OTA_TLS_RX_BUFFER);
+  client.setBufferSizes(mfl ? OTA_TLS_RX_BUFFER : 16384, OTA_TLS_TX_BUFFER);
+  Serial.printf("TLS: receive buffer %d bytes\n", mfl ? OTA_TLS_RX_BUFFER : 16384);
+#elif defined(ESP32)
+  #ifdef OTA_TLS_CA_CERT
+  client.setCACert(OTA_TLS_CA_CERT);
+  #else
+  client.setInsecure();
+  #endif
+#endif
+#ifndef OTA_TLS_CA_CERT
+  Serial.println("TLS: OTA_TLS_CA_CERT not set, server certificate not checked.");
+#endif
+  configured = true;
+}
+
+#endif // OTA_HTTPS
+
+/**
+ * Opens the connection to the selected OTA server (OTA_Mirror.h) and records the
+ * handshake time.
+ */
+static bool connect() {
+  const OTAMirror &target = mirrorCurrent();
+#if OTA_HTTPS
+  if (!configured) configure();
+#endif
+#if OTA_HTTPS && defined(ESP8266)
+  static const BearSSL::Session none;
+  BearSSL::Session before = session; // Unchanged after the handshake: the session was resumed
+  bool offered = memcmp(&before, &none, sizeof(before)) != 0;
+#endif
+  unsigned long start = millis();
+#if OTA_HTTPS
+  bool ok = client.connect(target.host, target.port); // By name for SNI and the certificate check
+#else
+  IPAddress ip;
+  bool ok = dnsResolve(target.host, ip) && client.connect(ip, target.port);
+#endif
+  if (!ok) {
+    Serial.printf("Client: connection to %s:%d failed\n", target.host, target.port);
+    return false;
+  }
+  stats.handshakeMs = millis() - start;
+  stats.connects++;
+  mirrorConnected();
+#if OTA_HTTPS
+  #if defined(OTA_NATIVE)
+  bool resumed = client.sessionResumed();
+  #elif defined(ESP8266)
+  bool resumed = offered && memcmp(&before, &session, sizeof(before)) == 0;
+  #else
+  bool resumed = false;
+  #endif
+  if (resumed) {
+    stats.resumed++;
+  } else {
+    stats.fullMs = stats.handshakeMs;
+  }
+  Serial.printf("TLS: %s handshake in %lu ms\n", resumed ? "resumed" : "full", (unsigned long)stats.handshakeMs);
+#endif
+  return true;
+}
+
+bool clientBegin(HTTPClient &http, const char *url) {
+  if (client.connected()) {
+    stats.reused++;
+  } else if (!connect()) {
+    return false;
+  }
+  http.setReuse(true);
+  return http.begin(client, url);
+}
+
+int clientReadBody(HTTPClient &http, char *buf, size_t size) {
+  int len = http.getSize();
+  if (len < 0) {
+    // Chunked or without length: only getString() decodes it, the OTA server sends a length
+    String body = http.getString();
+    len = body.length();
+    if ((size_t)len >= size) return -1;
+    memcpy(buf, body.c_str(), len);
+  } else if ((size_t)len >= size) {
+    clientEnd(); // The unread body must not stay on the reused connection
+    return -1;
+  } else {
+    len = http.getStreamPtr()->readBytes(buf, len);
+  }
+  while (len > 0 && isspace((unsigned char)buf[len - 1])) len--;
+  buf[len] = '\0';
+  size_t start = 0;
+  while (isspace((unsigned char)buf[start])) start++;
+  if (start) memmove(buf, buf + start, len - start + 1);
+  return len - start;
+}
+
+void clientEnd() {
+  client.stop();
+}
+
+const OTAClientStats &clientStats() {
+  return stats;
+}
@@ -0,0 +1,106 @@
+/**
+ * OTA_Client.h
+ *
+ * Connection to the OTA server for the OTA Template. All requests of an update check
+ * (version, manifest, image, multicast repairs) use one client and, with HTTP
+ * keep-alive, one connection; it is closed at the end of the check.
+ *
+ * With OTA_HTTPS the client is a WiFiClientSecure. A full TLS handshake costs seconds
+ * of CPU time on the ESP8266 and ESP32-C3, so the session of the last handshake is kept
+ * in RAM and offered again on the next check; the server resumes it with an abbreviated
+ * handshake (no certificate, no key exchange). Handshake times and resumptions are
+ * reported on /ota/status.
+ *
+ *  - ESP8266 (BearSSL): session resumption by session ID, TLS buffers set by
+ *    OTA_TLS_RX_BUFFER/OTA_TLS_TX_BUFFER (the server must support the max. fragment
+ *    length extension for a receive buffer below 16 kB, otherwise 16 kB are used)
+ *  - ESP32 (mbedTLS): connection reuse only, the Arduino core has no session API and
+ *    the buffer sizes are fixed by the sdkconfig of the core
+ *  - Native build: OpenSSL with session IDs, as on the ESP8266
+ *
+ * The server certificate is checked against OTA_TLS_CA_CERT (PEM). Without it the
+ * connection is encrypted but not authenticated; images are still checked against
+ * the signed manifest (OTA_Verify.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_CLIENT_H
+#define OTA_CLIENT_H
+
+#include <Arduino.h>
+
+#if defined(ESP8266)
+  #include <ESP8266WiFi.h>
+  #include <ESP8266HTTPClient.h>
+#elif defined(ESP32)
+  #include <WiFi.h>
+  #include <HTTPClient.h>
+#endif
+
+#ifndef OTA_HTTPS
+#define OTA_HTTPS 0                        // 1: OTA server requests over HTTPS (otaPort is the TLS port)
+#endif
+#ifndef OTA_TLS_RX_BUFFER
+#define OTA_TLS_RX_BUFFER 4096             // ESP8266: TLS receive buffer (512 .. 16384 bytes)
+#endif
+#ifndef OTA_TLS_TX_BUFFER
+#define OTA_TLS_TX_BUFFER 512              // ESP8266: TLS send buffer (bytes)
+#endif
+// OTA_TLS_CA_CERT: PEM of the CA that signed the server certificate (optional)
+
+#if OTA_HTTPS
+#define OTA_SCHEME "https"
+#else
+#define OTA_SCHEME "http"
+#endif
+
+struct OTAClientStats {
+  uint32_t connects;      // Connections to the OTA server
+  uint32_t reused;        // Requests on an open connection
+  uint32_t resumed;       // TLS handshakes that resumed the cached session
+  uint32_t handshakeMs;   // Duration of the last connect incl. TLS handshake
+  uint32_t fullMs;        // Duration of the last full TLS handshake
+};
+
+/**
+ * Starts a request to the OTA server on the shared connection; connects (and times
+ * the handshake) if it is not open.
+ * @return false if the server is not reachable or the URL is invalid
+ */
+bool clientBegin(HTTPClient &http, const char *url);
+
+/**
+ * Reads the body of the response into buf as string, without the heap copy of
+ * http.getString(). White space at both ends is removed.
+ * @return length of the string, -1 if the body does not fit into buf
+ */
+int clientReadBody(HTTPClient &http, char *buf, size_t size);
+
+/**
+ * Closes the connection at the end of an update check. The TLS session stays cached
+ * and the TLS buffers are released.
+ */
+void clientEnd();
+
+/**
+ * Returns the connection statistics of the current boot.
+ */
+const OTAClientStats &clientStats();
+
+#endif // OTA_CLIENT_H
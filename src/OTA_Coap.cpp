@@ -0,0 +1,193 @@
+/**
+ * OTA_Coap.cpp
+ *
+ * Implementation of the CoAP version check (see OTA_Coap.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Coap.h"
+#include "OTA_Template.h"
+
+static OTACoapStats stats = { 0, 0, 0, 0 };
+
+#if OTA_COAP
+
+#include <WiFiUdp.h>
+
+#define COAP_CON 0
+#define COAP_NON 1
+#define COAP_ACK 2
+#define COAP_RST 3
+#define COAP_GET 0x01
+#define COAP_URI_PATH 11
+#define MAX_MESSAGE 128
+
+static unsigned long skipSince = 0;
+static bool skipping = false;
+static uint16_t messageId = 0;
+
+/**
+ * Appends a Uri-Path option (delta from the previous option number) to msg.
+ */
+static size_t putOption(uint8_t *msg, size_t pos, uint8_t delta, const char *value, size_t len) {
+  if (pos + len + 3 > MAX_MESSAGE || len > 268) return 0;
+  uint8_t *head = msg + pos++;
+  *head = delta << 4;
+  if (len < 13) {
+    *head |= len;
+  } else {
+    *head |= 13;
+    msg[pos++] = len - 13;
+  }
+  memcpy(msg + pos, value, len);
+  return pos + len;
+}
+
+/**
+ * Builds a confirmable GET of path ("a/b") with the given message ID and token.
+ */
+static size_t buildRequest(uint8_t *msg, const char *path, uint16_t id, uint32_t token) {
+  msg[0] = 0x40 | COAP_CON << 4 | 4; // Version 1, token length 4
+  msg[1] = COAP_GET;
+  msg[2] = id >> 8;
+  msg[3] = id & 0xFF;
+  memcpy(msg + 4, &token, 4);
+  size_t pos = 8;
+  uint8_t delta = COAP_URI_PATH;
+  while (*path && pos) {
+    const char *slash = strchr(path, '/');
+    size_t len = slash ? (size_t)(slash - path) : strlen(path);
+    pos = putOption(msg, pos, delta, path, len);
+    delta = 0;                       // Further Uri-Path options repeat the number
+    path += slash ? len + 1 : len;
+  }
+  return pos;
+}
+
+/**
+ * Returns the offset of the payload of a response of len bytes, len if it has none.
+ */
+static size_t payloadOffset(const uint8_t *msg, size_t len) {
+  size_t pos = 4 + (msg[0] & 0x0F);
+  while (pos < len && msg[pos] != 0xFF) {
+    uint8_t delta = msg[pos] >> 4;
+    size_t optLen = msg[pos] & 0x0F;
+    pos++;
+    if (delta == 13) pos++;
+    if (delta == 14) pos += 2;
+    if (optLen == 13) {
+      optLen = pos < len ? msg[pos] + 13 : 0;
+      pos++;
+    } else if (optLen == 14) {
+      optLen = pos + 1 < len ? ((size_t)msg[pos] << 8 | msg[pos + 1]) + 269 : 0;
+      pos += 2;
+    }
+    if (delta == 15 || optLen == 15) return len;
+    pos += optLen;
+  }
+  return pos < len ? pos + 1 : len;
+}
+
+int coapCheckVersion(char *version, size_t size) {
+  if (skipping && millis() - skipSince < OTA_COAP_RETRY_AFTER) return 0;
+  skipping = false;
+  IPAddress server;
+  if (!dnsResolve(mirrorCurrent().host, server)) return 0;
+  char path[48];
+  int n = snprintf(path, sizeof(path), "version/%s.version", config.firmware_vers);
+  if (n <= 0 || (size_t)n >= sizeof(path)) return 0;
+  uint8_t msg[MAX_MESSAGE];
+  if (!messageId) messageId = (uint16_t)random(1, 65536);
+  uint16_t id = messageId++;
+  uint32_t token = (uint32_t)random(0x7FFFFFFF);
+  size_t length = buildRequest(msg, path, id, token);
+  if (!length) return 0;
+
+  WiFiUDP udp;
+  if (!udp.begin(49152 + random(16384))) return 0;
+  stats.requests++;
+  unsigned long start = millis();
+  unsigned long timeout = OTA_COAP_TIMEOUT + random(OTA_COAP_TIMEOUT / 2 + 1);
+  int code = 0;
+  int attempt = 0;
+  bool answered = false;
+  for (; attempt <= OTA_COAP_RETRIES && !answered; ++attempt) {
+    if (attempt) stats.retransmits++;
+    udp.beginPacket(server, OTA_COAP_PORT);
+    udp.write(msg, length);
+    udp.endPacket();
+    unsigned long sent = millis();
+    while (millis() - sent < timeout && !answered) {
+      if (udp.parsePacket() <= 0) {
+        delay(2);
+        continue;
+      }
+      uint8_t answer[MAX_MESSAGE];
+      size_t len = udp.read(answer, sizeof(answer));
+      uint8_t type = answer[0] >> 4 & 0x03;
+      if (len < 4 || answer[0] >> 6 != 1 || ((uint16_t)answer[2] << 8 | answer[3]) != id) continue;
+      if (type == COAP_RST) {
+        answered = true;             // Server knows no CoAP
+      } else if (type == COAP_ACK && answer[1] != 0 && len >= 8 && (answer[0] & 0x0F) == 4 &&
+                 memcmp(answer + 4, &token, 4) == 0) {
+        uint8_t cls = answer[1] >> 5;
+        uint8_t detail = answer[1] & 0x1F;
+        size_t at = payloadOffset(answer, len);
+        size_t payload = len - at;
+        while (payload && isspace(answer[at + payload - 1])) payload--; // Version file ends with a newline
+        answered = true;
+        if (cls == 5) {
+          // Server error, the HTTP request may still succeed
+          Serial.printf("CoAP: server error %u.%02u\n", cls, detail);
+        } else if (cls == 2 && payload >= size) {
+          Serial.println("CoAP: version too long.");
+        } else {
+          code = cls == 2 ? HTTP_CODE_OK : cls * 100 + detail;
+          if (cls != 2) payload = 0;
+          memcpy(version, answer + at, payload);
+          version[payload] = '\0';
+        }
+      }
+    }
+    timeout *= 2;
+  }
+  udp.stop();
+  if (!code) {
+    Serial.println("CoAP: no answer, version checked by HTTP.");
+    stats.fallbacks++;
+    skipping = true;
+    skipSince = millis();
+    return 0;
+  }
+  stats.rttMs = millis() - start;
+  Serial.printf("CoAP: code %d in %lu ms, %d request(s)\n", code, (unsigned long)stats.rttMs, attempt);
+  return code;
+}
+
+#else
+
+int coapCheckVersion(char *, size_t) {
+  return 0;
+}
+
+#endif // OTA_COAP
+
+const OTACoapStats &coapStats() {
+  return stats;
+}
@@ -0,0 +1,77 @@
+/**
+ * OTA_Coap.h
+ *
+ * Version check by CoAP (RFC 7252) for the OTA Template. An HTTP check costs a TCP
+ * handshake, headers and the teardown to learn that nothing changed; with
+ * -DOTA_COAP=1 the device asks the OTA server with a single datagram instead:
+ *
+ *   CON GET coap://<server>:OTA_COAP_PORT/version/<version>.version
+ *   ACK 2.05 Content "<available version>"            (piggybacked response)
+ *
+ * The request is confirmable. It is repeated with the same message ID after
+ * OTA_COAP_TIMEOUT ms (randomized by up to 50 %), the timeout doubled per
+ * retransmission, at most OTA_COAP_RETRIES times. Without an answer the check falls
+ * back to HTTP (and the mirrors, OTA_Mirror.h), and CoAP is not tried again for
+ * OTA_COAP_RETRY_AFTER ms. Manifest and image are always loaded by HTTP.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_COAP_H
+#define OTA_COAP_H
+
+#include <Arduino.h>
+
+#ifndef OTA_COAP
+#define OTA_COAP 0                         // 1: version check by CoAP, HTTP as fallback
+#endif
+#ifndef OTA_COAP_PORT
+#define OTA_COAP_PORT 5683                 // CoAP port of the OTA server
+#endif
+#ifndef OTA_COAP_TIMEOUT
+#define OTA_COAP_TIMEOUT 500               // Initial retransmission timeout (ms)
+#endif
+#ifndef OTA_COAP_RETRIES
+#define OTA_COAP_RETRIES 2                 // Retransmissions before the HTTP fallback
+#endif
+#ifndef OTA_COAP_RETRY_AFTER
+#define OTA_COAP_RETRY_AFTER 3600000       // No CoAP after a failed exchange for this time (ms)
+#endif
+
+struct OTACoapStats {
+  uint32_t requests;      // Exchanges started
+  uint32_t retransmits;   // Requests sent again
+  uint32_t fallbacks;     // Checks done by HTTP because CoAP got no answer
+  uint32_t rttMs;         // Duration of the last successful exchange
+};
+
+/**
+ * Requests the version file of the current firmware from the selected OTA server.
+ * Writes the payload of a 2.05 response to version.
+ * @return the response code as HTTP code (2.05 = 200, 4.04 = 404), 0 if there is no
+ *         usable CoAP answer (disabled, timeout, reset, server error 5.xx, version
+ *         longer than size - 1) and HTTP is to be used
+ */
+int coapCheckVersion(char *version, size_t size);
+
+/**
+ * Returns the CoAP statistics of the current boot.
+ */
+const OTACoapStats &coapStats();
+
+#endif // OTA_COAP_H
@@ -0,0 +1,368 @@
+/**
+ * OTA_Dns.cpp
+ *
+ * Implementation of the resolver cache and the DNS-SD discovery (see OTA_Dns.h).
+ * Queries and answers are handled with a minimal DNS message parser: questions are
+ * skipped, answer, authority and additional records are read with name compression.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Dns.h"
+#include <WiFiUdp.h>
+
+#define DNS_PORT 53
+#define MDNS_PORT 5353
+#define MDNS_GROUP IPAddress(224, 0, 0, 251)
+#define TYPE_A 1
+#define TYPE_CNAME 5
+#define TYPE_PTR 12
+#define TYPE_SRV 33
+#define MAX_MESSAGE 512    // DNS over UDP without EDNS
+#define MAX_NAME 128
+#define MAX_RECORDS 16
+
+struct CacheEntry {
+  char host[32];
+  IPAddress ip;
+  unsigned long fetched;
+  uint32_t ttlMs;
+};
+
+struct Record {
+  uint16_t type;
+  uint32_t ttl;
+  size_t name;             // Offsets in message
+  size_t data;
+  uint16_t dataLen;
+};
+
+static CacheEntry cache[OTA_DNS_CACHE_SIZE];
+static CacheEntry service;           // Discovered OTA server, host holds the IP address
+static int servicePort = 0;
+static uint8_t message[MAX_MESSAGE];
+static Record records[MAX_RECORDS];
+static OTADnsStats stats = { 0, 0, 0, 0, 0, 0 };
+
+static bool isLocal(const char *host) {
+  size_t len = strlen(host);
+  return len > 6 && strcasecmp(host + len - 6, ".local") == 0;
+}
+
+static uint32_t clampTtl(uint32_t ttl) {
+  if (ttl < OTA_DNS_MIN_TTL) ttl = OTA_DNS_MIN_TTL;
+  if (ttl > OTA_DNS_MAX_TTL) ttl = OTA_DNS_MAX_TTL;
+  return ttl * 1000;
+}
+
+/**
+ * Writes a query for name and type into message. Returns its length, 0 if name is too long.
+ */
+static size_t buildQuery(uint16_t id, const char *name, uint16_t type, bool recursive) {
+  memset(message, 0, 12);
+  message[0] = id >> 8;
+  message[1] = id & 0xFF;
+  message[2] = recursive ? 0x01 : 0x00;  // RD
+  message[5] = 1;                        // One question
+  size_t pos = 12;
+  while (*name) {
+    const char *dot = strchr(name, '.');
+    size_t len = dot ? (size_t)(dot - name) : strlen(name);
+    if (len == 0 || len > 63 || pos + len + 6 > sizeof(message)) return 0;
+    message[pos++] = len;
+    memcpy(message + pos, name, len);
+    pos += len;
+    name += dot ? len + 1 : len;
+  }
+  message[pos++] = 0;
+  message[pos++] = 0;
+  message[pos++] = type;
+  message[pos++] = 0;
+  message[pos++] = 1;                    // Class IN
+  return pos;
+}
+
+/**
+ * Reads the (compressed) name at pos as dotted string and moves pos behind it.
+ */
+static bool readName(size_t len, size_t &pos, char *out, size_t size) {
+  size_t p = pos;
+  size_t n = 0;
+  bool jumped = false;
+  for (int hops = 0; hops < 16;) {
+    if (p >= len) return false;
+    uint8_t l = message[p];
+    if ((l & 0xC0) == 0xC0) {
+      if (p + 1 >= len) return false;
+      if (!jumped) pos = p + 2;
+      jumped = true;
+      p = (size_t)(l & 0x3F) << 8 | message[p + 1];
+      hops++;
+      continue;
+    }
+    p++;
+    if (l == 0) {
+      out[n] = '\0';
+      if (!jumped) pos = p;
+      return true;
+    }
+    if (p + l > len || n + l + 1 >= size) return false;
+    if (n) out[n++] = '.';
+    memcpy(out + n, message + p, l);
+    n += l;
+    p += l;
+  }
+  return false;
+}
+
+static bool nameIs(size_t len, size_t pos, const char *name) {
+  char buf[MAX_NAME];
+  return readName(len, pos, buf, sizeof(buf)) && strcasecmp(buf, name) == 0;
+}
+
+/**
+ * Checks the answer to query id and reads its resource records.
+ * Returns the number of records, -1 if the message is no valid answer.
+ */
+static int parseAnswer(size_t len, uint16_t id) {
+  if (len < 12 || ((uint16_t)message[0] << 8 | message[1]) != id || !(message[2] & 0x80)) return -1;
+  if ((message[3] & 0x0F) != 0) return 0;        // NXDOMAIN etc.: answer without records
+  uint16_t questions = (uint16_t)message[4] << 8 | message[5];
+  uint16_t total = ((uint16_t)message[6] << 8 | message[7]) + ((uint16_t)message[8] << 8 | message[9]) +
+                   ((uint16_t)message[10] << 8 | message[11]);
+  char name[MAX_NAME];
+  size_t pos = 12;
+  for (uint16_t i = 0; i < questions; ++i) {
+    if (!readName(len, pos, name, sizeof(name)) || pos + 4 > len) return -1;
+    pos += 4;
+  }
+  int count = 0;
+  for (uint16_t i = 0; i < total && count < MAX_RECORDS; ++i) {
+    Record &r = records[count];
+    r.name = pos;
+    if (!readName(len, pos, name, sizeof(name)) || pos + 10 > len) break;
+    r.type = (uint16_t)message[pos] << 8 | message[pos + 1];
+    r.ttl = (uint32_t)message[pos + 4] << 24 | (uint32_t)message[pos + 5] << 16 | (uint32_t)message[pos + 6] << 8 |
+            message[pos + 7];
+    r.dataLen = (uint16_t)message[pos + 8] << 8 | message[pos + 9];
+    r.data = pos + 10;
+    pos = r.data + r.dataLen;
+    if (pos > len) break;
+    count++;
+  }
+  return count;
+}
+
+/**
+ * Finds the A record of name in the records of the last answer, following CNAMEs.
+ */
+static bool findAddress(size_t len, int count, const char *name, IPAddress &ip, uint32_t &ttl) {
+  char target[MAX_NAME];
+  strncpy(target, name, sizeof(target) - 1);
+  target[sizeof(target) - 1] = '\0';
+  for (int hops = 0; hops < 4; ++hops) {
+    bool alias = false;
+    for (int i = 0; i < count; ++i) {
+      const Record &r = records[i];
+      if (!nameIs(len, r.name, target)) continue;
+      if (r.type == TYPE_A && r.dataLen == 4) {
+        ip = IPAddress(message[r.data], message[r.data + 1], message[r.data + 2], message[r.data + 3]);
+        ttl = r.ttl;
+        return true;
+      }
+      size_t pos = r.data;
+      if (r.type == TYPE_CNAME && readName(len, pos, target, sizeof(target))) {
+        alias = true;
+        break;
+      }
+    }
+    if (!alias) return false;
+  }
+  return false;
+}
+
+/**
+ * Sends the query in message to server and waits for the answer to id.
+ * Returns the length of the answer in message, 0 on timeout.
+ */
+static size_t exchange(IPAddress server, uint16_t port, size_t length, uint16_t id) {
+  WiFiUDP udp;
+  if (!udp.begin(49152 + random(16384))) return 0;   // Random source port against spoofed answers
+  udp.beginPacket(server, port);
+  udp.write(message, length);
+  udp.endPacket();
+  stats.queries++;
+  unsigned long start = millis();
+  while (millis() - start < OTA_DNS_TIMEOUT) {
+    if (udp.parsePacket() <= 0) {
+      delay(5);
+      continue;
+    }
+    size_t len = udp.read(message, sizeof(message));
+    if (len >= 12 && ((uint16_t)message[0] << 8 | message[1]) == id) {
+      udp.stop();
+      return len;
+    }
+  }
+  udp.stop();
+  return 0;
+}
+
+/**
+ * Queries the A record of host by DNS, or by multicast DNS for ".local" names.
+ * Returns 1 if found, 0 if the answer has no address, -1 if there was no answer.
+ */
+static int query(const char *host, IPAddress &ip, uint32_t &ttl) {
+  bool mdns = isLocal(host);
+  IPAddress server = mdns ? MDNS_GROUP : WiFi.dnsIP();
+  if (server == IPAddress(0, 0, 0, 0)) return -1;
+  for (int attempt = 0; attempt < OTA_DNS_RETRIES; ++attempt) {
+    uint16_t id = (uint16_t)random(1, 65536);
+    size_t length = buildQuery(id, host, TYPE_A, !mdns);
+    if (!length) return 0;
+    size_t len = exchange(server, mdns ? MDNS_PORT : DNS_PORT, length, id);
+    int count = len ? parseAnswer(len, id) : -1;
+    if (count < 0) continue;                          // No answer, ask again
+    return findAddress(len, count, host, ip, ttl) ? 1 : 0;
+  }
+  return -1;
+}
+
+static CacheEntry *findEntry(const char *host) {
+  for (int i = 0; i < OTA_DNS_CACHE_SIZE; ++i) {
+    if (cache[i].host[0] && strcasecmp(cache[i].host, host) == 0) return &cache[i];
+  }
+  return nullptr;
+}
+
+bool dnsResolve(const char *host, IPAddress &ip) {
+  if (ip.fromString(host)) return true;
+  CacheEntry *e = findEntry(host);
+  if (e && millis() - e->fetched < e->ttlMs) {
+    ip = e->ip;
+    stats.hits++;
+    return true;
+  }
+  unsigned long start = millis();
+  IPAddress found;
+  uint32_t ttl = 0;
+  int result = query(host, found, ttl);
+  bool ok = result == 1;
+  if (result < 0 && !isLocal(host) && WiFi.hostByName(host, found) == 1) { // Resolver of the core, TTL unknown
+    ok = true;
+    ttl = OTA_DNS_TTL;
+  }
+  stats.lookupMs = millis() - start;
+  if (!ok) {
+    if (e) {                                          // Keep the old address, try again after OTA_DNS_MIN_TTL
+      Serial.printf("DNS: %s not resolved, using %s\n", host, e->ip.toString().c_str());
+      e->fetched = millis();
+      e->ttlMs = clampTtl(0);
+      ip = e->ip;
+      stats.stale++;
+      return true;
+    }
+    Serial.printf("DNS: %s not resolved\n", host);
+    stats.failures++;
+    return false;
+  }
+  if (!e && strlen(host) < sizeof(cache[0].host)) {
+    e = &cache[0];                                    // Free entry or the one fetched longest ago
+    for (int i = 0; i < OTA_DNS_CACHE_SIZE; ++i) {
+      if (!cache[i].host[0]) {
+        e = &cache[i];
+        break;
+      }
+      if (millis() - cache[i].fetched > millis() - e->fetched) e = &cache[i];
+    }
+    strcpy(e->host, host);
+  }
+  if (e) {
+    e->ip = found;
+    e->fetched = millis();
+    e->ttlMs = clampTtl(ttl);
+  }
+  Serial.printf("DNS: %s is %s, TTL %lu s, %lu ms\n", host, found.toString().c_str(), (unsigned long)ttl,
+                (unsigned long)stats.lookupMs);
+  ip = found;
+  return true;
+}
+
+void dnsForget(const char *host) {
+  CacheEntry *e = findEntry(host);
+  if (e) e->host[0] = '\0';
+  if (strcmp(service.host, host) == 0) service.host[0] = '\0';
+}
+
+bool dnsDiscover(char *host, size_t size, int &port) {
+  if (!service.host[0] || millis() - service.fetched >= service.ttlMs) {
+    char instance[MAX_NAME];
+    char target[MAX_NAME];
+    bool found = false;
+    for (int attempt = 0; attempt < OTA_DNS_RETRIES && !found; ++attempt) {
+      uint16_t id = (uint16_t)random(1, 65536);
+      size_t len = exchange(MDNS_GROUP, MDNS_PORT, buildQuery(id, OTA_DNS_SD_SERVICE, TYPE_PTR, false), id);
+      int count = len ? parseAnswer(len, id) : -1;
+      uint32_t ttl = 0;
+      int srv = -1;
+      for (int i = 0; i < count && srv < 0; ++i) {    // PTR: service -> instance
+        size_t pos = records[i].data;
+        if (records[i].type != TYPE_PTR || !nameIs(len, records[i].name, OTA_DNS_SD_SERVICE) ||
+            !readName(len, pos, instance, sizeof(instance))) {
+          continue;
+        }
+        ttl = records[i].ttl;
+        for (int j = 0; j < count; ++j) {             // SRV: instance -> port and host
+          if (records[j].type == TYPE_SRV && records[j].dataLen > 6 && nameIs(len, records[j].name, instance)) {
+            srv = j;
+            break;
+          }
+        }
+      }
+      if (srv < 0) continue;
+      size_t pos = records[srv].data + 6;
+      int srvPort = (int)message[records[srv].data + 4] << 8 | message[records[srv].data + 5];
+      if (!readName(len, pos, target, sizeof(target))) continue;
+      IPAddress ip;
+      uint32_t ipTtl;
+      if (!findAddress(len, count, target, ip, ipTtl) && !dnsResolve(target, ip)) continue;
+      strncpy(service.host, ip.toString().c_str(), sizeof(service.host) - 1);
+      servicePort = srvPort;
+      service.fetched = millis();
+      service.ttlMs = clampTtl(ttl);
+      stats.discoveries++;
+      Serial.printf("DNS-SD: OTA server %s at %s:%d\n", instance, service.host, servicePort);
+      found = true;
+    }
+    if (!found) {
+      Serial.println("DNS-SD: no OTA server found.");
+      stats.failures++;
+      return false;
+    }
+  } else {
+    stats.hits++;
+  }
+  if (strlen(service.host) >= size) return false;
+  strcpy(host, service.host);
+  port = servicePort;
+  return true;
+}
+
+const OTADnsStats &dnsStats() {
+  return stats;
+}
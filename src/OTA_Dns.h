@@ -0,0 +1,106 @@
+/**
+ * OTA_Dns.h
+ *
+ * Name resolution for the OTA Template. Host names of the OTA server and its mirrors
+ * (OTA_Mirror.h) are resolved once and kept in a small cache for the TTL of the DNS
+ * answer, so the version check, the download and its retries and the RTT probes of a
+ * check share one lookup:
+ *
+ *  - The A record is queried directly from the DNS server of the network (the TTL is
+ *    not available through WiFi.hostByName()); names ending in ".local" by multicast
+ *    DNS. If the query gets no answer, WiFi.hostByName() is used with OTA_DNS_TTL.
+ *  - TTLs are limited to OTA_DNS_MIN_TTL .. OTA_DNS_MAX_TTL, so a TTL of 0 does not
+ *    cause a lookup per request.
+ *  - If a name cannot be resolved (DNS server down, WiFi flaky) an expired entry is
+ *    used again instead of failing the check.
+ *
+ * With the OTA server "auto" in the configuration the device discovers the server by
+ * DNS-SD: it asks by multicast DNS for the service OTA_DNS_SD_SERVICE, which
+ * ota-server.js advertises, and uses host and port of the first answer.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_DNS_H
+#define OTA_DNS_H
+
+#include <Arduino.h>
+
+#if defined(ESP8266)
+  #include <ESP8266WiFi.h>
+#elif defined(ESP32)
+  #include <WiFi.h>
+#endif
+
+#ifndef OTA_DNS_CACHE_SIZE
+#define OTA_DNS_CACHE_SIZE 4               // Cached host names
+#endif
+#ifndef OTA_DNS_TIMEOUT
+#define OTA_DNS_TIMEOUT 1000               // Wait for an answer per query (ms)
+#endif
+#ifndef OTA_DNS_RETRIES
+#define OTA_DNS_RETRIES 2                  // Queries per lookup
+#endif
+#ifndef OTA_DNS_MIN_TTL
+#define OTA_DNS_MIN_TTL 60                 // Min. time an answer is cached (s)
+#endif
+#ifndef OTA_DNS_MAX_TTL
+#define OTA_DNS_MAX_TTL 86400              // Max. time an answer is cached (s)
+#endif
+#ifndef OTA_DNS_TTL
+#define OTA_DNS_TTL 300                    // Cache time of WiFi.hostByName() results (s)
+#endif
+#ifndef OTA_DNS_SD_SERVICE
+#define OTA_DNS_SD_SERVICE "_ota._tcp.local" // DNS-SD service of the OTA server
+#endif
+
+#define OTA_DNS_AUTO "auto"                // OTA server name that enables discovery
+
+struct OTADnsStats {
+  uint32_t hits;          // Lookups answered from the cache
+  uint32_t queries;       // DNS and mDNS queries sent
+  uint32_t stale;         // Expired entries used because the lookup failed
+  uint32_t failures;      // Lookups without result
+  uint32_t lookupMs;      // Duration of the last lookup that was not cached
+  uint32_t discoveries;   // OTA servers found by DNS-SD
+};
+
+/**
+ * Resolves host (name or IP address) to ip, from the cache if possible.
+ * @return false if the name cannot be resolved and is not cached
+ */
+bool dnsResolve(const char *host, IPAddress &ip);
+
+/**
+ * Removes host from the cache, e.g. after the server did not answer on its address.
+ */
+void dnsForget(const char *host);
+
+/**
+ * Discovers an OTA server by DNS-SD (OTA_DNS_SD_SERVICE). Writes its IP address as
+ * string to host and its port to port. The answer is cached for its TTL.
+ * @return false if no server answered
+ */
+bool dnsDiscover(char *host, size_t size, int &port);
+
+/**
+ * Returns the resolver statistics of the current boot.
+ */
+const OTADnsStats &dnsStats();
+
+#endif // OTA_DNS_H
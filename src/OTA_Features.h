@@ -0,0 +1,45 @@
+/**
+ * OTA_Features.h
+ *
+ * Compile-time switches of the optional features of the OTA Template. A feature set
+ * to 0 in the build_flags (e.g. -DOTA_FEATURE_STATUS=0) removes its code and strings
+ * from the image. All switches are defined here, tools/feature_cost.py reads them from
+ * this file and reports the flash and RAM cost of each one.
+ *
+ * Included by OTA_Platform.h, so the switches are known in every module.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_FEATURES_H
+#define OTA_FEATURES_H
+
+#ifndef OTA_FEATURE_STATUS
+#define OTA_FEATURE_STATUS 1            // /ota/status and its metrics JSON (OTA_Template.cpp)
+#endif
+#ifndef OTA_FEATURE_DESCRIPTION
+#define OTA_FEATURE_DESCRIPTION 1       // Description of the device on the configuration page
+#endif
+#ifndef OTA_FEATURE_FORM_STYLE
+#define OTA_FEATURE_FORM_STYLE 1        // Style sheet of the configuration page
+#endif
+#ifndef OTA_FEATURE_CONFIG_DUMP
+#define OTA_FEATURE_CONFIG_DUMP 1       // Prints the loaded configuration on the serial interface
+#endif
+
+#endif // OTA_FEATURES_H
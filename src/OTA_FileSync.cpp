@@ -0,0 +1,357 @@
+/**
+ * OTA_FileSync.cpp
+ *
+ * Implementation of the file system updates (see OTA_FileSync.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_FileSync.h"
+
+#if OTA_FS_SYNC
+
+#include "OTA_Template.h"
+#include <LittleFS.h>
+
+#define LIST_FILE "/.otafs.new"      // File list loaded from the server
+#define NEXT_INDEX "/.otafs.tmp"     // Index written during a sync
+#define LINE_SIZE (OTA_FS_PATH_MAX + 80)
+#define CHUNK_SIZE 512
+
+struct FileEntry {
+  uint8_t sha[OTA_SHA256_SIZE];
+  uint32_t size;
+  char path[OTA_FS_PATH_MAX];
+};
+
+static bool mounted = false;
+static OTAFsStats stats = { 0, 0, 0, 0, 0, 0, 0 };
+static uint8_t chunk[CHUNK_SIZE];
+
+void fsSyncBegin() {
+  mounted = LittleFS.begin();
+  if (!mounted) Serial.println("FS: LittleFS not mounted, files not synchronized.");
+}
+
+/**
+ * Copies size bytes from stream to file, hashing them if hash is set.
+ */
+static bool copyStream(WiFiClient *stream, File &file, size_t size, OTASha256 *hash) {
+  size_t done = 0;
+  unsigned long lastData = millis();
+  while (done < size && millis() - lastData < OTA_VERIFY_TIMEOUT) {
+    size_t avail = stream->available();
+    if (!avail) {
+      if (!stream->connected()) break;
+      delay(1);
+      continue;
+    }
+    size_t want = size - done;
+    if (want > sizeof(chunk)) want = sizeof(chunk);
+    if (avail < want) want = avail;
+    size_t n = stream->readBytes(chunk, want);
+    if (!n) continue;
+    if (hash) hash->update(chunk, n);
+    if (file.write(chunk, n) != n) return false;
+    done += n;
+    lastData = millis();
+  }
+  return done == size;
+}
+
+/**
+ * Reads a line without '\n'. Returns false at the end of the file; longer lines are
+ * cut and their rest skipped.
+ */
+static bool readLine(File &file, char *buf, size_t size) {
+  size_t n = 0;
+  int c;
+  while ((c = file.read()) >= 0 && c != '\n') {
+    if (n + 1 < size) buf[n++] = (char)c;
+  }
+  buf[n] = '\0';
+  return c >= 0 || n > 0;
+}
+
+/**
+ * Only plain absolute paths are accepted, nothing outside the synchronized files.
+ */
+static bool validPath(const char *path) {
+  if (path[0] != '/' || strstr(path, "..") || strstr(path, "//") || strncmp(path, OTA_FS_INDEX, strlen(OTA_FS_INDEX)) == 0) {
+    return false;
+  }
+  for (const char *p = path; *p; ++p) {
+    if (!isalnum((unsigned char)*p) && !strchr("._-/", *p)) return false;
+  }
+  return path[strlen(path) - 1] != '/';
+}
+
+/**
+ * Parses "<sha256> <size> <path>".
+ */
+static bool parseEntry(const char *line, FileEntry &e) {
+  char hex[OTA_SHA256_HEX_SIZE];
+  unsigned long size;
+  int pathAt = 0;
+  if (sscanf(line, "%64s %lu %n", hex, &size, &pathAt) != 2 || !pathAt || !OTASha256::fromHex(hex, e.sha)) return false;
+  if (strlen(line + pathAt) >= sizeof(e.path)) return false;
+  strcpy(e.path, line + pathAt);
+  e.size = size;
+  return validPath(e.path);
+}
+
+static void writeEntry(File &file, const FileEntry &e) {
+  char hex[OTA_SHA256_HEX_SIZE];
+  OTASha256::toHex(e.sha, hex);
+  file.printf("%s %lu %s\n", hex, (unsigned long)e.size, e.path);
+}
+
+/**
+ * Searches path in the entries of a list or index file, starting at offset start.
+ */
+static bool findEntry(File &file, size_t start, const char *path, FileEntry &e) {
+  char line[LINE_SIZE];
+  file.seek(start);
+  while (readLine(file, line, sizeof(line))) {
+    if (parseEntry(line, e) && strcmp(e.path, path) == 0) return true;
+  }
+  return false;
+}
+
+/**
+ * Creates the parent directories of path, rename() does not.
+ */
+static void makeDirs(const char *path) {
+  char dir[OTA_FS_PATH_MAX];
+  for (const char *p = strchr(path + 1, '/'); p; p = strchr(p + 1, '/')) {
+    memcpy(dir, path, p - path);
+    dir[p - path] = '\0';
+    LittleFS.mkdir(dir);
+  }
+}
+
+static bool fsUrl(char *buf, size_t size, const char *prefix, const char *path) {
+  const OTAMirror &m = mirrorCurrent();
+  int n = snprintf(buf, size, OTA_SCHEME "://%s:%d%s%s%s", m.host, m.port, prefix, config.firmware_name, path);
+  return n > 0 && (size_t)n < size;
+}
+
+/**
+ * Downloads a file to OTA_FS_TEMP and renames it to its path if size and hash match.
+ * online is cleared if the server cannot be reached, the remaining files are skipped.
+ */
+static bool install(const FileEntry &e, bool &online) {
+  char url[128 + OTA_FS_PATH_MAX];
+  if (!fsUrl(url, sizeof(url), OTA_FS_FILES_PATH, e.path)) return false;
+  HTTPClient http;
+  int code = clientBegin(http, url) ? http.GET() : HTTPC_ERROR_CONNECTION_REFUSED;
+  if (code != HTTP_CODE_OK || http.getSize() != (int)e.size) {
+    Serial.printf("FS: %s not loaded, HTTP code %d, size %d\n", e.path, code, http.getSize());
+    online = code > 0;
+    http.end();
+    return false;
+  }
+  File temp = LittleFS.open(OTA_FS_TEMP, "w");
+  OTASha256 hash;
+  bool ok = temp && copyStream(http.getStreamPtr(), temp, e.size, &hash);
+  temp.close();
+  http.end();
+  uint8_t sha[OTA_SHA256_SIZE];
+  hash.finish(sha);
+  if (!ok || memcmp(sha, e.sha, sizeof(sha)) != 0) {
+    Serial.printf("FS: %s %s\n", e.path, ok ? "does not match its hash" : "incomplete");
+    LittleFS.remove(OTA_FS_TEMP);
+    return false;
+  }
+  makeDirs(e.path);
+  if (!LittleFS.rename(OTA_FS_TEMP, e.path)) {
+    Serial.printf("FS: %s cannot be replaced\n", e.path);
+    LittleFS.remove(OTA_FS_TEMP);
+    return false;
+  }
+  stats.bytes += e.size;
+  return true;
+}
+
+/**
+ * Checks header, signature and hash of the loaded file list. Returns the offset of the
+ * first entry, 0 if the list is not valid.
+ */
+static size_t checkList(File &list, char hex[OTA_SHA256_HEX_SIZE]) {
+  char line[LINE_SIZE];
+  char sig[2 * 80 + 2];
+  unsigned files;
+  if (!readLine(list, line, sizeof(line)) || sscanf(line, "OTA1F %u %64s", &files, hex) != 2) {
+    Serial.println("FS: file list not readable.");
+    return 0;
+  }
+  uint8_t expected[OTA_SHA256_SIZE];
+  uint8_t sha[OTA_SHA256_SIZE];
+  OTASha256 hash;
+#if OTA_VERIFY_SIGNED
+  hash.update((const uint8_t *)line, strlen(line));
+  hash.finish(sha);
+  hash.begin();
+  if (!readLine(list, sig, sizeof(sig)) || !verifySignature(sha, sig)) {
+    Serial.println("FS: file list signature not valid.");
+    return 0;
+  }
+#else
+  readLine(list, sig, sizeof(sig));
+#endif
+  size_t start = list.position();
+  int n;
+  while ((n = list.read(chunk, sizeof(chunk))) > 0) hash.update(chunk, n);
+  hash.finish(sha);
+  if (!OTASha256::fromHex(hex, expected) || memcmp(sha, expected, sizeof(sha)) != 0) {
+    Serial.println("FS: file list does not match its hash.");
+    return 0;
+  }
+  return start;
+}
+
+/**
+ * Installs the changed files of the list and deletes the files no longer listed.
+ * The new index is written to NEXT_INDEX; its hash is set only if all files are
+ * installed, so an incomplete sync loads the list again on the next check.
+ */
+static OTAFsResult apply(File &list, size_t listStart, const char *listHex) {
+  char line[LINE_SIZE];
+  File index = LittleFS.open(OTA_FS_INDEX, "r");
+  size_t indexStart = index && readLine(index, line, sizeof(line)) ? index.position() : 0;
+  File next = LittleFS.open(NEXT_INDEX, "w");
+  if (!next) return OTA_FS_FAILED;
+  next.print("OTA1I ");
+  for (int i = 0; i < 2 * OTA_SHA256_SIZE; ++i) next.write('-'); // Hash of the list, set when complete
+  next.write('\n');
+  uint32_t downloaded = 0, deleted = 0, failed = 0, files = 0;
+  bool online = true;
+  FileEntry e;
+  FileEntry old;
+  list.seek(listStart);
+  while (readLine(list, line, sizeof(line))) {
+    if (!parseEntry(line, e)) {
+      Serial.printf("FS: invalid entry '%s'\n", line);
+      failed++;
+      continue;
+    }
+    bool known = indexStart && findEntry(index, indexStart, e.path, old);
+    if (known && old.size == e.size && memcmp(old.sha, e.sha, sizeof(e.sha)) == 0 && LittleFS.exists(e.path)) {
+      writeEntry(next, e);
+      files++;
+      continue;
+    }
+    if (online && install(e, online)) {
+      Serial.printf("FS: %s updated, %lu bytes\n", e.path, (unsigned long)e.size);
+      writeEntry(next, e);
+      downloaded++;
+      files++;
+      continue;
+    }
+    failed++;
+    if (known) {                     // The old file is still in place
+      writeEntry(next, old);
+      files++;
+    }
+  }
+  if (indexStart) {
+    index.seek(indexStart);
+    while (readLine(index, line, sizeof(line))) {
+      if (parseEntry(line, old) && !findEntry(list, listStart, old.path, e)) {
+        if (LittleFS.remove(old.path)) {
+          Serial.printf("FS: %s deleted\n", old.path);
+          deleted++;
+        }
+      }
+    }
+  }
+  index.close();
+  if (!failed) {
+    next.seek(6);
+    next.print(listHex);
+  }
+  next.close();
+  LittleFS.rename(NEXT_INDEX, OTA_FS_INDEX);
+  stats.downloaded += downloaded;
+  stats.deleted += deleted;
+  stats.failed += failed;
+  stats.files = files;
+  Serial.printf("FS: %lu files, %lu updated, %lu deleted, %lu failed\n", (unsigned long)files,
+                (unsigned long)downloaded, (unsigned long)deleted, (unsigned long)failed);
+  if (failed) return OTA_FS_FAILED;
+  return downloaded || deleted ? OTA_FS_UPDATED : OTA_FS_UP_TO_DATE;
+}
+
+OTAFsResult fsSyncUpdate() {
+  if (!mounted) return OTA_FS_NONE;
+  unsigned long start = millis();
+  char url[128];
+  if (!fsUrl(url, sizeof(url), OTA_FS_MANIFEST_PATH, "")) return OTA_FS_FAILED;
+  char tag[OTA_SHA256_HEX_SIZE + 2] = "";
+  File index = LittleFS.open(OTA_FS_INDEX, "r");
+  char line[LINE_SIZE];
+  if (index && readLine(index, line, sizeof(line)) && strlen(line) == 6 + 64 && line[6] != '-') {
+    snprintf(tag, sizeof(tag), "\"%.64s\"", line + 6);
+  }
+  index.close();
+
+  HTTPClient http;
+  if (!clientBegin(http, url)) return OTA_FS_FAILED;
+  if (tag[0]) http.addHeader("If-None-Match", tag);
+  int code = http.GET();
+  int len = http.getSize();
+  if (code == HTTP_CODE_NOT_MODIFIED || code == HTTP_CODE_NOT_FOUND) {
+    http.end();
+    if (code == HTTP_CODE_NOT_MODIFIED) Serial.println("FS: files are up to date.");
+    return code == HTTP_CODE_NOT_MODIFIED ? OTA_FS_UP_TO_DATE : OTA_FS_NONE;
+  }
+  File list = LittleFS.open(LIST_FILE, "w");
+  bool ok = code == HTTP_CODE_OK && len > 0 && list && copyStream(http.getStreamPtr(), list, len, nullptr);
+  list.close();
+  http.end();
+  if (!ok) {
+    Serial.printf("FS: file list not loaded, HTTP code %d\n", code);
+    return OTA_FS_FAILED;
+  }
+  stats.syncs++;
+  list = LittleFS.open(LIST_FILE, "r");
+  char hex[OTA_SHA256_HEX_SIZE];
+  size_t listStart = checkList(list, hex);
+  OTAFsResult result = listStart ? apply(list, listStart, hex) : OTA_FS_FAILED;
+  list.close();
+  LittleFS.remove(LIST_FILE);
+  stats.lastMs = millis() - start;
+  return result;
+}
+
+#else
+
+void fsSyncBegin() {
+}
+
+OTAFsResult fsSyncUpdate() {
+  return OTA_FS_NONE;
+}
+
+static OTAFsStats stats = { 0, 0, 0, 0, 0, 0, 0 };
+
+#endif // OTA_FS_SYNC
+
+const OTAFsStats &fsSyncStats() {
+  return stats;
+}
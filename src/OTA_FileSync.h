@@ -0,0 +1,97 @@
+/**
+ * OTA_FileSync.h
+ *
+ * File system updates for the OTA Template. Besides the firmware the OTA server
+ * publishes the files of the LittleFS partition (web assets, tables) of a firmware in
+ * updates/fs/<firmware>/. Instead of a complete file system image the device loads
+ * only the files that changed:
+ *
+ *   GET /fsmanifest/<firmware>
+ *   OTA1F <files> <sha256 of the file list>
+ *   <ECDSA P-256 signature of the first line, DER as hex, or empty>
+ *   <sha256> <size> <path>                      (one line per file)
+ *
+ * The device keeps the list of the files it installed with their hashes in
+ * OTA_FS_INDEX, so a check needs no scan of the file system. The hash of the last
+ * complete list is sent as If-None-Match; the server answers 304 while nothing
+ * changed. Otherwise every file whose hash differs from the index is downloaded to
+ * OTA_FS_TEMP, checked against size and hash and renamed to its path, which replaces
+ * the old file atomically. Files of the index that are no longer listed are deleted;
+ * files the application created itself are never touched.
+ *
+ * The files are synchronized after an update check found the firmware up to date, so
+ * a new firmware is installed (and restarted) before the files that belong to it. With
+ * OTA_VERIFY_KEY (OTA_Verify.h) only signed file lists are accepted.
+ *
+ * Enabled with -DOTA_FS_SYNC=1; the application may mount LittleFS itself before
+ * otaSetup().
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_FILESYNC_H
+#define OTA_FILESYNC_H
+
+#include <Arduino.h>
+
+#ifndef OTA_FS_SYNC
+#define OTA_FS_SYNC 0                      // 1: synchronize the LittleFS files with the OTA server
+#endif
+#ifndef OTA_FS_PATH_MAX
+#define OTA_FS_PATH_MAX 64                 // Max. path length of a file incl. '\0'
+#endif
+
+#define OTA_FS_INDEX "/.otafs"             // Installed files and their hashes
+#define OTA_FS_TEMP "/.otafs.dl"           // File being downloaded
+#define OTA_FS_MANIFEST_PATH "/fsmanifest/"
+#define OTA_FS_FILES_PATH "/fs/"
+
+enum OTAFsResult {
+  OTA_FS_UP_TO_DATE,                 // Files unchanged since the last sync
+  OTA_FS_UPDATED,                    // Files downloaded or deleted
+  OTA_FS_NONE,                       // Disabled, or the server has no files for this firmware
+  OTA_FS_FAILED                      // Sync incomplete, continued on the next check
+};
+
+struct OTAFsStats {
+  uint32_t syncs;         // File lists processed (not 304)
+  uint32_t downloaded;    // Files downloaded and installed since boot
+  uint32_t deleted;       // Files deleted since boot
+  uint32_t failed;        // Files that could not be installed since boot
+  uint32_t bytes;         // Bytes downloaded since boot
+  uint32_t files;         // Files in the index after the last sync
+  uint32_t lastMs;        // Duration of the last sync
+};
+
+/**
+ * Mounts LittleFS. Called by otaSetup().
+ */
+void fsSyncBegin();
+
+/**
+ * Synchronizes the files with the list of the selected OTA server (OTA_Mirror.h).
+ * Called by performOTAUpdate() when the firmware is up to date.
+ */
+OTAFsResult fsSyncUpdate();
+
+/**
+ * Returns the file sync statistics of the current boot.
+ */
+const OTAFsStats &fsSyncStats();
+
+#endif // OTA_FILESYNC_H
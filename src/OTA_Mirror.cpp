@@ -0,0 +1,216 @@
+/**
+ * OTA_Mirror.cpp
+ *
+ * Implementation of the OTA server mirrors (see OTA_Mirror.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Mirror.h"
+#include "OTA_WebConfig.h"
+#include "OTA_Client.h"
+#include "OTA_Dns.h"
+#include "OTA_Platform.h"
+
+static OTAMirror mirrors[OTA_MIRROR_MAX];
+static uint8_t count = 0;
+static uint8_t current = 0;
+static uint8_t tried = 0;            // Bit mask of the servers tried in the current check
+static unsigned long lastProbe = 0;
+static bool probed = false;
+static OTAMirrorStats stats = { 0, 0, 0 };
+
+/**
+ * Adds a server "host[:port]" to the list, the port defaults to otaPort.
+ */
+static void addMirror(const char *text, size_t len) {
+  while (len && *text == ' ') {
+    text++;
+    len--;
+  }
+  while (len && text[len - 1] == ' ') len--;
+  if (!len || count >= OTA_MIRROR_MAX) return;
+  OTAMirror &m = mirrors[count];
+  const char *colon = (const char *)memchr(text, ':', len);
+  size_t hostLen = colon ? (size_t)(colon - text) : len;
+  if (hostLen == 0 || hostLen >= sizeof(m.host)) {
+    Serial.printf("Mirror: invalid entry '%.*s'\n", (int)len, text);
+    return;
+  }
+  memcpy(m.host, text, hostLen);
+  m.host[hostLen] = '\0';
+  m.port = colon ? atoi(colon + 1) : config.otaPort;
+  m.rttMs = OTA_MIRROR_NO_RTT;
+  m.failures = 0;
+  m.healthy = true;
+  m.discover = strcmp(m.host, OTA_DNS_AUTO) == 0;
+  count++;
+}
+
+void mirrorBegin() {
+  count = 0;
+  current = 0;
+  addMirror(config.otaServer, strlen(config.otaServer));
+  mirrors[0].port = config.otaPort;
+  const char *p = config.otaMirrors;
+  while (*p) {
+    const char *end = strchr(p, ',');
+    size_t len = end ? (size_t)(end - p) : strlen(p);
+    addMirror(p, len);
+    p += end ? len + 1 : len;
+  }
+  if (count > 1) Serial.printf("Mirror: %u OTA servers\n", (unsigned)count);
+}
+
+/**
+ * Measures the RTT of a server by a TCP connect.
+ */
+static void probe(OTAMirror &m) {
+  WiFiClient tcp;
+  IPAddress ip;
+  bool ok = dnsResolve(m.host, ip);   // Outside the measurement, usually answered from the cache
+  unsigned long start = micros();
+  ok = ok && OTAPlatform::tcpConnect(tcp, ip, m.port, OTA_MIRROR_PROBE_TIMEOUT);
+  uint32_t rtt = (micros() - start + 999) / 1000;
+  tcp.stop();
+  if (!ok) {
+    m.healthy = false;
+    m.failures++;
+    return;
+  }
+  m.rttMs = m.rttMs == OTA_MIRROR_NO_RTT ? rtt : (7 * m.rttMs + rtt) / 8;
+  m.healthy = true;
+}
+
+/**
+ * Updates host and port of a discovered server. It stays unhealthy while no server
+ * answers the DNS-SD query.
+ */
+static void discover(OTAMirror &m) {
+  char host[sizeof(m.host)];
+  int port;
+  if (!dnsDiscover(host, sizeof(host), port)) {
+    m.healthy = false;
+    return;
+  }
+  if (strcmp(host, m.host) != 0 || port != m.port) {
+    if (&m == &mirrors[current]) clientEnd();
+    strcpy(m.host, host);
+    m.port = port;
+    m.rttMs = OTA_MIRROR_NO_RTT;
+  }
+  m.healthy = true;
+}
+
+/**
+ * Returns the best server not tried in this check: healthy before unhealthy, then
+ * lowest RTT, then list order. Returns count if all have been tried.
+ */
+static uint8_t best() {
+  uint8_t found = count;
+  for (uint8_t i = 0; i < count; ++i) {
+    if (tried & (1 << i)) continue;
+    if (found == count || (mirrors[i].healthy && !mirrors[found].healthy) ||
+        (mirrors[i].healthy == mirrors[found].healthy && mirrors[i].rttMs < mirrors[found].rttMs)) {
+      found = i;
+    }
+  }
+  return found;
+}
+
+void mirrorSelect() {
+  tried = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    if (mirrors[i].discover) discover(mirrors[i]);
+  }
+  if (count < 2) return;
+  if (!probed || millis() - lastProbe > OTA_MIRROR_PROBE_INTERVAL) {
+    for (uint8_t i = 0; i < count; ++i) probe(mirrors[i]);
+    lastProbe = millis();
+    probed = true;
+    stats.probes++;
+  }
+  uint8_t selected = best();
+  if (selected != current) {
+    clientEnd();
+    current = selected;
+  }
+  const OTAMirror &m = mirrors[current];
+  Serial.printf("Mirror: %s:%d selected, RTT %lu ms\n", m.host, m.port,
+                m.rttMs == OTA_MIRROR_NO_RTT ? 0UL : (unsigned long)m.rttMs);
+}
+
+const OTAMirror &mirrorCurrent() {
+  return mirrors[current];
+}
+
+bool mirrorFailover() {
+  OTAMirror &failed = mirrors[current];
+  failed.healthy = false;
+  failed.failures++;
+  clientEnd();
+  dnsForget(failed.host);              // The server may have moved, look it up again
+  tried |= 1 << current;
+  uint8_t next = best();
+  if (next == count) return false;
+  Serial.printf("Mirror: %s:%d failed, trying %s:%d\n", failed.host, failed.port, mirrors[next].host,
+                mirrors[next].port);
+  current = next;
+  stats.failovers++;
+  return true;
+}
+
+void mirrorConnected() {
+  mirrors[current].healthy = true;
+}
+
+uint8_t mirrorCount() {
+  return count;
+}
+
+const OTAMirror &mirrorAt(uint8_t i) {
+  return mirrors[i < count ? i : 0];
+}
+
+uint8_t mirrorIndex() {
+  return current;
+}
+
+void mirrorResumed() {
+  stats.resumed++;
+}
+
+bool mirrorListJson(char *buf, size_t size) {
+  size_t used = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    const OTAMirror &m = mirrors[i];
+    char host[2 * sizeof(m.host)];
+    jsonEscape(host, sizeof(host), m.host);
+    int n = snprintf(buf + used, size - used, "%c{\"host\":\"%s\",\"port\":%d,\"rttMs\":%ld,\"healthy\":%s,\"failures\":%lu,\"discovered\":%s}",
+                     i ? ',' : '[', host, m.port, m.rttMs == OTA_MIRROR_NO_RTT ? -1L : (long)m.rttMs,
+                     m.healthy ? "true" : "false", (unsigned long)m.failures, m.discover ? "true" : "false");
+    if (n < 0 || (size_t)n >= size - used) return false;
+    used += n;
+  }
+  int n = snprintf(buf + used, size - used, count ? "]" : "[]");
+  return n > 0 && (size_t)n < size - used;
+}
+
+const OTAMirrorStats &mirrorStats() {
+  return stats;
+}
@@ -0,0 +1,133 @@
+/**
+ * OTA_Mirror.h
+ *
+ * OTA server mirrors for the OTA Template. Besides the OTA server (otaServer/otaPort)
+ * the configuration holds an ordered list of mirrors ("host[:port]", comma separated,
+ * otaMirrors). All requests of an update check go to the selected server:
+ *
+ *  - At the start of a check the round trip time of every server is measured by a TCP
+ *    connect (no request, no TLS handshake), at most every OTA_MIRROR_PROBE_INTERVAL
+ *    ms and only if mirrors are configured. The RTT is smoothed like the TCP RTT
+ *    estimate (7/8 old value, 1/8 new sample).
+ *  - The healthy server with the lowest RTT is selected; on equal RTT the earlier one
+ *    in the list. A server is unhealthy after a failed probe or request until it
+ *    answers a probe or a connect again.
+ *  - If the selected server does not answer, the check fails over to the next server
+ *    not tried yet (healthy ones first). An interrupted download continues there with
+ *    an HTTP Range request from the last written byte; the image is checked against the
+ *    manifest loaded before the download (OTA_Verify.h).
+ *
+ * A server configured as "auto" is discovered by DNS-SD (OTA_Dns.h) at the start of a
+ * check; host names are resolved through the DNS cache, which forgets the address of a
+ * server that failed.
+ *
+ * The selection and the RTT of every server are shown on the configuration page and
+ * reported on /ota/status.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_MIRROR_H
+#define OTA_MIRROR_H
+
+#include <Arduino.h>
+
+#ifndef OTA_MIRROR_MAX
+#define OTA_MIRROR_MAX 4                   // OTA server and up to 3 mirrors
+#endif
+#ifndef OTA_MIRROR_PROBE_INTERVAL
+#define OTA_MIRROR_PROBE_INTERVAL 600000   // Min. time between two RTT probes (ms)
+#endif
+#ifndef OTA_MIRROR_PROBE_TIMEOUT
+#define OTA_MIRROR_PROBE_TIMEOUT 1000      // Connect timeout of a probe (ms)
+#endif
+
+#define OTA_MIRROR_NO_RTT ((uint32_t)-1)
+
+struct OTAMirror {
+  char host[32];
+  int port;
+  uint32_t rttMs;         // Smoothed RTT of the probes, OTA_MIRROR_NO_RTT = not measured
+  uint32_t failures;      // Failed probes and requests since boot
+  bool healthy;           // Last probe or request succeeded
+  bool discover;          // Configured as OTA_DNS_AUTO, host and port found by DNS-SD
+};
+
+struct OTAMirrorStats {
+  uint32_t probes;        // Probe rounds since boot
+  uint32_t failovers;     // Switches to the next server during a check
+  uint32_t resumed;       // Downloads continued on another server
+};
+
+/**
+ * Reads the server list from the configuration. Called by otaSetup().
+ */
+void mirrorBegin();
+
+/**
+ * Probes the servers if due and selects the fastest healthy one. Called at the start
+ * of an update check.
+ */
+void mirrorSelect();
+
+/**
+ * Returns the selected server.
+ */
+const OTAMirror &mirrorCurrent();
+
+/**
+ * Marks the selected server as failed, closes its connection and selects the best
+ * server not tried in this check.
+ * @return false if all servers have been tried
+ */
+bool mirrorFailover();
+
+/**
+ * Marks the selected server as healthy after a successful connect (OTA_Client.cpp).
+ */
+void mirrorConnected();
+
+/**
+ * Returns the number of servers and server i (0 = OTA server) of the list.
+ */
+uint8_t mirrorCount();
+const OTAMirror &mirrorAt(uint8_t i);
+
+/**
+ * Returns the index of the selected server.
+ */
+uint8_t mirrorIndex();
+
+/**
+ * Counts a download continued on another server.
+ */
+void mirrorResumed();
+
+/**
+ * Writes the server list as JSON array to buf, e.g.
+ * [{"host":"192.168.1.10","port":3000,"rttMs":4,"healthy":true,"failures":0,"discovered":false}].
+ * Returns false if buf is too small.
+ */
+bool mirrorListJson(char *buf, size_t size);
+
+/**
+ * Returns the mirror statistics of the current boot.
+ */
+const OTAMirrorStats &mirrorStats();
+
+#endif // OTA_MIRROR_H
@@ -0,0 +1,353 @@
+/**
+ * OTA_Multicast.cpp
+ *
+ * Implementation of the multicast carousel receiver (see OTA_Multicast.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Multicast.h"
+#include "OTA_Template.h"
+
+#if OTA_MCAST_ENABLED
+  #include <WiFi.h>
+  #include <WiFiUdp.h>
+  #include <HTTPClient.h>
+  #include <esp_ota_ops.h>
+#endif
+
+#define HEADER_SIZE 20
+#define TYPE_INFO 1        // Payload "<firmware name> <version> <sha256>"
+#define TYPE_DATA 2        // index: block number
+#define TYPE_PARITY 3      // index: group number, payload: XOR of the k blocks of the group
+#define TYPE_END 4         // index: pass number
+#define MAX_GROUP 32       // Max. k, the blocks of a group are tracked in a 32 bit mask
+#define REQUESTS 3         // Requests sent within OTA_MCAST_INFO_WAIT until the server answers
+#define REPAIR_MERGE 8     // Gaps closer than this (blocks) are loaded with one Range request
+
+static OTAMcastStats stats = { 0, 0, 0, 0, 0 };
+
+#if OTA_MCAST_ENABLED
+
+struct Reception {
+  const esp_partition_t *partition;
+  esp_ota_handle_t handle;
+  bool started;                      // esp_ota_begin() done, the image area is erased
+  bool failed;                       // Flash write error
+  uint32_t imageSize;
+  uint16_t blockSize;
+  uint32_t blocks;
+  uint32_t received;
+  int32_t group;                     // Group collected in parity, -1 = none
+  uint32_t groupSeen;                // Blocks of this group seen in the current pass
+};
+
+// Static buffers, the receiver needs no heap
+static WiFiUDP udp;
+static Reception rx;
+static uint8_t packet[HEADER_SIZE + OTA_MCAST_BLOCK];
+static uint8_t parity[OTA_MCAST_BLOCK];
+static uint8_t bitmap[(OTA_MCAST_MAX_BLOCKS + 7) / 8];
+
+static uint32_t be32(const uint8_t *p) {
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static bool hasBlock(uint32_t i) {
+  return bitmap[i >> 3] & (1 << (i & 7));
+}
+
+static uint32_t blockLength(uint32_t i) {
+  uint32_t offset = i * rx.blockSize;
+  return rx.imageSize - offset < rx.blockSize ? rx.imageSize - offset : rx.blockSize;
+}
+
+static bool writeBlock(uint32_t i, const uint8_t *data) {
+  if (esp_ota_write_with_offset(rx.handle, data, blockLength(i), i * rx.blockSize) != ESP_OK) {
+    rx.failed = true;
+    return false;
+  }
+  bitmap[i >> 3] |= 1 << (i & 7);
+  rx.received++;
+  return true;
+}
+
+/**
+ * Checks the announced image against the hash of the OTA server and erases the
+ * image area for the first pass.
+ */
+static bool handleInfo(const uint8_t *payload, size_t len, const uint8_t sha[OTA_SHA256_SIZE],
+                       uint32_t imageSize, uint16_t blockSize) {
+  char text[128];
+  char name[32];
+  char version[16];
+  char hex[OTA_SHA256_HEX_SIZE];
+  uint8_t digest[OTA_SHA256_SIZE];
+  if (len >= sizeof(text)) return false;
+  memcpy(text, payload, len);
+  text[len] = '\0';
+  if (sscanf(text, "%31s %15s %64s", name, version, hex) != 3 || strcmp(name, config.firmware_name) != 0 ||
+      !OTASha256::fromHex(hex, digest) || memcmp(digest, sha, OTA_SHA256_SIZE) != 0) {
+    return false;
+  }
+  if (rx.started) return imageSize == rx.imageSize && blockSize == rx.blockSize;
+  uint32_t blocks = blockSize ? (imageSize + blockSize - 1) / blockSize : 0;
+  rx.partition = esp_ota_get_next_update_partition(nullptr);
+  if (!blocks || blockSize > OTA_MCAST_BLOCK || blocks > OTA_MCAST_MAX_BLOCKS || !rx.partition ||
+      imageSize > rx.partition->size) {
+    Serial.printf("Multicast: image of %lu bytes in %u byte blocks not supported\n", (unsigned long)imageSize, blockSize);
+    return false;
+  }
+  if (esp_ota_begin(rx.partition, imageSize, &rx.handle) != ESP_OK) return false;
+  rx.started = true;
+  rx.imageSize = imageSize;
+  rx.blockSize = blockSize;
+  rx.blocks = blocks;
+  Serial.printf("Multicast: receiving version %s, %lu blocks\n", version, (unsigned long)blocks);
+  progressPhase(OTA_PHASE_DOWNLOADING, "multicast");
+  return true;
+}
+
+static void handleData(uint32_t index, uint8_t k, const uint8_t *payload, size_t len) {
+  if (index >= rx.blocks || len != blockLength(index)) return;
+  if (k >= 1 && k <= MAX_GROUP) {
+    int32_t group = index / k;
+    if (group != rx.group) {
+      memset(parity, 0, rx.blockSize);
+      rx.group = group;
+      rx.groupSeen = 0;
+    }
+    for (size_t i = 0; i < len; ++i) parity[i] ^= payload[i];
+    rx.groupSeen |= 1UL << (index % k);
+  }
+  if (!hasBlock(index)) writeBlock(index, payload);
+}
+
+/**
+ * Restores the block of a group that is still missing, if all other blocks of the
+ * group were seen in this pass: lost block = parity XOR the other blocks.
+ */
+static void handleParity(uint32_t group, uint8_t k, const uint8_t *payload, size_t len) {
+  if (k < 1 || k > MAX_GROUP || (int32_t)group != rx.group || len != rx.blockSize) return;
+  uint32_t first = group * k;
+  uint32_t count = rx.blocks - first < k ? rx.blocks - first : k;
+  uint32_t missing = 0;
+  uint32_t lost = 0;
+  for (uint32_t i = first; i < first + count; ++i) {
+    if (!hasBlock(i)) {
+      missing++;
+      lost = i;
+    }
+  }
+  uint32_t all = count == 32 ? 0xFFFFFFFFUL : (1UL << count) - 1;
+  rx.group = -1;
+  if (missing != 1 || rx.groupSeen != (all & ~(1UL << (lost - first)))) return;
+  for (size_t i = 0; i < len; ++i) parity[i] ^= payload[i];
+  if (writeBlock(lost, parity)) stats.recovered++;
+}
+
+static void sendRequest() {
+  char text[48];
+  snprintf(text, sizeof(text), "OTA1MR %s", config.firmware_name);
+  udp.beginPacket(IPAddress(OTA_MCAST_GROUP), OTA_MCAST_PORT);
+  udp.write((const uint8_t *)text, strlen(text));
+  udp.endPacket();
+}
+
+/**
+ * Requests a pass and receives it until its end, the image is complete or no packet
+ * arrives for OTA_MCAST_IDLE ms. Returns false if no pass was received.
+ */
+static bool receivePass(const uint8_t sha[OTA_SHA256_SIZE]) {
+  uint32_t session = be32(sha);
+  bool info = false;
+  bool data = false;
+  unsigned long wait = OTA_MCAST_INFO_WAIT / REQUESTS;
+  unsigned long last = millis();
+  uint8_t requests = 1;
+  rx.group = -1;
+  sendRequest();
+  while (!rx.failed) {
+    if (millis() - last >= wait) {
+      if (info || requests >= REQUESTS) break;
+      sendRequest(); // Request or answer lost
+      requests++;
+      last = millis();
+    }
+    int size = udp.parsePacket();
+    if (size <= 0) {
+      delay(1);
+      continue;
+    }
+    int n = udp.read(packet, sizeof(packet));
+    if (n < HEADER_SIZE || memcmp(packet, "OTAM", 4) != 0 || be32(packet + 8) != session) continue;
+    uint8_t type = packet[4];
+    uint8_t k = packet[5];
+    uint16_t blockSize = (uint16_t)(packet[6] << 8 | packet[7]);
+    uint32_t imageSize = be32(packet + 12);
+    uint32_t index = be32(packet + 16);
+    stats.packets++;
+    if (type == TYPE_INFO) {
+      if (!handleInfo(packet + HEADER_SIZE, n - HEADER_SIZE, sha, imageSize, blockSize)) return false;
+      if (!info) wait = OTA_MCAST_START_WAIT;
+      info = true;
+      last = millis();
+      continue;
+    }
+    if (!rx.started || blockSize != rx.blockSize || imageSize != rx.imageSize) continue;
+    last = millis();
+    if (type == TYPE_END) {
+      if (data) break;
+      continue; // End of a pass that was running before the request
+    }
+    data = true;
+    wait = OTA_MCAST_IDLE;
+    if (type == TYPE_DATA) handleData(index, k, packet + HEADER_SIZE, n - HEADER_SIZE);
+    else if (type == TYPE_PARITY) handleParity(index, k, packet + HEADER_SIZE, n - HEADER_SIZE);
+    progressUpdate(rx.received * rx.blockSize, rx.imageSize);
+    if (rx.received == rx.blocks) break;
+  }
+  if (data) stats.passes++;
+  return data;
+}
+
+/**
+ * Reads exactly len bytes from the stream.
+ */
+static bool readFull(WiFiClient *stream, uint8_t *buf, size_t len) {
+  size_t done = 0;
+  unsigned long last = millis();
+  while (done < len && millis() - last < OTA_MCAST_IDLE) {
+    int n = stream->read(buf + done, len - done);
+    if (n > 0) {
+      done += n;
+      last = millis();
+    } else if (!stream->connected() && !stream->available()) {
+      break;
+    } else {
+      delay(1);
+    }
+  }
+  return done == len;
+}
+
+/**
+ * Loads the blocks first .. first + count - 1 with an HTTP Range request. Blocks
+ * already received in between are skipped.
+ */
+static bool repairRange(const char *url, uint32_t first, uint32_t count) {
+  uint32_t from = first * rx.blockSize;
+  uint32_t to = from - 1;
+  for (uint32_t i = first; i < first + count; ++i) to += blockLength(i);
+  char range[40];
+  snprintf(range, sizeof(range), "bytes=%lu-%lu", (unsigned long)from, (unsigned long)to);
+  HTTPClient http;
+  if (!clientBegin(http, url)) return false;
+  http.addHeader("Range", range);
+  int code = http.GET();
+  bool ok = code == HTTP_CODE_PARTIAL_CONTENT;
+  for (uint32_t i = first; ok && i < first + count; ++i) {
+    ok = readFull(http.getStreamPtr(), packet, blockLength(i));
+    if (!ok || hasBlock(i)) continue;
+    ok = writeBlock(i, packet);
+    if (ok) stats.repaired++;
+  }
+  http.end();
+  if (!ok) Serial.printf("Multicast: repair of %s failed, HTTP code %d\n", range, code);
+  return ok;
+}
+
+/**
+ * Loads all missing blocks from the OTA server, one Range request per gap (or per
+ * group of gaps closer than REPAIR_MERGE blocks).
+ */
+static bool repair() {
+  char url[128];
+  if (!otaFirmwareUrl(url, sizeof(url))) return false;
+  for (uint32_t i = 0; i < rx.blocks;) {
+    if (hasBlock(i)) {
+      ++i;
+      continue;
+    }
+    uint32_t first = i;
+    uint32_t end = i + 1;
+    for (; i < rx.blocks && i < end + REPAIR_MERGE; ++i) {
+      if (!hasBlock(i)) end = i + 1;
+    }
+    if (!repairRange(url, first, end - first)) return false;
+    i = end;
+  }
+  return true;
+}
+
+/**
+ * Hashes the written image in the update partition.
+ */
+static bool verify(const uint8_t sha[OTA_SHA256_SIZE]) {
+  OTASha256 hash;
+  for (uint32_t offset = 0; offset < rx.imageSize; offset += rx.blockSize) {
+    uint32_t n = rx.imageSize - offset < rx.blockSize ? rx.imageSize - offset : rx.blockSize;
+    if (esp_partition_read(rx.partition, offset, packet, n) != ESP_OK) return false;
+    hash.update(packet, n);
+    yield();
+  }
+  uint8_t digest[OTA_SHA256_SIZE];
+  hash.finish(digest);
+  return memcmp(digest, sha, OTA_SHA256_SIZE) == 0;
+}
+
+#endif // OTA_MCAST_ENABLED
+
+bool mcastUpdate(const char *version) {
+#if OTA_MCAST_ENABLED
+  uint8_t sha[OTA_SHA256_SIZE];
+  if (!otaImageHash(sha)) return false;
+  if (!udp.beginMulticast(IPAddress(OTA_MCAST_GROUP), OTA_MCAST_PORT)) return false;
+  memset(&rx, 0, sizeof(rx));
+  memset(bitmap, 0, sizeof(bitmap));
+  for (uint8_t pass = 0; pass < OTA_MCAST_PASSES; ++pass) {
+    if (!receivePass(sha) || rx.failed || rx.received == rx.blocks) break;
+    // Few gaps are repaired by unicast, many by another pass
+    if ((rx.blocks - rx.received) * 100 <= rx.blocks * OTA_MCAST_REPAIR) break;
+  }
+  udp.stop(); // Leaves the group, the carousel of other devices does not reach this one anymore
+  if (!rx.started) {
+    Serial.println("Multicast: no carousel for this firmware, unicast download.");
+    return false;
+  }
+  Serial.printf("Multicast: %lu of %lu blocks received, %lu restored from parity\n", (unsigned long)rx.received,
+                (unsigned long)rx.blocks, (unsigned long)stats.recovered);
+  if (rx.failed || (rx.received < rx.blocks && !repair()) || !verify(sha)) {
+    Serial.printf("Multicast: image of version %s incomplete or not verified, unicast download.\n", version);
+    esp_ota_abort(rx.handle);
+    return false;
+  }
+  if (esp_ota_end(rx.handle) != ESP_OK || esp_ota_set_boot_partition(rx.partition) != ESP_OK) {
+    Serial.println("Multicast: image not accepted by the bootloader.");
+    return false;
+  }
+  stats.updates++;
+  return true;
+#else
+  return false;
+#endif
+}
+
+const OTAMcastStats &mcastStats() {
+  return stats;
+}
@@ -0,0 +1,105 @@
+/**
+ * OTA_Multicast.h
+ *
+ * Multicast distribution of firmware images for the OTA Template.
+ * With many identical devices at one site, unicast downloads send the same image
+ * once per device. In multicast mode the OTA server sends the image once for all
+ * devices as a carousel of numbered blocks on OTA_MCAST_GROUP:OTA_MCAST_PORT.
+ *
+ * A device that finds a newer version asks the server for a carousel pass
+ * ("OTA1MR <firmware name>"). The server answers with an INFO packet (image size and
+ * SHA-256) and starts the pass a few seconds later, so all devices triggered by the
+ * same update beacon receive the same pass. Every group of k data blocks is followed
+ * by an XOR parity block, which restores one lost block per group (forward error
+ * correction). Received blocks are written directly to their offset in the update
+ * partition, a bitmap tracks the missing ones. Blocks still missing after the pass
+ * are requested again in another pass (many missing) or loaded from the OTA server
+ * with HTTP Range requests (few missing). The image is activated only if the SHA-256
+ * of the written partition matches the hash reported by the OTA server.
+ *
+ * Packet format (big-endian): "OTAM", type, k, block size (16 bit), session (first
+ * 32 bit of the SHA-256), image size, index (block, group or pass), payload.
+ *
+ * Writing blocks at any offset needs the OTA API of ESP-IDF (esp_ota_write_with_offset),
+ * so multicast reception is available on the ESP32 (and the native build) only; the
+ * ESP8266 loads updates by unicast.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_MULTICAST_H
+#define OTA_MULTICAST_H
+
+#include <Arduino.h>
+
+#ifndef OTA_MCAST_ENABLED
+#if defined(ESP32)
+#define OTA_MCAST_ENABLED 1                // 1: receive updates from the multicast carousel
+#else
+#define OTA_MCAST_ENABLED 0
+#endif
+#endif
+#ifndef OTA_MCAST_PORT
+#define OTA_MCAST_PORT 3003                // UDP port of the carousel
+#endif
+#ifndef OTA_MCAST_GROUP
+#define OTA_MCAST_GROUP 239, 255, 0, 89    // Multicast group of the carousel, joined only while receiving
+#endif
+#ifndef OTA_MCAST_BLOCK
+#define OTA_MCAST_BLOCK 1024               // Max. block size accepted (bytes)
+#endif
+#ifndef OTA_MCAST_MAX_BLOCKS
+#define OTA_MCAST_MAX_BLOCKS 4096          // Max. image size in blocks (bitmap: MAX_BLOCKS / 8 bytes)
+#endif
+#ifndef OTA_MCAST_INFO_WAIT
+#define OTA_MCAST_INFO_WAIT 1000           // Time for the server to answer a request (ms)
+#endif
+#ifndef OTA_MCAST_START_WAIT
+#define OTA_MCAST_START_WAIT 20000         // Max. time until the pass starts (ms)
+#endif
+#ifndef OTA_MCAST_IDLE
+#define OTA_MCAST_IDLE 2000                // No packet for this time: pass ended (ms)
+#endif
+#ifndef OTA_MCAST_PASSES
+#define OTA_MCAST_PASSES 3                 // Max. passes requested per update
+#endif
+#ifndef OTA_MCAST_REPAIR
+#define OTA_MCAST_REPAIR 20                // Repair by HTTP Range up to this share of missing blocks (%)
+#endif
+
+struct OTAMcastStats {
+  uint32_t updates;       // Updates installed from the carousel
+  uint32_t packets;       // Carousel packets received since boot
+  uint32_t recovered;     // Blocks restored from parity
+  uint32_t repaired;      // Blocks loaded by HTTP Range requests
+  uint32_t passes;        // Passes received
+};
+
+/**
+ * Receives version from the multicast carousel into the update partition and
+ * activates it. Called by performOTAUpdate() before the unicast download.
+ * @return true if the image was verified and set as boot partition (restart required)
+ */
+bool mcastUpdate(const char *version);
+
+/**
+ * Returns the multicast statistics of the current boot.
+ */
+const OTAMcastStats &mcastStats();
+
+#endif // OTA_MULTICAST_H
@@ -0,0 +1,132 @@
+/**
+ * OTA_Notify.cpp
+ *
+ * Implementation of the update beacon listener (see OTA_Notify.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Notify.h"
+#include "OTA_Template.h"
+#include "OTA_Platform.h"
+
+#define MAX_PACKETS_PER_LOOP 4
+
+static WiFiUDP udp;
+static bool listening = false;
+static OTANotifyStats stats = { 0, 0, 0, "" };
+static char triggered[16] = "";           // Version that triggered the last check
+static bool pending = false;
+static unsigned long dueAt = 0;
+static unsigned long retryDelay = OTA_NOTIFY_RETRY; // Delay of the next retry of a failed check
+
+void notifyBegin() {
+#if OTA_NOTIFY_ENABLED
+  IPAddress group(OTA_NOTIFY_GROUP);
+  listening = OTAPlatform::udpBeginMulticast(udp, group, OTA_NOTIFY_PORT);
+  if (listening) Serial.printf("Listening for update beacons on %s:%d\n", group.toString().c_str(), OTA_NOTIFY_PORT);
+  else Serial.println("Update beacons not available, polling only.");
+#endif
+}
+
+/**
+ * Versions are limited to [0-9A-Za-z.-]: beacons are not authenticated and the
+ * announced version is shown in /ota/status.
+ */
+static bool validVersion(const char *version) {
+  for (const char *p = version; *p; ++p) {
+    if (!isalnum((unsigned char)*p) && *p != '.' && *p != '-') return false;
+  }
+  return true;
+}
+
+/**
+ * Handles one beacon "OTA1 <firmware name> <version>".
+ */
+static void handleBeacon(const char *text) {
+  char name[32];
+  char version[16];
+  if (sscanf(text, "OTA1 %31s %15s", name, version) != 2 || !validVersion(version)) return;
+  stats.beacons++;
+  stats.lastBeacon = millis();
+  if (stats.lastBeacon == 0) stats.lastBeacon = 1;
+  if (strcmp(name, config.firmware_name) != 0) return;
+  strcpy(stats.announced, version);
+  // Each newer version triggers once; the check itself decides about the update
+  if (compareVersion(version, config.firmware_vers) <= 0 || strcmp(version, triggered) == 0) return;
+  strcpy(triggered, version);
+  pending = true;
+  dueAt = millis() + random(OTA_NOTIFY_SPREAD + 1);
+  stats.triggers++;
+  Serial.printf("Update beacon: version %s announced, checking in %lu ms\n", version, dueAt - millis());
+}
+
+void notifyLoop() {
+  if (!listening) return;
+  for (uint8_t i = 0; i < MAX_PACKETS_PER_LOOP; ++i) {
+    int size = udp.parsePacket();
+    if (size <= 0) break;
+    char text[64];
+    int n = udp.read((uint8_t *)text, sizeof(text) - 1);
+    if (n <= 0) continue;
+    text[n] = '\0';
+    handleBeacon(text);
+  }
+}
+
+bool notifyAlive() {
+  return stats.lastBeacon != 0 && millis() - stats.lastBeacon < OTA_NOTIFY_SILENCE;
+}
+
+unsigned long notifyPollInterval(unsigned long intervalMs) {
+  if (!notifyAlive()) return intervalMs;
+  if (intervalMs > OTA_NOTIFY_NONE / 2 / OTA_NOTIFY_POLL_FACTOR) return OTA_NOTIFY_NONE / 2;
+  return intervalMs * OTA_NOTIFY_POLL_FACTOR;
+}
+
+unsigned long notifyUntilCheck() {
+  if (!pending) return OTA_NOTIFY_NONE;
+  long left = (long)(dueAt - millis());
+  return left > 0 ? (unsigned long)left : 0;
+}
+
+void notifyCheckDone() {
+  pending = false;
+}
+
+void notifyCheckResult(bool ok) {
+  if (ok) {
+    retryDelay = OTA_NOTIFY_RETRY;
+    return;
+  }
+  // Without beacons the configured interval applies; a check scheduled by the update
+  // itself (waiting for a peer) is kept
+  if (!notifyAlive() || pending) return;
+  notifyScheduleCheck(retryDelay + random(OTA_NOTIFY_SPREAD + 1));
+  Serial.printf("OTA check failed, retrying in %lu s\n", (dueAt - millis()) / 1000);
+  retryDelay = retryDelay < OTA_NOTIFY_RETRY_MAX / 2 ? retryDelay * 2 : OTA_NOTIFY_RETRY_MAX;
+}
+
+void notifyScheduleCheck(unsigned long ms) {
+  pending = true;
+  dueAt = millis() + ms;
+}
+
+const OTANotifyStats &notifyStats() {
+  return stats;
+}
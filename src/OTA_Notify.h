@@ -0,0 +1,131 @@
+/**
+ * OTA_Notify.h
+ *
+ * Push notification of updates for the OTA Template.
+ * The OTA server announces the current version of every firmware as a small UDP
+ * multicast beacon ("OTA1 <firmware name> <version>") every 30 s and right after a
+ * new version has been placed in its updates directory. The device listens for these
+ * beacons; when a newer version of its firmware is announced, the OTA check runs
+ * within seconds (after a random delay of up to OTA_NOTIFY_SPREAD ms, so a fleet
+ * does not hit the server at the same moment).
+ *
+ * While beacons arrive the server is polled only every OTA_NOTIFY_POLL_FACTOR times
+ * the configured update interval, as safety net. If no beacon has been received for
+ * OTA_NOTIFY_SILENCE ms (no beacon sender on the network, multicast filtered, deep
+ * sleep) the device falls back to polling with the configured interval.
+ *
+ * A beacon only triggers a version check against the configured OTA server, and each
+ * announced version triggers at most once, so spoofed beacons cannot cause more than
+ * one additional check per version. Beacons with a version of other characters than
+ * [0-9A-Za-z.-] are ignored. A check that fails while beacons arrive (server
+ * or mirror not reachable, download error) is repeated after OTA_NOTIFY_RETRY ms,
+ * doubled after each further failure up to OTA_NOTIFY_RETRY_MAX, instead of waiting
+ * for the long poll interval.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_NOTIFY_H
+#define OTA_NOTIFY_H
+
+#include <Arduino.h>
+
+#ifndef OTA_NOTIFY_ENABLED
+#define OTA_NOTIFY_ENABLED 1               // 1: listen for update beacons of the OTA server
+#endif
+#ifndef OTA_NOTIFY_PORT
+#define OTA_NOTIFY_PORT 3001               // UDP port of the update beacons
+#endif
+#ifndef OTA_NOTIFY_GROUP
+#define OTA_NOTIFY_GROUP 239, 255, 0, 88   // Multicast group of the update beacons
+#endif
+#ifndef OTA_NOTIFY_SILENCE
+#define OTA_NOTIFY_SILENCE 90000           // No beacon for this time (ms): fall back to polling
+#endif
+#ifndef OTA_NOTIFY_POLL_FACTOR
+#define OTA_NOTIFY_POLL_FACTOR 24          // While beacons arrive: poll every factor * otaUpdateInterval
+#endif
+#ifndef OTA_NOTIFY_SPREAD
+#define OTA_NOTIFY_SPREAD 5000             // Max. random delay of the check after an announcement (ms)
+#endif
+#ifndef OTA_NOTIFY_RETRY
+#define OTA_NOTIFY_RETRY 60000             // First retry of a failed check while beacons arrive (ms)
+#endif
+#ifndef OTA_NOTIFY_RETRY_MAX
+#define OTA_NOTIFY_RETRY_MAX 1800000       // Max. retry delay, doubled after each failure (ms)
+#endif
+
+#define OTA_NOTIFY_NONE ((unsigned long)-1)
+
+struct OTANotifyStats {
+  uint32_t beacons;              // Beacons received since boot
+  uint32_t triggers;             // OTA checks triggered by announcements
+  unsigned long lastBeacon;      // millis() of the last beacon, 0 = none yet
+  char announced[16];            // Last announced version of this firmware
+};
+
+/**
+ * Starts listening for update beacons. Called by otaSetup() after the WiFi connect.
+ */
+void notifyBegin();
+
+/**
+ * Reads received beacons. Called by otaLoop().
+ */
+void notifyLoop();
+
+/**
+ * Returns true while beacons arrive (the last one is younger than OTA_NOTIFY_SILENCE).
+ */
+bool notifyAlive();
+
+/**
+ * Returns the poll interval to use instead of intervalMs: longer while beacons arrive.
+ */
+unsigned long notifyPollInterval(unsigned long intervalMs);
+
+/**
+ * Returns the time in ms until an announced OTA check is due, 0 if it is due now,
+ * OTA_NOTIFY_NONE if no check has been announced.
+ */
+unsigned long notifyUntilCheck();
+
+/**
+ * Clears an announced check. Called by otaLoop() before performOTAUpdate().
+ */
+void notifyCheckDone();
+
+/**
+ * Reports the outcome of an OTA check. Called by otaLoop() after performOTAUpdate():
+ * ok is true if the firmware is up to date or the update was installed. A failed
+ * check is retried with backoff while beacons arrive.
+ */
+void notifyCheckResult(bool ok);
+
+/**
+ * Schedules an additional OTA check in ms milliseconds, e.g. while an update
+ * waits for a peer on the LAN (OTA_Peer.h).
+ */
+void notifyScheduleCheck(unsigned long ms);
+
+/**
+ * Returns the beacon statistics of the current boot.
+ */
+const OTANotifyStats &notifyStats();
+
+#endif // OTA_NOTIFY_H
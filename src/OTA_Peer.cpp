@@ -0,0 +1,339 @@
+/**
+ * OTA_Peer.cpp
+ *
+ * Implementation of the firmware distribution between peers (see OTA_Peer.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Peer.h"
+#include "OTA_Template.h"
+#include "OTA_Platform.h"
+#if defined(ESP32)
+  #include <esp_ota_ops.h>   // Reading the running partition (readImage())
+#endif
+
+#define MAX_PACKETS_PER_LOOP 4
+#define CHUNK_SIZE 1024              // Bytes per flash read
+#define SERVE_CHUNK 256              // Bytes per flash read while serving, at most one filler call
+#define ANSWER_INTERVAL 1000         // Min. time between two answers to queries (ms)
+
+struct Peer {
+  IPAddress ip;
+  uint16_t port;                     // Web server port of the peer
+  uint8_t sha[OTA_SHA256_SIZE];      // Hash of the announced image
+  unsigned long seen;                // millis() of the last announcement, 0 = free slot
+  bool rejected;                     // Delivered an image that did not match, ignored until it announces another one
+};
+
+static WiFiUDP udp;
+static bool listening = false;
+static Peer peers[OTA_PEER_MAX];
+static OTAPeerStats stats = { 0, 0, 0, 0, "" };
+#if OTA_PEER_SERVE
+static uint32_t imageSize = 0;       // Size of the served image, 0 = not serving
+static unsigned long lastAnnounce = 0;
+static unsigned long nextAnnounce = 0;
+static unsigned long lastAnswer = 0;
+#endif
+static char waitVersion[16] = "";    // Version that waits for a peer
+static unsigned long waitUntil = 0;
+
+static bool peerAlive(const Peer &p) {
+  return p.seen != 0 && millis() - p.seen < 3UL * OTA_PEER_INTERVAL;
+}
+
+static void sendPacket(const char *text) {
+  IPAddress group(OTA_PEER_GROUP);
+  OTAPlatform::udpBeginPacketMulticast(udp, group, OTA_PEER_PORT);
+  udp.write((const uint8_t *)text, strlen(text));
+  udp.endPacket();
+}
+
+#if OTA_PEER_SERVE
+
+/**
+ * Reads len bytes of the running image. buf must be 4 byte aligned (ESP8266 flash reads).
+ */
+static bool readImage(uint32_t offset, uint32_t *buf, size_t len) {
+#if defined(ESP8266)
+  return ESP.flashRead(offset, buf, (len + 3) & ~3);
+#elif defined(ESP32)
+  return esp_partition_read(esp_ota_get_running_partition(), offset, buf, len) == ESP_OK;
+#endif
+}
+
+/**
+ * Hashes the running image once at boot, the served image cannot change until the next restart.
+ */
+static void hashImage() {
+  uint32_t size = ESP.getSketchSize();
+  if (size == 0) return;
+  uint32_t buf[CHUNK_SIZE / 4];
+  OTASha256 hash;
+  for (uint32_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+    size_t n = size - offset < CHUNK_SIZE ? size - offset : CHUNK_SIZE;
+    if (!readImage(offset, buf, n)) {
+      Serial.println("Peer: running image not readable, not serving.");
+      return;
+    }
+    hash.update((const uint8_t *)buf, n);
+    yield();
+  }
+  uint8_t digest[OTA_SHA256_SIZE];
+  hash.finish(digest);
+  OTASha256::toHex(digest, stats.imageHash);
+  imageSize = size;
+  Serial.printf("Peer: serving %u bytes on %s, sha256 %s\n", (unsigned)size, OTA_PEER_IMAGE_PATH, stats.imageHash);
+}
+
+/**
+ * Handler of OTA_PEER_IMAGE_PATH. The web server pulls the running image in parts as the
+ * connection takes them, a transfer does not block the loop. The offsets stay 4 byte
+ * aligned for the flash reads, only the last part may be shorter.
+ */
+static void handleImage() {
+  IPAddress ip = server.client().remoteIP();
+  server.sendHeader("X-Image-SHA256", stats.imageHash);
+  sendContentFiller(200, "application/octet-stream", imageSize, [ip](char *buf, size_t size, size_t offset) -> size_t {
+    uint32_t chunk[SERVE_CHUNK / 4];
+    size_t n = imageSize - offset;
+    if (n > size) n = size & ~(size_t)3;
+    if (n > sizeof(chunk)) n = sizeof(chunk);
+    if (n == 0 || !readImage(offset, chunk, n)) return 0;
+    memcpy(buf, chunk, n);
+    if (offset + n == imageSize) {
+      stats.served++;
+      Serial.printf("Peer: image sent to %s\n", ip.toString().c_str());
+    }
+    return n;
+  });
+}
+
+static void announce() {
+  char text[128];
+  snprintf(text, sizeof(text), "OTA1P %s %s %d %s", config.firmware_name, config.firmware_vers,
+           config.webServerPort, stats.imageHash);
+  sendPacket(text);
+  lastAnnounce = millis();
+  nextAnnounce = OTA_PEER_INTERVAL + random(OTA_PEER_INTERVAL / 10); // Jitter keeps a fleet apart
+}
+
+#endif // OTA_PEER_SERVE
+
+void peerBegin() {
+#if OTA_PEER_ENABLED || OTA_PEER_SERVE
+#if OTA_PEER_SERVE
+  hashImage();
+  if (imageSize) routerAdd(OTA_PEER_IMAGE_PATH, OTA_METHOD(HTTP_GET), handleImage);
+#endif
+  IPAddress group(OTA_PEER_GROUP);
+  listening = OTAPlatform::udpBeginMulticast(udp, group, OTA_PEER_PORT);
+  if (!listening) {
+    Serial.println("Peer announcements not available, updates from the OTA server only.");
+    return;
+  }
+#if OTA_PEER_ENABLED
+  // Ask the serving peers to announce themselves, so the first OTA check already knows them
+  char text[48];
+  snprintf(text, sizeof(text), "OTA1Q %s", config.firmware_name);
+  sendPacket(text);
+  unsigned long start = millis();
+  while (millis() - start < OTA_PEER_QUERY_WAIT) {
+    peerLoop();
+    delay(10);
+  }
+#endif
+#if OTA_PEER_SERVE
+  if (imageSize) announce();
+#endif
+#endif
+}
+
+/**
+ * Stores an announcement "OTA1P <firmware name> <version> <port> <sha256>".
+ */
+static void handleAnnouncement(const char *text, IPAddress ip) {
+  char name[32];
+  char version[16];
+  unsigned port;
+  char hex[OTA_SHA256_HEX_SIZE];
+  if (sscanf(text, "OTA1P %31s %15s %u %64s", name, version, &port, hex) != 4) return;
+  if (strcmp(name, config.firmware_name) != 0) return;
+  if (ip == WiFi.localIP() && port == (unsigned)config.webServerPort) return; // Own announcement
+  uint8_t sha[OTA_SHA256_SIZE];
+  if (port == 0 || port > 65535 || !OTASha256::fromHex(hex, sha)) return;
+  // Same peer, else a free or expired slot, else the peer heard least recently
+  Peer *slot = nullptr;
+  for (uint8_t i = 0; i < OTA_PEER_MAX && !slot; ++i) {
+    if (peers[i].seen != 0 && peers[i].ip == ip && peers[i].port == port) slot = &peers[i];
+  }
+  bool known = slot != nullptr;
+  for (uint8_t i = 0; i < OTA_PEER_MAX && !slot; ++i) {
+    if (!peerAlive(peers[i])) slot = &peers[i];
+  }
+  if (!slot) {
+    slot = &peers[0];
+    for (uint8_t i = 1; i < OTA_PEER_MAX; ++i) {
+      if (millis() - peers[i].seen > millis() - slot->seen) slot = &peers[i];
+    }
+  }
+  if (!known || memcmp(slot->sha, sha, sizeof(sha)) != 0) slot->rejected = false;
+  slot->ip = ip;
+  slot->port = (uint16_t)port;
+  memcpy(slot->sha, sha, sizeof(sha));
+  slot->seen = millis();
+  if (slot->seen == 0) slot->seen = 1;
+}
+
+void peerLoop() {
+  if (!listening) return;
+  for (uint8_t i = 0; i < MAX_PACKETS_PER_LOOP; ++i) {
+    int size = udp.parsePacket();
+    if (size <= 0) break;
+    char text[160];
+    int n = udp.read((uint8_t *)text, sizeof(text) - 1);
+    if (n <= 0) continue;
+    text[n] = '\0';
+    if (strncmp(text, "OTA1P ", 6) == 0) {
+      handleAnnouncement(text, udp.remoteIP());
+    }
+#if OTA_PEER_SERVE
+    else if (strncmp(text, "OTA1Q ", 6) == 0 && imageSize && strcmp(text + 6, config.firmware_name) == 0 &&
+             millis() - lastAnswer > ANSWER_INTERVAL) {
+      lastAnswer = millis();
+      announce();
+    }
+#endif
+  }
+#if OTA_PEER_SERVE
+  if (imageSize) {
+    unsigned long elapsed = millis() - lastAnnounce;
+    if (elapsed >= nextAnnounce) announce();
+    else powerWakeIn(nextAnnounce - elapsed);
+  }
+#endif
+}
+
+#if OTA_PEER_ENABLED
+
+/**
+ * Returns the TCP connect time to a peer in microseconds, 0xFFFFFFFF if not reachable.
+ */
+static uint32_t connectTime(const Peer &p) {
+  WiFiClient probe;
+  unsigned long start = micros();
+  if (!probe.connect(p.ip, p.port)) return 0xFFFFFFFFUL;
+  uint32_t us = micros() - start;
+  probe.stop();
+  return us;
+}
+
+/**
+ * Downloads the image of a peer into the update partition. The image is hashed while
+ * it is written and only committed if the hash matches (OTA_Verify.h).
+ */
+static bool installFrom(Peer &p, const uint8_t sha[OTA_SHA256_SIZE]) {
+  char url[64];
+  snprintf(url, sizeof(url), "http://%s:%u%s", p.ip.toString().c_str(), p.port, OTA_PEER_IMAGE_PATH);
+  Serial.printf("Peer: loading update from %s\n", url);
+  WiFiClient peerClient;
+  HTTPClient http;
+  if (!http.begin(peerClient, url)) return false;
+  int code = http.GET();
+  int size = http.getSize();
+  if (code != HTTP_CODE_OK || size <= 0 || !Update.begin(size)) {
+    Serial.printf("Peer: download not possible, HTTP code %d, size %d\n", code, size);
+    http.end();
+    return false;
+  }
+  progressPhase(OTA_PHASE_DOWNLOADING, p.ip.toString().c_str());
+  OTAInstallResult result = verifyInstall(http.getStreamPtr(), size, sha, OTA_PEER_TIMEOUT);
+  http.end();
+  if (result == OTA_INSTALL_REJECTED) {
+    Serial.printf("Peer: image of %s rejected\n", p.ip.toString().c_str());
+    p.rejected = true;
+    stats.rejected++;
+  }
+  return result == OTA_INSTALL_OK;
+}
+
+#endif // OTA_PEER_ENABLED
+
+OTAPeerResult peerUpdate(const char *version) {
+#if OTA_PEER_ENABLED
+  if (!listening) return OTA_PEER_ORIGIN;
+  uint8_t sha[OTA_SHA256_SIZE];
+  if (!otaImageHash(sha)) {
+    Serial.println("Peer: OTA server provides no image hash, peers not used.");
+    return OTA_PEER_ORIGIN;
+  }
+
+  // Peers with the verified image, nearest (fastest connect) first
+  uint8_t order[OTA_PEER_MAX];
+  uint32_t rtt[OTA_PEER_MAX];
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < OTA_PEER_MAX; ++i) {
+    if (!peerAlive(peers[i]) || peers[i].rejected) continue;
+    if (memcmp(peers[i].sha, sha, OTA_SHA256_SIZE) != 0) continue;
+    uint32_t us = connectTime(peers[i]);
+    if (us == 0xFFFFFFFFUL) continue;
+    uint8_t k = count++;
+    for (; k > 0 && rtt[k - 1] > us; --k) {
+      order[k] = order[k - 1];
+      rtt[k] = rtt[k - 1];
+    }
+    order[k] = i;
+    rtt[k] = us;
+  }
+  for (uint8_t k = 0; k < count; ++k) {
+    Serial.printf("Peer: %s:%u has version %s, connect %lu us\n", peers[order[k]].ip.toString().c_str(),
+                  peers[order[k]].port, version, (unsigned long)rtt[k]);
+    if (installFrom(peers[order[k]], sha)) {
+      stats.installs++;
+      return OTA_PEER_INSTALLED;
+    }
+  }
+  bool anyPeer = false;
+  for (uint8_t i = 0; i < OTA_PEER_MAX; ++i) {
+    if (peerAlive(peers[i]) && !peers[i].rejected) anyPeer = true;
+  }
+  if (!anyPeer) return OTA_PEER_ORIGIN;
+
+  // Peers exist but none has the image yet: wait a random time, another device is likely faster
+  if (strcmp(waitVersion, version) != 0) {
+    strncpy(waitVersion, version, sizeof(waitVersion) - 1);
+    waitUntil = millis() + random(OTA_PEER_WAIT + 1);
+  }
+  long left = (long)(waitUntil - millis());
+  if (left <= 0) return OTA_PEER_ORIGIN;
+  Serial.printf("Peer: no peer has version %s yet, waiting up to %ld ms\n", version, left);
+  notifyScheduleCheck(left < OTA_PEER_RETRY ? (unsigned long)left : OTA_PEER_RETRY);
+  return OTA_PEER_DEFERRED;
+#else
+  return OTA_PEER_ORIGIN;
+#endif
+}
+
+const OTAPeerStats &peerStats() {
+  stats.peers = 0;
+  for (uint8_t i = 0; i < OTA_PEER_MAX; ++i) {
+    if (peerAlive(peers[i])) stats.peers++;
+  }
+  return stats;
+}
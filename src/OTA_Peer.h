@@ -0,0 +1,119 @@
+/**
+ * OTA_Peer.h
+ *
+ * Firmware distribution between devices on the LAN for the OTA Template.
+ * A device that runs a firmware can serve its own image on OTA_PEER_IMAGE_PATH
+ * (OTA_PEER_SERVE) and announces it as UDP multicast "OTA1P <firmware name> <version>
+ * <web server port> <sha256>" every OTA_PEER_INTERVAL ms. Devices that find a newer
+ * version on the OTA server take the SHA-256 of the image from its manifest
+ * (OTA_Verify.h, or GET /hash/<firmware name>), then download it from the nearest peer (lowest TCP
+ * connect time) that announces this hash. The image is hashed while it is written;
+ * Update.end() is only called if the hash matches, otherwise the next peer or the
+ * OTA server is used. A peer can therefore never install anything the OTA server
+ * does not offer.
+ *
+ * If peers are on the network but none has the new version yet, the download from
+ * the OTA server is deferred by a random time of up to OTA_PEER_WAIT ms, so usually
+ * only the first device of a fleet loads the image from the server and the others
+ * get it from the LAN.
+ *
+ * On the ESP8266 the installer adapts the flash mode bytes of the image header, so
+ * the served image may differ from the server file; peers then reject it and load
+ * from the OTA server.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_PEER_H
+#define OTA_PEER_H
+
+#include <Arduino.h>
+#include "OTA_Notify.h"
+#include "OTA_Sha256.h"
+
+#ifndef OTA_PEER_ENABLED
+#define OTA_PEER_ENABLED 1                 // 1: load updates from peers on the LAN if they have them
+#endif
+#ifndef OTA_PEER_SERVE
+#define OTA_PEER_SERVE 0                   // 1: serve the own image to peers and announce it
+#endif
+#ifndef OTA_PEER_PORT
+#define OTA_PEER_PORT 3002                 // UDP port of the peer announcements
+#endif
+#ifndef OTA_PEER_GROUP
+#define OTA_PEER_GROUP OTA_NOTIFY_GROUP    // Multicast group of the peer announcements
+#endif
+#ifndef OTA_PEER_INTERVAL
+#define OTA_PEER_INTERVAL 30000            // Announcement interval of a serving device (ms)
+#endif
+#ifndef OTA_PEER_MAX
+#define OTA_PEER_MAX 8                     // Max. number of known peers
+#endif
+#ifndef OTA_PEER_WAIT
+#define OTA_PEER_WAIT 60000                // Max. random wait for a peer before loading from the server (ms)
+#endif
+#ifndef OTA_PEER_RETRY
+#define OTA_PEER_RETRY 5000                // Check for a peer every ... ms while waiting
+#endif
+#ifndef OTA_PEER_QUERY_WAIT
+#define OTA_PEER_QUERY_WAIT 300            // Time to collect answers to the query at boot (ms)
+#endif
+#ifndef OTA_PEER_TIMEOUT
+#define OTA_PEER_TIMEOUT 5000              // Max. time without data during a peer download (ms)
+#endif
+
+#define OTA_PEER_IMAGE_PATH "/ota/image"   // Running image of a serving device
+
+enum OTAPeerResult : uint8_t {
+  OTA_PEER_ORIGIN,        // No peer could deliver, load from the OTA server
+  OTA_PEER_DEFERRED,      // Waiting for a peer, a check is scheduled (notifyScheduleCheck())
+  OTA_PEER_INSTALLED      // Image from a peer verified and installed, restart required
+};
+
+struct OTAPeerStats {
+  uint8_t peers;          // Currently known peers
+  uint32_t served;        // Images served to peers since boot
+  uint32_t installs;      // Updates installed from a peer
+  uint32_t rejected;      // Peer downloads rejected (hash mismatch, incomplete)
+  char imageHash[OTA_SHA256_HEX_SIZE]; // SHA-256 of the served image, "" if not serving
+};
+
+/**
+ * Hashes the running image (OTA_PEER_SERVE), registers OTA_PEER_IMAGE_PATH, starts
+ * listening for announcements and asks the peers on the LAN to announce themselves.
+ * Called by otaSetup() after startWebServer().
+ */
+void peerBegin();
+
+/**
+ * Reads announcements and queries, sends the periodic announcement. Called by otaLoop().
+ */
+void peerLoop();
+
+/**
+ * Tries to install version from a peer. Called by performOTAUpdate() before the
+ * download from the OTA server.
+ */
+OTAPeerResult peerUpdate(const char *version);
+
+/**
+ * Returns the peer statistics of the current boot.
+ */
+const OTAPeerStats &peerStats();
+
+#endif // OTA_PEER_H
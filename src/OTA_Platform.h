@@ -0,0 +1,152 @@
+/**
+ * OTA_Platform.h
+ *
+ * Platform layer of the OTA Template. The differences between the ESP8266 and the ESP32
+ * core (EEPROM handling, web server class, UDP multicast, TCP connect timeout, writes
+ * that never block, aborting an update, heap figures) are collected in one traits class
+ * per platform:
+ *
+ *  - OTAPlatformTraits<Tag> is only declared, the specialisation of the target is
+ *    defined below; on any other platform the build fails here instead of in a module
+ *  - OTAPlatform is the traits class of the target, e.g. OTAPlatform::eepromBegin()
+ *  - all members are static inline, so the modules call the core directly and
+ *    nothing of the other platform is compiled into the image
+ *
+ * The native build (OTA_NATIVE, lib/ArduinoHostShim) uses the ESP32 traits.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_PLATFORM_H
+#define OTA_PLATFORM_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#if defined(ESP8266)
+  #include <ESP8266WiFi.h>
+  #include <ESP8266HTTPClient.h>
+  #include <ESP8266WebServer.h>
+  #include <WiFiUdp.h>
+  #include <Updater.h>
+  #include <ESP8266httpUpdate.h>  // Only for t_httpUpdate_return, the download is streamed
+#elif defined(ESP32)
+  #include <WiFi.h>
+  #include <HTTPClient.h>
+  #include <WebServer.h>
+  #include <WiFiUdp.h>
+  #include <Update.h>
+  #include <HTTPUpdate.h>         // Only for t_httpUpdate_return, the download is streamed
+  #include <sys/socket.h>         // send() of tcpWrite()
+#endif
+#include "OTA_Features.h"         // OTA_FEATURE_* switches
+
+struct OTAPlatformESP8266 {};
+struct OTAPlatformESP32 {};
+
+template <typename Tag> struct OTAPlatformTraits;
+
+#if defined(ESP8266)
+
+template <> struct OTAPlatformTraits<OTAPlatformESP8266> {
+  typedef ESP8266WebServer HttpServer;
+
+  static const char *name() { return "ESP8266"; }
+
+  // The EEPROM buffer is kept after begin(), commit() writes it to flash
+  static bool eepromBegin(size_t size) {
+    EEPROM.begin(size);
+    return true;
+  }
+  static void eepromEnd(bool write) {
+    if (write) EEPROM.commit();
+  }
+
+  static uint32_t maxFreeBlock() { return ESP.getMaxFreeBlockSize(); }
+
+  // Multicast needs the interface address on the ESP8266
+  static bool udpBeginMulticast(WiFiUDP &udp, IPAddress group, uint16_t port) {
+    return udp.beginMulticast(WiFi.localIP(), group, port);
+  }
+  static int udpBeginPacketMulticast(WiFiUDP &udp, IPAddress group, uint16_t port) {
+    return udp.beginPacketMulticast(group, port, WiFi.localIP());
+  }
+
+  static bool tcpConnect(WiFiClient &tcp, IPAddress ip, uint16_t port, uint32_t timeoutMs) {
+    tcp.setTimeout(timeoutMs);
+    return tcp.connect(ip, port);
+  }
+
+  // Writes only what fits into the TCP send buffer, returns 0 if it is full
+  static size_t tcpWrite(WiFiClient &tcp, const uint8_t *data, size_t len) {
+    size_t room = (size_t)tcp.availableForWrite();
+    return room ? tcp.write(data, len < room ? len : room) : 0;
+  }
+
+  // Fails on the missing bytes and resets the updater
+  static void updateAbort() { Update.end(); }
+};
+
+typedef OTAPlatformTraits<OTAPlatformESP8266> OTAPlatform;
+
+#elif defined(ESP32)
+
+template <> struct OTAPlatformTraits<OTAPlatformESP32> {
+  typedef WebServer HttpServer;
+
+  static const char *name() { return "ESP32"; }
+
+  // The EEPROM buffer is released after each access
+  static bool eepromBegin(size_t size) { return EEPROM.begin(size); }
+  static void eepromEnd(bool write) {
+    if (write) EEPROM.commit();
+    EEPROM.end();
+  }
+
+  static uint32_t maxFreeBlock() { return ESP.getMaxAllocHeap(); }
+
+  static bool udpBeginMulticast(WiFiUDP &udp, IPAddress group, uint16_t port) {
+    return udp.beginMulticast(group, port);
+  }
+  static int udpBeginPacketMulticast(WiFiUDP &udp, IPAddress group, uint16_t port) {
+    return udp.beginPacket(group, port);
+  }
+
+  static bool tcpConnect(WiFiClient &tcp, IPAddress ip, uint16_t port, uint32_t timeoutMs) {
+    return tcp.connect(ip, port, timeoutMs);
+  }
+
+  // WiFiClient::write() retries until its timeout if the send buffer is full, the socket
+  // is written directly without waiting instead; returns 0 if nothing could be sent
+  static size_t tcpWrite(WiFiClient &tcp, const uint8_t *data, size_t len) {
+    int fd = tcp.fd();
+    if (fd < 0 || len == 0) return 0;
+    int n = send(fd, data, len, MSG_DONTWAIT);
+    return n > 0 ? (size_t)n : 0;
+  }
+
+  static void updateAbort() { Update.abort(); }
+};
+
+typedef OTAPlatformTraits<OTAPlatformESP32> OTAPlatform;
+
+#else
+#error "OTA Template: unsupported platform, ESP8266 or ESP32 required"
+#endif
+
+#endif // OTA_PLATFORM_H
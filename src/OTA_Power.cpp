@@ -0,0 +1,221 @@
+/**
+ * OTA_Power.cpp
+ *
+ * Implementation of the power-aware scheduling (see OTA_Power.h).
+ * The statistics and the remaining deep sleep time are kept in RTC memory:
+ * on ESP32 in a RTC_DATA_ATTR variable, on ESP8266 in the RTC user memory.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Power.h"
+
+#if defined(ESP8266)
+  #include <ESP8266WiFi.h>
+#elif defined(ESP32)
+  #include <WiFi.h>
+  #include <esp_sleep.h>
+#endif
+
+#define RTC_STATE_MAGIC 0x4F545057UL   // "WPTO"
+#define RTC_STATE_OFFSET 64            // ESP8266 RTC user memory block (upper half, 4 bytes per block)
+#define NO_WAKEUP ((unsigned long)-1)
+
+struct RtcState {
+  uint32_t magic;
+  OTAPowerStats stats;
+  uint32_t remainingMs;    // Deep sleep time left when a long interval is split
+  uint32_t sleeping;       // 1 while in deep sleep
+  uint32_t checksum;
+};
+
+#if defined(ESP32)
+static RTC_DATA_ATTR RtcState rtc;
+#else
+static RtcState rtc;
+#endif
+
+static OTAPowerMode mode = OTA_POWER_MODE;
+static bool wokeFromDeepSleep = false;
+static unsigned long mark = 0;          // Start of the current awake period (millis)
+static unsigned long awakeUntil = 0;
+static unsigned long wakeIn = NO_WAKEUP;
+
+static uint32_t rtcChecksum() {
+  uint32_t sum = 0x9E3779B9UL;
+  const uint32_t *words = (const uint32_t *)&rtc;
+  for (size_t i = 0; i < offsetof(RtcState, checksum) / 4; ++i) sum = (sum ^ words[i]) * 16777619UL;
+  return sum;
+}
+
+static void rtcLoad() {
+#if defined(ESP8266)
+  ESP.rtcUserMemoryRead(RTC_STATE_OFFSET, (uint32_t *)&rtc, sizeof(rtc));
+#endif
+  if (rtc.magic != RTC_STATE_MAGIC || rtc.checksum != rtcChecksum()) {
+    memset(&rtc, 0, sizeof(rtc)); // Power-on or corrupted state
+    rtc.magic = RTC_STATE_MAGIC;
+  }
+}
+
+static void rtcSave() {
+  rtc.checksum = rtcChecksum();
+#if defined(ESP8266)
+  ESP.rtcUserMemoryWrite(RTC_STATE_OFFSET, (uint32_t *)&rtc, sizeof(rtc));
+#endif
+}
+
+/**
+ * Adds the time since mark to the awake time and starts a new period.
+ */
+static void accountAwake() {
+  unsigned long now = millis();
+  rtc.stats.awakeMs += now - mark;
+  mark = now;
+}
+
+/**
+ * Deep sleeps for ms milliseconds. Intervals longer than the hardware limit are
+ * split; the remaining time is continued by powerBegin() after the wake-up.
+ */
+static void deepSleepFor(unsigned long ms) {
+  uint64_t leg = ms;
+#if defined(ESP8266)
+  uint64_t maxMs = ESP.deepSleepMax() / 1000;
+  if (leg > maxMs) leg = maxMs;
+#endif
+  accountAwake();
+  rtc.remainingMs = (uint32_t)(ms - leg);
+  rtc.sleeping = 1;
+  rtc.stats.deepMs += (uint32_t)leg;
+  rtcSave();
+  Serial.printf("Deep sleep for %lu ms (duty cycle %u.%u%%)\n", (unsigned long)leg,
+                powerDutyCycle() / 10, powerDutyCycle() % 10);
+  Serial.flush();
+#if defined(ESP8266)
+  // Intermediate wake-ups only go back to sleep, the radio stays off for them
+  ESP.deepSleep(leg * 1000, rtc.remainingMs ? WAKE_RF_DISABLED : WAKE_RF_DEFAULT);
+#elif defined(ESP32)
+  esp_deep_sleep(leg * 1000);
+#endif
+}
+
+void powerBegin() {
+  rtcLoad();
+  wokeFromDeepSleep = rtc.sleeping != 0;
+  rtc.sleeping = 0;
+  rtc.stats.bootCount++;
+  mark = 0; // Boot time counts as awake
+  if (wokeFromDeepSleep && rtc.remainingMs > 0) {
+    deepSleepFor(rtc.remainingMs); // Continue a long interval without starting WiFi
+  }
+  rtcSave();
+  powerSetMode(mode);
+}
+
+void powerSetMode(OTAPowerMode newMode) {
+  mode = newMode;
+#if defined(ESP8266)
+  WiFi.setSleepMode(mode == OTA_POWER_LIGHT_SLEEP ? WIFI_LIGHT_SLEEP : WIFI_MODEM_SLEEP);
+#elif defined(ESP32)
+  WiFi.setSleep(true); // Modem sleep (default of the core), needed to keep the link in light sleep
+#endif
+}
+
+OTAPowerMode powerMode() {
+  return mode;
+}
+
+void powerWakeIn(unsigned long ms) {
+  if (ms < wakeIn) wakeIn = ms;
+}
+
+void powerKeepAwake(unsigned long ms) {
+  awakeUntil = millis() + ms;
+}
+
+bool powerWokeFromDeepSleep() {
+  return wokeFromDeepSleep;
+}
+
+void powerIdle(unsigned long untilCheckMs) {
+  unsigned long until = untilCheckMs < wakeIn ? untilCheckMs : wakeIn;
+  wakeIn = NO_WAKEUP;
+  if (mode == OTA_POWER_ALWAYS_ON || until == 0) return;
+  bool keepAwake = (long)(awakeUntil - millis()) > 0;
+  unsigned long slept = 0;
+  OTAPowerMode sleepMode = mode;
+  if (mode == OTA_POWER_DEEP_SLEEP && until < OTA_POWER_DEEP_MIN) {
+    sleepMode = OTA_POWER_LIGHT_SLEEP; // A reboot costs more than it saves for short pauses
+  }
+
+  switch (sleepMode) {
+    case OTA_POWER_MODEM_SLEEP: {
+      // CPU idles, the radio sleeps between beacons; web server stays reachable
+      unsigned long slice = until < OTA_POWER_MODEM_SLICE ? until : OTA_POWER_MODEM_SLICE;
+      accountAwake();
+      delay(slice);
+      slept = millis() - mark;
+      rtc.stats.modemMs += slept;
+      break;
+    }
+    case OTA_POWER_LIGHT_SLEEP: {
+      if (keepAwake) return;
+      unsigned long slice = until < OTA_POWER_LIGHT_SLICE ? until : OTA_POWER_LIGHT_SLICE;
+      accountAwake();
+#if defined(ESP8266)
+      delay(slice); // Automatic light sleep (WIFI_LIGHT_SLEEP) while the CPU waits
+#elif defined(ESP32)
+      esp_sleep_enable_timer_wakeup((uint64_t)slice * 1000);
+      esp_light_sleep_start();
+#endif
+      slept = millis() - mark;
+      rtc.stats.lightMs += slept;
+      break;
+    }
+    case OTA_POWER_DEEP_SLEEP:
+      // Stay awake for the wake window, after web requests and without a scheduled wake-up
+      if (keepAwake || millis() < OTA_POWER_WAKE_WINDOW || until == NO_WAKEUP) return;
+      deepSleepFor(until);
+      return;
+    default:
+      return;
+  }
+  mark = millis();
+}
+
+OTAPowerStats powerStats() {
+  OTAPowerStats s = rtc.stats;
+  s.awakeMs += millis() - mark;
+  return s;
+}
+
+uint16_t powerDutyCycle() {
+  OTAPowerStats s = powerStats();
+  uint64_t total = (uint64_t)s.awakeMs + s.modemMs + s.lightMs + s.deepMs;
+  return total ? (uint16_t)((uint64_t)s.awakeMs * 1000 / total) : 1000;
+}
+
+uint32_t powerAverageCurrent() {
+  OTAPowerStats s = powerStats();
+  uint64_t total = (uint64_t)s.awakeMs + s.modemMs + s.lightMs + s.deepMs;
+  if (!total) return OTA_POWER_ACTIVE_MA;
+  uint64_t charge = (uint64_t)s.awakeMs * OTA_POWER_ACTIVE_MA + (uint64_t)s.modemMs * OTA_POWER_MODEM_MA +
+                    (uint64_t)s.lightMs * OTA_POWER_LIGHT_MA + (uint64_t)s.deepMs * OTA_POWER_DEEP_MA;
+  return (uint32_t)(charge / total);
+}
@@ -0,0 +1,147 @@
+/**
+ * OTA_Power.h
+ *
+ * Power-aware scheduling for battery powered devices.
+ * otaLoop() calls powerIdle() with the time until the next OTA check; depending
+ * on the energy mode the device then sleeps until the next scheduled work:
+ *
+ *   OTA_POWER_ALWAYS_ON    - no sleep (default, behaviour of earlier versions)
+ *   OTA_POWER_MODEM_SLEEP  - the radio sleeps between DTIM beacons, the CPU idles
+ *                            in slices of OTA_POWER_MODEM_SLICE ms; the web server
+ *                            stays reachable
+ *   OTA_POWER_LIGHT_SLEEP  - CPU and radio sleep in slices of OTA_POWER_LIGHT_SLICE ms,
+ *                            web requests are answered with up to one slice latency
+ *   OTA_POWER_DEEP_SLEEP   - after the OTA check and a wake window of
+ *                            OTA_POWER_WAKE_WINDOW ms the device sleeps until the next
+ *                            check (pauses below OTA_POWER_DEEP_MIN ms use light sleep);
+ *                            ESP8266 needs GPIO16 connected to RST
+ *
+ * User tasks request their next wake-up with powerWakeIn(), web requests keep the
+ * device awake for OTA_POWER_WEB_AWAKE ms. Sleep statistics are kept in RTC memory
+ * across deep sleep, powerStats() reports the estimated duty cycle and the average
+ * current based on typical currents of the modes (OTA_POWER_*_MA).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_POWER_H
+#define OTA_POWER_H
+
+#include <Arduino.h>
+
+enum OTAPowerMode : uint8_t {
+  OTA_POWER_ALWAYS_ON,
+  OTA_POWER_MODEM_SLEEP,
+  OTA_POWER_LIGHT_SLEEP,
+  OTA_POWER_DEEP_SLEEP
+};
+
+#ifndef OTA_POWER_MODE
+#define OTA_POWER_MODE OTA_POWER_ALWAYS_ON   // Energy mode at startup, can be changed with powerSetMode()
+#endif
+#ifndef OTA_POWER_MODEM_SLICE
+#define OTA_POWER_MODEM_SLICE 100            // Max. idle time per loop in modem sleep (ms)
+#endif
+#ifndef OTA_POWER_LIGHT_SLICE
+#define OTA_POWER_LIGHT_SLICE 1000           // Max. light sleep time per loop (ms)
+#endif
+#ifndef OTA_POWER_WAKE_WINDOW
+#define OTA_POWER_WAKE_WINDOW 10000          // Min. awake time after a deep sleep wake-up (ms)
+#endif
+#ifndef OTA_POWER_DEEP_MIN
+#define OTA_POWER_DEEP_MIN 30000             // Shorter pauses use light sleep in OTA_POWER_DEEP_SLEEP mode (ms)
+#endif
+#ifndef OTA_POWER_WEB_AWAKE
+#define OTA_POWER_WEB_AWAKE 10000            // Time to stay awake after a web request (ms)
+#endif
+
+// Typical supply currents used for the estimate, in 1/100 mA
+#ifndef OTA_POWER_ACTIVE_MA
+#define OTA_POWER_ACTIVE_MA 8000             // CPU and radio active
+#endif
+#ifndef OTA_POWER_MODEM_MA
+#define OTA_POWER_MODEM_MA 1800              // Modem sleep
+#endif
+#ifndef OTA_POWER_LIGHT_MA
+#define OTA_POWER_LIGHT_MA 100               // Light sleep
+#endif
+#ifndef OTA_POWER_DEEP_MA
+#define OTA_POWER_DEEP_MA 2                  // Deep sleep
+#endif
+
+struct OTAPowerStats {
+  uint32_t bootCount;      // Starts since power-on (incl. deep sleep wake-ups)
+  uint32_t awakeMs;        // Time active since power-on
+  uint32_t modemMs;        // Time in modem sleep
+  uint32_t lightMs;        // Time in light sleep
+  uint32_t deepMs;         // Time in deep sleep
+};
+
+/**
+ * Restores the RTC state and continues an interrupted deep sleep (long intervals are
+ * slept in several parts). Called at the start of otaSetup(), before WiFi is started.
+ */
+void powerBegin();
+
+/**
+ * Sets the energy mode.
+ */
+void powerSetMode(OTAPowerMode mode);
+
+/**
+ * Returns the current energy mode.
+ */
+OTAPowerMode powerMode();
+
+/**
+ * Sleeps according to the energy mode, at most until the next scheduled work.
+ * untilCheckMs is the time until the next OTA check. Called at the end of otaLoop().
+ */
+void powerIdle(unsigned long untilCheckMs);
+
+/**
+ * Requests a wake-up in ms milliseconds (for user tasks). Valid until the next powerIdle().
+ */
+void powerWakeIn(unsigned long ms);
+
+/**
+ * Keeps the device awake for ms milliseconds (e.g. after a web request).
+ */
+void powerKeepAwake(unsigned long ms);
+
+/**
+ * Returns true if the current start was a wake-up from deep sleep.
+ */
+bool powerWokeFromDeepSleep();
+
+/**
+ * Returns the sleep statistics since power-on.
+ */
+OTAPowerStats powerStats();
+
+/**
+ * Returns the estimated duty cycle (active time) in 1/10 percent since power-on.
+ */
+uint16_t powerDutyCycle();
+
+/**
+ * Returns the estimated average supply current in 1/100 mA since power-on.
+ */
+uint32_t powerAverageCurrent();
+
+#endif // OTA_POWER_H
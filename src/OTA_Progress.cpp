@@ -0,0 +1,180 @@
+/**
+ * OTA_Progress.cpp
+ *
+ * Implementation of the OTA progress publisher (see OTA_Progress.h).
+ * Event stream clients are taken over from the web server after the response
+ * headers have been written; the web server drops its reference without
+ * closing the connection. Events are written directly to the subscribers, so
+ * they are delivered while the updater blocks the main loop.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Progress.h"
+#include "OTA_WebConfig.h"
+#include "OTA_Router.h"
+#include "OTA_Platform.h"
+
+static OTAProgress state = { OTA_PHASE_IDLE, 0, 0, 0, 0, 0, "" };
+static WiFiClient subscribers[OTA_PROGRESS_MAX_SUBSCRIBERS];
+static unsigned long lastPublish = 0;
+static bool pending = false;          // A coalesced update has not been sent yet
+
+const char *progressPhaseName(OTAPhase phase) {
+  switch (phase) {
+    case OTA_PHASE_IDLE: return "idle";
+    case OTA_PHASE_CHECKING: return "checking";
+    case OTA_PHASE_UP_TO_DATE: return "up-to-date";
+    case OTA_PHASE_DOWNLOADING: return "downloading";
+    case OTA_PHASE_REBOOTING: return "rebooting";
+    case OTA_PHASE_FAILED: return "failed";
+  }
+  return "unknown";
+}
+
+const OTAProgress &progressState() {
+  return state;
+}
+
+size_t progressJson(char *buf, size_t size) {
+  char detail[2 * sizeof(state.detail)]; // Holds host names from the configuration
+  jsonEscape(detail, sizeof(detail), state.detail);
+  int n = snprintf(buf, size,
+                   "{\"phase\":\"%s\",\"bytes\":%lu,\"total\":%lu,\"rate\":%lu,\"eta\":%lu,\"detail\":\"%s\"}",
+                   progressPhaseName(state.phase), (unsigned long)state.bytes, (unsigned long)state.total,
+                   (unsigned long)state.rate, (unsigned long)state.eta, detail);
+  if (n < 0) return 0;
+  return (size_t)n < size ? (size_t)n : size - 1;
+}
+
+/**
+ * Writes data to a subscriber without blocking. Returns false if the stream is closed.
+ * On the ESP8266 an event that does not fit into the send buffer is dropped, the next
+ * event supersedes it. On the ESP32 the free space is not known in advance: the socket
+ * is written with OTAPlatform::tcpWrite(), a subscriber that does not take the whole
+ * event is closed, as a partly written event would corrupt the stream.
+ */
+static bool writeEvent(WiFiClient &client, const char *data, size_t len) {
+  if (!client.connected()) return false;
+#if defined(ESP8266)
+  if ((size_t)client.availableForWrite() < len) return true;
+#endif
+  return OTAPlatform::tcpWrite(client, (const uint8_t *)data, len) == len;
+}
+
+/**
+ * Sends the current state as "progress" event to all subscribers.
+ */
+static void publish() {
+  char event[200];
+  size_t len = snprintf(event, sizeof(event), "event: progress\ndata: ");
+  len += progressJson(event + len, sizeof(event) - len - 2);
+  event[len++] = '\n';
+  event[len++] = '\n';
+  for (uint8_t i = 0; i < OTA_PROGRESS_MAX_SUBSCRIBERS; ++i) {
+    if (subscribers[i] && !writeEvent(subscribers[i], event, len)) {
+      subscribers[i].stop();
+      subscribers[i] = WiFiClient();
+    }
+  }
+  lastPublish = millis();
+  pending = false;
+}
+
+void progressPhase(OTAPhase phase, const char *detail) {
+  state.phase = phase;
+  strncpy(state.detail, detail ? detail : "", sizeof(state.detail) - 1);
+  state.detail[sizeof(state.detail) - 1] = '\0';
+  if (phase == OTA_PHASE_DOWNLOADING) {
+    state.bytes = state.total = state.rate = state.eta = 0;
+    state.started = millis();
+  }
+  if (phase == OTA_PHASE_REBOOTING) state.eta = 0;
+  publish();
+}
+
+void progressUpdate(uint32_t bytes, uint32_t total) {
+  if (state.phase != OTA_PHASE_DOWNLOADING) progressPhase(OTA_PHASE_DOWNLOADING);
+  state.bytes = bytes;
+  state.total = total;
+  unsigned long elapsed = millis() - state.started;
+  if (elapsed > 0) state.rate = (uint32_t)((uint64_t)bytes * 1000 / elapsed);
+  state.eta = (state.rate > 0 && total > bytes) ? (total - bytes) / state.rate : 0;
+  pending = true;
+  if (millis() - lastPublish >= OTA_PROGRESS_INTERVAL || (total > 0 && bytes >= total)) publish();
+}
+
+void progressLoop() {
+  if (pending && millis() - lastPublish >= OTA_PROGRESS_INTERVAL) {
+    publish();
+  } else if (millis() - lastPublish >= OTA_PROGRESS_KEEPALIVE) {
+    // Comment line keeps proxies from closing idle streams and detects closed clients
+    for (uint8_t i = 0; i < OTA_PROGRESS_MAX_SUBSCRIBERS; ++i) {
+      if (subscribers[i] && !writeEvent(subscribers[i], ":\n\n", 3)) {
+        subscribers[i].stop();
+        subscribers[i] = WiFiClient();
+      }
+    }
+    lastPublish = millis();
+  }
+}
+
+/**
+ * Handler of OTA_PROGRESS_EVENTS. Takes the connection over as event stream subscriber.
+ */
+static void handleEvents() {
+  int slot = -1;
+  for (uint8_t i = 0; i < OTA_PROGRESS_MAX_SUBSCRIBERS && slot < 0; ++i) {
+    if (!subscribers[i] || !subscribers[i].connected()) slot = i;
+  }
+  if (slot < 0) {
+    server.send(503, "text/plain", "Too many event streams");
+    return;
+  }
+  WiFiClient client = server.client();
+  client.setNoDelay(true);
+  client.print(F("HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/event-stream\r\n"
+                 "Cache-Control: no-cache\r\n"
+                 "Connection: keep-alive\r\n"
+                 "Access-Control-Allow-Origin: *\r\n\r\n"));
+  subscribers[slot].stop();
+  subscribers[slot] = client;
+
+  // The new subscriber gets the current state right away
+  char event[200];
+  size_t len = snprintf(event, sizeof(event), "retry: 2000\nevent: progress\ndata: ");
+  len += progressJson(event + len, sizeof(event) - len - 2);
+  event[len++] = '\n';
+  event[len++] = '\n';
+  client.write((const uint8_t *)event, len);
+}
+
+/**
+ * Handler of OTA_PROGRESS_STATUS. Returns the current progress as JSON.
+ */
+static void handleStatus() {
+  char json[160];
+  progressJson(json, sizeof(json));
+  server.send(200, "application/json", json);
+}
+
+void progressBegin() {
+  routerAdd(OTA_PROGRESS_EVENTS, OTA_METHOD(HTTP_GET), handleEvents);
+  routerAdd(OTA_PROGRESS_STATUS, OTA_METHOD(HTTP_GET), handleStatus);
+}
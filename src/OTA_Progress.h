@@ -0,0 +1,111 @@
+/**
+ * OTA_Progress.h
+ *
+ * Live progress of OTA updates for browsers and dashboards.
+ * The update phase, bytes written, throughput and estimated remaining time are
+ * pushed as Server-Sent Events on OTA_PROGRESS_EVENTS ("/ota/events"); a JSON
+ * snapshot of the same data is available on OTA_PROGRESS_STATUS ("/ota/progress").
+ *
+ * The publisher is fed by the download paths: verifyWrite() for the image from the
+ * OTA server and from peers (OTA_Verify.h, OTA_Peer.h) and the multicast receiver
+ * (OTA_Multicast.h) call progressUpdate(), the update check progressPhase(). It
+ * coalesces updates: at most one event is sent every OTA_PROGRESS_INTERVAL
+ * milliseconds, intermediate values are dropped. Phase changes are sent immediately.
+ * Events are written without blocking, so slow subscribers never stall the flash write.
+ *
+ * Usage in JavaScript:
+ *   new EventSource("/ota/events").addEventListener("progress", e => show(JSON.parse(e.data)));
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_PROGRESS_H
+#define OTA_PROGRESS_H
+
+#include <Arduino.h>
+
+#define OTA_PROGRESS_EVENTS "/ota/events"     // Server-Sent Events stream
+#define OTA_PROGRESS_STATUS "/ota/progress"   // JSON snapshot of the current progress
+
+#ifndef OTA_PROGRESS_INTERVAL
+#define OTA_PROGRESS_INTERVAL 500             // Min. time between two progress events in milliseconds
+#endif
+#ifndef OTA_PROGRESS_MAX_SUBSCRIBERS
+#define OTA_PROGRESS_MAX_SUBSCRIBERS 3        // Max. number of concurrent event stream clients
+#endif
+#ifndef OTA_PROGRESS_KEEPALIVE
+#define OTA_PROGRESS_KEEPALIVE 15000          // Interval of keep-alive comments on idle streams in milliseconds
+#endif
+
+enum OTAPhase : uint8_t {
+  OTA_PHASE_IDLE,          // No update running
+  OTA_PHASE_CHECKING,      // Checking the version on the OTA server
+  OTA_PHASE_UP_TO_DATE,    // Last check found no newer firmware
+  OTA_PHASE_DOWNLOADING,   // Firmware is downloaded and written to flash
+  OTA_PHASE_REBOOTING,     // Update written, device restarts
+  OTA_PHASE_FAILED         // Last check or update failed (see detail)
+};
+
+struct OTAProgress {
+  OTAPhase phase;
+  uint32_t bytes;          // Bytes written in the current download
+  uint32_t total;          // Size of the firmware image, 0 if unknown
+  uint32_t rate;           // Throughput in bytes per second
+  uint32_t eta;            // Estimated remaining time in seconds
+  unsigned long started;   // millis() at the start of the download
+  char detail[48];         // Version or error message of the current phase
+};
+
+/**
+ * Registers the event stream and the snapshot endpoint with the web server.
+ * Call after startWebServer().
+ */
+void progressBegin();
+
+/**
+ * Sends pending (coalesced) events and keep-alive comments, drops closed streams.
+ * Called from otaLoop().
+ */
+void progressLoop();
+
+/**
+ * Sets the update phase and publishes it immediately. detail may be nullptr.
+ */
+void progressPhase(OTAPhase phase, const char *detail = nullptr);
+
+/**
+ * Reports the download progress. Publishes at most every OTA_PROGRESS_INTERVAL ms.
+ */
+void progressUpdate(uint32_t bytes, uint32_t total);
+
+/**
+ * Returns the current progress.
+ */
+const OTAProgress &progressState();
+
+/**
+ * Returns the name of a phase as used in the events ("downloading", ...).
+ */
+const char *progressPhaseName(OTAPhase phase);
+
+/**
+ * Writes the current progress as JSON into buf. Returns the length.
+ */
+size_t progressJson(char *buf, size_t size);
+
+#endif // OTA_PROGRESS_H
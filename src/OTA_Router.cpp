@@ -0,0 +1,349 @@
+/**
+ * OTA_Router.cpp
+ *
+ * Implementation of the prefix trie router for the configuration web server.
+ *
+ * Each path segment of a registered pattern is stored as one trie node.
+ * The static children of a node are a slice of childIndex sorted by the
+ * 16 bit hash of their labels, so a lookup is a binary search on the hash
+ * and touches the label bytes only on a hash hit. Parameter segments ("{name}") are
+ * stored in a separate slot per node and are only tried when no static
+ * child matches.
+ *
+ * All tables are statically sized (see OTA_Router.h), nothing is allocated
+ * on the heap while a request is routed.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Router.h"
+#include "OTA_Power.h"
+#include "OTA_Arena.h"
+
+#define ROUTER_NONE 0xFF
+
+struct RouteNode {
+  uint16_t label;        // Offset of the segment label (or parameter name) in the pool
+  uint8_t labelLen;      // Length of the label
+  uint16_t hash;         // Hash of the label, compared before the label bytes
+  uint8_t firstChild;    // Start of the static children in childIndex
+  uint8_t childCount;    // Number of static children
+  uint8_t paramChild;    // Parameter child ("{name}"), if any
+  uint8_t firstRoute;    // First route registered for this node
+};
+
+struct Route {
+  uint32_t methodMask;   // Allowed methods
+  uint8_t next;          // Next route of the same node
+  RouteHandler handler;  // Request handler
+};
+
+struct RouteCapture {
+  uint8_t node;          // Parameter node (holds the parameter name)
+  uint16_t start;        // Offset of the value in the request URI
+  uint16_t len;          // Length of the value
+};
+
+static RouteNode routeNodes[OTA_ROUTER_MAX_NODES];
+static Route routes[OTA_ROUTER_MAX_ROUTES];
+static char routePool[OTA_ROUTER_POOL_SIZE];
+// Static children of all nodes, one slice per node sorted by label hash (binary search)
+static uint8_t childIndex[OTA_ROUTER_MAX_NODES];
+static uint8_t childUsed = 0;
+static uint8_t nodeCount = 0;
+static uint8_t routeCount = 0;
+static uint16_t poolUsed = 0;
+
+// State of the request currently being dispatched
+static const char *currentUri = nullptr;
+static RouteCapture captures[OTA_ROUTER_MAX_PARAMS];
+static uint8_t captureCount = 0;
+
+/**
+ * 16 bit FNV-1a hash of a path segment.
+ */
+static uint16_t segmentHash(const char *s, size_t len) {
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < len; ++i) {
+    h ^= (uint8_t)s[i];
+    h *= 16777619UL;
+  }
+  return (uint16_t)(h ^ (h >> 16));
+}
+
+/**
+ * Allocates a new trie node with the given label.
+ * Returns ROUTER_NONE if the node table or the label pool is full.
+ */
+static uint8_t newNode(const char *label, size_t len) {
+  if (nodeCount >= OTA_ROUTER_MAX_NODES || nodeCount >= ROUTER_NONE) return ROUTER_NONE;
+  if (len > 255 || poolUsed + len > OTA_ROUTER_POOL_SIZE) return ROUTER_NONE;
+  RouteNode &n = routeNodes[nodeCount];
+  memcpy(routePool + poolUsed, label, len);
+  n.label = poolUsed;
+  n.labelLen = (uint8_t)len;
+  n.hash = segmentHash(label, len);
+  n.firstChild = 0;
+  n.childCount = 0;
+  n.paramChild = ROUTER_NONE;
+  n.firstRoute = ROUTER_NONE;
+  poolUsed += len;
+  return nodeCount++;
+}
+
+static bool labelEquals(const RouteNode &n, const char *s, size_t len, uint16_t hash) {
+  return n.hash == hash && n.labelLen == len && memcmp(routePool + n.label, s, len) == 0;
+}
+
+/**
+ * Returns the position of the first child of parent with a hash >= hash in childIndex.
+ */
+static uint8_t lowerBound(const RouteNode &parent, uint16_t hash) {
+  uint8_t lo = parent.firstChild;
+  uint8_t hi = parent.firstChild + parent.childCount;
+  while (lo < hi) {
+    uint8_t mid = lo + (hi - lo) / 2;
+    if (routeNodes[childIndex[mid]].hash < hash) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+/**
+ * Returns the static child of parent matching the segment, or ROUTER_NONE.
+ * Binary search on the hash, so the cost does not grow with the number of siblings.
+ */
+static uint8_t findChild(uint8_t parent, const char *s, size_t len, uint16_t hash) {
+  const RouteNode &n = routeNodes[parent];
+  uint8_t end = n.firstChild + n.childCount;
+  for (uint8_t i = lowerBound(n, hash); i < end && routeNodes[childIndex[i]].hash == hash; ++i) {
+    if (labelEquals(routeNodes[childIndex[i]], s, len, hash)) return childIndex[i];
+  }
+  return ROUTER_NONE;
+}
+
+/**
+ * Inserts child into the sorted slice of parent, the slices behind it move up by one.
+ * Only called while routes are registered.
+ */
+static void addChild(uint8_t parent, uint8_t child) {
+  RouteNode &n = routeNodes[parent];
+  if (n.childCount == 0) n.firstChild = childUsed;
+  uint8_t pos = lowerBound(n, routeNodes[child].hash);
+  memmove(childIndex + pos + 1, childIndex + pos, childUsed - pos);
+  childIndex[pos] = child;
+  childUsed++;
+  for (uint8_t i = 0; i < nodeCount; ++i) {
+    if (i != parent && routeNodes[i].childCount && routeNodes[i].firstChild >= pos) routeNodes[i].firstChild++;
+  }
+  n.childCount++;
+}
+
+uint32_t routeMethodBit(HTTPMethod method) {
+  if (method == HTTP_ANY) return OTA_METHOD_ANY;
+  switch (method) { // Explicit bits: the ESP32 core has more than 32 methods
+    case HTTP_GET:     return 1UL << 0;
+    case HTTP_HEAD:    return 1UL << 1;
+    case HTTP_POST:    return 1UL << 2;
+    case HTTP_PUT:     return 1UL << 3;
+    case HTTP_PATCH:   return 1UL << 4;
+    case HTTP_DELETE:  return 1UL << 5;
+    case HTTP_OPTIONS: return 1UL << 6;
+    default:           return 1UL << 31; // Any other method, only matched by OTA_METHOD_ANY
+  }
+}
+
+bool routerAdd(const char *pattern, uint32_t methodMask, RouteHandler handler) {
+  if (!pattern || !handler) return false;
+  if (nodeCount == 0 && newNode("", 0) == ROUTER_NONE) return false; // Root node
+  if (routeCount >= OTA_ROUTER_MAX_ROUTES) {
+    Serial.println("Router: route table full!");
+    return false;
+  }
+
+  uint8_t node = 0;
+  uint8_t params = 0;
+  const char *p = pattern;
+  while (*p) {
+    if (*p == '/') { ++p; continue; }
+    const char *end = p;
+    while (*end && *end != '/') ++end;
+    size_t len = end - p;
+
+    uint8_t next;
+    if (*p == '{') {
+      if (len < 3 || p[len - 1] != '}' || ++params > OTA_ROUTER_MAX_PARAMS) {
+        Serial.printf("Router: invalid pattern %s\n", pattern);
+        return false;
+      }
+      const char *name = p + 1;
+      size_t nameLen = len - 2;
+      next = routeNodes[node].paramChild;
+      if (next == ROUTER_NONE) {
+        next = newNode(name, nameLen);
+        if (next == ROUTER_NONE) break;
+        routeNodes[node].paramChild = next;
+      } else if (!labelEquals(routeNodes[next], name, nameLen, segmentHash(name, nameLen))) {
+        Serial.printf("Router: conflicting parameter name in %s\n", pattern);
+        return false;
+      }
+    } else {
+      uint16_t hash = segmentHash(p, len);
+      next = findChild(node, p, len, hash);
+      if (next == ROUTER_NONE) {
+        next = newNode(p, len);
+        if (next == ROUTER_NONE) break;
+        addChild(node, next);
+      }
+    }
+    node = next;
+    p = end;
+  }
+  if (*p) {
+    Serial.println("Router: node table or label pool full!");
+    return false;
+  }
+
+  // Append the route, so routes registered first take precedence (as with server.on())
+  Route &r = routes[routeCount];
+  r.methodMask = methodMask;
+  r.handler = handler;
+  r.next = ROUTER_NONE;
+  uint8_t *link = &routeNodes[node].firstRoute;
+  while (*link != ROUTER_NONE) link = &routes[*link].next;
+  *link = routeCount++;
+  return true;
+}
+
+/**
+ * Matches the URI remainder starting at p against the subtree of node.
+ * Returns the index of the matching route or ROUTER_NONE.
+ * pathFound is set if a node with routes was reached, regardless of the method.
+ */
+static uint8_t matchRoute(uint8_t node, const char *p, uint32_t methodBit, bool &pathFound) {
+  while (*p == '/') ++p;
+  if (!*p) {
+    uint8_t r = routeNodes[node].firstRoute;
+    if (r != ROUTER_NONE) pathFound = true;
+    for (; r != ROUTER_NONE; r = routes[r].next) {
+      if (routes[r].methodMask & methodBit) return r;
+    }
+    return ROUTER_NONE;
+  }
+
+  const char *end = p;
+  while (*end && *end != '/') ++end;
+  size_t len = end - p;
+
+  uint8_t child = findChild(node, p, len, segmentHash(p, len));
+  if (child != ROUTER_NONE) {
+    uint8_t r = matchRoute(child, end, methodBit, pathFound);
+    if (r != ROUTER_NONE) return r;
+  }
+
+  uint8_t param = routeNodes[node].paramChild;
+  if (param != ROUTER_NONE && captureCount < OTA_ROUTER_MAX_PARAMS) {
+    RouteCapture &c = captures[captureCount++];
+    c.node = param;
+    c.start = (uint16_t)(p - currentUri);
+    c.len = (uint16_t)len;
+    uint8_t r = matchRoute(param, end, methodBit, pathFound);
+    if (r != ROUTER_NONE) return r;
+    --captureCount;
+  }
+  return ROUTER_NONE;
+}
+
+void routerDispatch() {
+  powerKeepAwake(OTA_POWER_WEB_AWAKE); // A browser is active, postpone light and deep sleep
+  OTAArenaScope scope;                 // Scratch buffers of the handler end with the request
+  const String &uri = server.uri();
+  currentUri = uri.c_str();
+  captureCount = 0;
+
+  bool pathFound = false;
+  uint8_t r = ROUTER_NONE;
+  if (nodeCount > 0) {
+    r = matchRoute(0, currentUri, routeMethodBit(server.method()), pathFound);
+  }
+
+  if (r != ROUTER_NONE) {
+    routes[r].handler();
+  } else if (pathFound) {
+    server.send(405, "text/plain", "Method Not Allowed");
+  } else {
+    server.send(404, "text/plain", "Not Found");
+  }
+
+  currentUri = nullptr;
+  captureCount = 0;
+}
+
+uint8_t routeParamCount() {
+  return captureCount;
+}
+
+const char *routeParam(uint8_t index, size_t &len) {
+  if (!currentUri || index >= captureCount) {
+    len = 0;
+    return nullptr;
+  }
+  len = captures[index].len;
+  return currentUri + captures[index].start;
+}
+
+const char *routeParam(const char *name, size_t &len) {
+  size_t nameLen = strlen(name);
+  uint16_t hash = segmentHash(name, nameLen);
+  for (uint8_t i = 0; i < captureCount; ++i) {
+    if (labelEquals(routeNodes[captures[i].node], name, nameLen, hash)) {
+      return routeParam(i, len);
+    }
+  }
+  len = 0;
+  return nullptr;
+}
+
+size_t routeParamCopy(const char *name, char *buf, size_t size) {
+  size_t len;
+  const char *value = routeParam(name, len);
+  if (!value || size == 0) {
+    if (size) buf[0] = '\0';
+    return 0;
+  }
+  if (len >= size) len = size - 1;
+  memcpy(buf, value, len);
+  buf[len] = '\0';
+  return len;
+}
+
+long routeParamInt(const char *name, long fallback) {
+  size_t len;
+  const char *value = routeParam(name, len);
+  if (!value || len == 0) return fallback;
+  long result = 0;
+  size_t i = 0;
+  bool negative = (value[0] == '-');
+  if (negative) i = 1;
+  if (i == len) return fallback;
+  for (; i < len; ++i) {
+    if (value[i] < '0' || value[i] > '9') return fallback;
+    result = result * 10 + (value[i] - '0');
+  }
+  return negative ? -result : result;
+}
@@ -0,0 +1,112 @@
+/**
+ * OTA_Router.h
+ *
+ * Declares the request router used by the configuration web server.
+ * All endpoints (the built-in OTA configuration pages as well as endpoints
+ * added via registerCustomEndpoint()) are stored in a segment-wise prefix trie
+ * and dispatched from a single catch-all handler. Lookup cost depends on the
+ * number of path segments only, not on the number of registered routes.
+ *
+ * Route patterns:
+ *   - Static segments:    "/ota/set"
+ *   - Parameter segments: "/sensor/{id}" or "/sensor/{id}/value"
+ *   Static segments take precedence over parameter segments at the same level.
+ *
+ * Parameter values are exposed as pointer/length pairs into the request URI,
+ * so no String objects are allocated while routing. Each request runs in a scope of
+ * the scratch memory (OTA_Arena.h), buffers a handler takes from it are released
+ * after the response.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_ROUTER_H
+#define OTA_ROUTER_H
+
+#include <Arduino.h>
+#include <functional>
+#include "OTA_WebConfig.h" // For HTTPMethod and WebConfigServer
+
+// Static limits of the router tables (override via build flags if needed)
+#ifndef OTA_ROUTER_MAX_NODES
+#define OTA_ROUTER_MAX_NODES 64         // Max. number of path segments stored in the trie
+#endif
+#ifndef OTA_ROUTER_MAX_ROUTES
+#define OTA_ROUTER_MAX_ROUTES 32        // Max. number of registered routes (pattern + method mask)
+#endif
+#ifndef OTA_ROUTER_POOL_SIZE
+#define OTA_ROUTER_POOL_SIZE 512        // Bytes reserved for segment labels and parameter names
+#endif
+#ifndef OTA_ROUTER_MAX_PARAMS
+#define OTA_ROUTER_MAX_PARAMS 4         // Max. number of {param} segments per route
+#endif
+
+// Method masks for routerAdd(), combine with '|'
+#define OTA_METHOD(m) (routeMethodBit(m))
+#define OTA_METHOD_ANY 0xFFFFFFFFUL
+
+typedef std::function<void(void)> RouteHandler;
+
+/**
+ * Converts an HTTPMethod into its bit in a route method mask.
+ * HTTP_ANY maps to all bits; methods other than GET, HEAD, POST, PUT, PATCH, DELETE
+ * and OPTIONS share one bit.
+ */
+uint32_t routeMethodBit(HTTPMethod method);
+
+/**
+ * Adds a route to the router.
+ * @param pattern URI pattern, e.g. "/ota/set" or "/sensor/{id}"
+ * @param methodMask Allowed methods, built with OTA_METHOD() or OTA_METHOD_ANY
+ * @param handler Function called for matching requests
+ * @return false if the pattern is malformed or a router table is full
+ */
+bool routerAdd(const char *pattern, uint32_t methodMask, RouteHandler handler);
+
+/**
+ * Dispatches the current request of the global web server.
+ * Installed as the catch-all handler by startWebServer().
+ * Sends 404 for unknown paths and 405 if the path exists for other methods only.
+ */
+void routerDispatch();
+
+/**
+ * Returns the number of parameters captured for the current request.
+ */
+uint8_t routeParamCount();
+
+/**
+ * Returns a parameter of the current request by index or name.
+ * The returned pointer references the request URI and is NOT zero terminated;
+ * its length is stored in len. Returns nullptr if the parameter does not exist.
+ */
+const char *routeParam(uint8_t index, size_t &len);
+const char *routeParam(const char *name, size_t &len);
+
+/**
+ * Copies a named parameter into buf (zero terminated, truncated to size).
+ * @return Length of the copied value, 0 if the parameter does not exist
+ */
+size_t routeParamCopy(const char *name, char *buf, size_t size);
+
+/**
+ * Returns a named parameter as integer, or fallback if missing or not numeric.
+ */
+long routeParamInt(const char *name, long fallback);
+
+#endif // OTA_ROUTER_H
@@ -0,0 +1,171 @@
+/**
+ * OTA_Sha256.cpp
+ *
+ * Implementation of the streaming SHA-256 (see OTA_Sha256.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Sha256.h"
+
+#if defined(OTA_NATIVE)
+
+static const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t ror(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+OTASha256::OTASha256() { begin(); }
+OTASha256::~OTASha256() {}
+
+void OTASha256::begin() {
+  static const uint32_t init[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+  memcpy(state, init, sizeof(state));
+  length = 0;
+  used = 0;
+}
+
+void OTASha256::block(const uint8_t *data) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i) {
+    w[i] = (uint32_t)data[i * 4] << 24 | (uint32_t)data[i * 4 + 1] << 16 | (uint32_t)data[i * 4 + 2] << 8 | data[i * 4 + 3];
+  }
+  for (int i = 16; i < 64; ++i) {
+    uint32_t s0 = ror(w[i - 15], 7) ^ ror(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = ror(w[i - 2], 17) ^ ror(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 64; ++i) {
+    uint32_t t1 = h + (ror(e, 6) ^ ror(e, 11) ^ ror(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+    uint32_t t2 = (ror(a, 2) ^ ror(a, 13) ^ ror(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+  state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+  state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void OTASha256::update(const uint8_t *data, size_t len) {
+  length += len;
+  if (used) {
+    size_t n = len < 64 - used ? len : 64 - used;
+    memcpy(buffer + used, data, n);
+    used += n;
+    data += n;
+    len -= n;
+    if (used < 64) return;
+    block(buffer);
+    used = 0;
+  }
+  for (; len >= 64; data += 64, len -= 64) block(data);
+  memcpy(buffer, data, len);
+  used = len;
+}
+
+void OTASha256::finish(uint8_t digest[OTA_SHA256_SIZE]) {
+  uint64_t bits = length * 8;
+  uint8_t pad[72] = { 0x80 };
+  size_t padLen = (used < 56 ? 56 : 120) - used;
+  for (int i = 0; i < 8; ++i) pad[padLen + i] = (uint8_t)(bits >> (56 - 8 * i));
+  update(pad, padLen + 8);
+  for (int i = 0; i < 8; ++i) {
+    digest[i * 4] = (uint8_t)(state[i] >> 24);
+    digest[i * 4 + 1] = (uint8_t)(state[i] >> 16);
+    digest[i * 4 + 2] = (uint8_t)(state[i] >> 8);
+    digest[i * 4 + 3] = (uint8_t)state[i];
+  }
+}
+
+#elif defined(ESP8266)
+
+OTASha256::OTASha256() { begin(); }
+OTASha256::~OTASha256() {}
+
+void OTASha256::begin() {
+  br_sha256_init(&ctx);
+}
+
+void OTASha256::update(const uint8_t *data, size_t len) {
+  br_sha256_update(&ctx, data, len);
+}
+
+void OTASha256::finish(uint8_t digest[OTA_SHA256_SIZE]) {
+  br_sha256_out(&ctx, digest);
+}
+
+#elif defined(ESP32)
+
+OTASha256::OTASha256() {
+  mbedtls_sha256_init(&ctx);
+  begin();
+}
+
+OTASha256::~OTASha256() {
+  mbedtls_sha256_free(&ctx);
+}
+
+void OTASha256::begin() {
+  mbedtls_sha256_starts(&ctx, 0); // 0: SHA-256, not SHA-224
+}
+
+void OTASha256::update(const uint8_t *data, size_t len) {
+  mbedtls_sha256_update(&ctx, data, len);
+}
+
+void OTASha256::finish(uint8_t digest[OTA_SHA256_SIZE]) {
+  mbedtls_sha256_finish(&ctx, digest);
+}
+
+#endif
+
+void OTASha256::toHex(const uint8_t digest[OTA_SHA256_SIZE], char hex[OTA_SHA256_HEX_SIZE]) {
+  static const char digits[] = "0123456789abcdef";
+  for (int i = 0; i < OTA_SHA256_SIZE; ++i) {
+    hex[i * 2] = digits[digest[i] >> 4];
+    hex[i * 2 + 1] = digits[digest[i] & 0x0F];
+  }
+  hex[OTA_SHA256_SIZE * 2] = '\0';
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool OTASha256::fromHex(const char *hex, uint8_t digest[OTA_SHA256_SIZE]) {
+  for (int i = 0; i < OTA_SHA256_SIZE; ++i) {
+    int hi = hexValue(hex[i * 2]);
+    int lo = hi < 0 ? -1 : hexValue(hex[i * 2 + 1]);
+    if (lo < 0) return false;
+    digest[i] = (uint8_t)(hi << 4 | lo);
+  }
+  return hexValue(hex[OTA_SHA256_SIZE * 2]) < 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * OTA_Sha256.h
+ *
+ * Streaming SHA-256 for the OTA Template. Images are hashed chunk by chunk while
+ * they are downloaded or read from flash, so no copy of the image is needed.
+ * The ESP32 uses mbedTLS (hardware accelerated where the chip has a SHA unit),
+ * the ESP8266 uses BearSSL, the native build a portable implementation.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_SHA256_H
+#define OTA_SHA256_H
+
+#include <Arduino.h>
+
+#if defined(OTA_NATIVE)
+  // Portable implementation in OTA_Sha256.cpp
+#elif defined(ESP8266)
+  #include <bearssl/bearssl_hash.h>
+#elif defined(ESP32)
+  #include <mbedtls/sha256.h>
+#endif
+
+#define OTA_SHA256_SIZE 32         // Digest size in bytes
+#define OTA_SHA256_HEX_SIZE 65     // Hex digest including the terminating '\0'
+
+class OTASha256 {
+public:
+  OTASha256();
+  ~OTASha256();
+
+  /** Starts a new hash. */
+  void begin();
+
+  /** Adds len bytes to the hash. */
+  void update(const uint8_t *data, size_t len);
+
+  /** Completes the hash and writes the digest. begin() is required before the next use. */
+  void finish(uint8_t digest[OTA_SHA256_SIZE]);
+
+  /** Writes the digest as lower case hex string. */
+  static void toHex(const uint8_t digest[OTA_SHA256_SIZE], char hex[OTA_SHA256_HEX_SIZE]);
+
+  /** Parses a hex digest (upper or lower case), false if hex is not 64 hex digits. */
+  static bool fromHex(const char *hex, uint8_t digest[OTA_SHA256_SIZE]);
+
+private:
+  OTASha256(const OTASha256 &);
+  OTASha256 &operator=(const OTASha256 &);
+
+#if defined(OTA_NATIVE)
+  void block(const uint8_t *data);
+  uint32_t state[8];
+  uint64_t length;
+  uint8_t buffer[64];
+  size_t used;
+#elif defined(ESP8266)
+  br_sha256_context ctx;
+#elif defined(ESP32)
+  mbedtls_sha256_context ctx;
+#endif
+};
+
+#endif // OTA_SHA256_H
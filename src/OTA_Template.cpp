@@ -25,10 +25,13 @@
  * The web interface allows convenient editing and saving of all relevant parameters.
  *
  * Included functions:
- *  - ensureWiFiConnection(): Ensures WiFi is connected.
+ *  - ensureWiFiConnection(): Ensures WiFi is connected (fast reconnect, see OTA_WiFi.h).
  *  - splitVersion()/compareVersion(): Version string utilities for OTA.
  *  - indicateUpdateStatus(): Shows OTA update status via LED and serial.
- *  - performOTAUpdate(): Checks for and performs firmware updates.
+ *  - performOTAUpdate(): Checks for and performs firmware updates, reports the progress (OTA_Progress.h).
+ *  - downloadUpdate(): Loads the image from the OTA server and verifies it while writing (OTA_Verify.h),
+ *    continues on a mirror if the server fails (OTA_Mirror.h).
+ *  - handleStatus(): Reports firmware, heap, connection and power metrics on /ota/status.
  *  - otaSetup(): Initializes configuration, WiFi, and web server.
  *  - otaLoop(): Handles OTA logic and web server requests.
  *
@@ -51,23 +54,10 @@
  */
 
 #include <Arduino.h>
-#include <vector>
-#include <sstream>
 #include "OTA_Template.h"
-
-#if defined(ESP8266)
-  #include <ESP8266WiFi.h>
-  #include <ESP8266HTTPClient.h>
-  #include <ESP8266httpUpdate.h>
-#elif defined(ESP32)
-  #include <WiFi.h>
-  #include <HTTPClient.h>
-  #include <Update.h>
-  #include <HTTPUpdate.h>
-#endif
+#include "OTA_Platform.h"
 
 extern OTAConfig config;
-WiFiClient client;
 
 /**
  * Ensures that the device is connected to WiFi.
@@ -75,57 +65,109 @@ WiFiClient client;
  */
 void ensureWiFiConnection() {
   if (WiFi.status() != WL_CONNECTED) {
-    Serial.print("Connecting to WiFi");
-    while (WiFi.status() != WL_CONNECTED) {
+    Serial.println("Connecting to WiFi");
+    while (!wifiConnect()) { // Cached access point first, then full scan (OTA_WiFi.cpp)
       delay(1000);
       Serial.print(".");
     }
-    Serial.println();
-    Serial.println("Connected to WiFi");
-    Serial.print("IP address: ");
-    Serial.println(WiFi.localIP());
   }
 }
 
 /**
  * Splits a version string (e.g. "1.2.3") into integer components.
- * Returns a vector with the individual numbers.
- */
-std::vector<int> splitVersion(const String& version) {
-  std::vector<int> parts;
-  int start = 0, end = 0;
-  while ((end = version.indexOf('.', start)) != -1) {
-    parts.push_back(version.substring(start, end).toInt());
-    start = end + 1;
+ * Writes at most max numbers to parts and returns their count.
+ */
+size_t splitVersion(const char *version, int *parts, size_t max) {
+  size_t count = 0;
+  while (count < max) {
+    parts[count++] = atoi(version);
+    version = strchr(version, '.');
+    if (!version) break;
+    version++;
   }
-  parts.push_back(version.substring(start).toInt());
-  return parts;
+  return count;
 }
 
 /**
  * Compares two version strings.
  * @return -1 if v1 < v2, 1 if v1 > v2, 0 if equal.
  */
-int compareVersion(const String& v1, const String& v2) {
-  std::vector<int> ver1 = splitVersion(v1);
-  std::vector<int> ver2 = splitVersion(v2);
-  size_t len = std::max(ver1.size(), ver2.size());
+int compareVersion(const char *v1, const char *v2) {
+  int ver1[OTA_VERSION_PARTS];
+  int ver2[OTA_VERSION_PARTS];
+  size_t len1 = splitVersion(v1, ver1, OTA_VERSION_PARTS);
+  size_t len2 = splitVersion(v2, ver2, OTA_VERSION_PARTS);
+  size_t len = len1 > len2 ? len1 : len2;
   for (size_t i = 0; i < len; ++i) {
-    int num1 = (i < ver1.size()) ? ver1[i] : 0;
-    int num2 = (i < ver2.size()) ? ver2[i] : 0;
+    int num1 = (i < len1) ? ver1[i] : 0;
+    int num2 = (i < len2) ? ver2[i] : 0;
     if (num1 < num2) return -1;
     if (num1 > num2) return 1;
   }
   return 0;
 }
 
+/**
+ * Builds the URL of the firmware image on the selected OTA server (OTA_Mirror.h).
+ * Returns false if the URL does not fit into buf.
+ */
+bool otaFirmwareUrl(char *buf, size_t size) {
+  const OTAMirror &m = mirrorCurrent();
+  int n = snprintf(buf, size, OTA_SCHEME "://%s:%d/updates/%s", m.host, m.port, config.firmware_name);
+  return n > 0 && (size_t)n < size;
+}
+
+/**
+ * Builds the URL of the version file of the current firmware on the OTA server.
+ * Returns false if the URL does not fit into buf.
+ */
+bool otaVersionUrl(char *buf, size_t size) {
+  const OTAMirror &m = mirrorCurrent();
+  int n = snprintf(buf, size, OTA_SCHEME "://%s:%d/version/%s.version", m.host, m.port, config.firmware_vers);
+  return n > 0 && (size_t)n < size;
+}
+
+/**
+ * Builds the URL of the SHA-256 of the firmware image on the OTA server (OTA_Peer.h).
+ * Returns false if the URL does not fit into buf.
+ */
+bool otaHashUrl(char *buf, size_t size) {
+  const OTAMirror &m = mirrorCurrent();
+  int n = snprintf(buf, size, OTA_SCHEME "://%s:%d/hash/%s", m.host, m.port, config.firmware_name);
+  return n > 0 && (size_t)n < size;
+}
+
+/**
+ * Returns the SHA-256 of the current firmware image: from the manifest of the update
+ * (OTA_Verify.h) or, for servers without manifests, from the OTA server.
+ * Returns false if the server does not provide it.
+ */
+bool otaImageHash(uint8_t sha[OTA_SHA256_SIZE]) {
+  const OTAManifest &m = verifyManifest();
+  if (m.valid) {
+    memcpy(sha, m.sha, OTA_SHA256_SIZE);
+    return true;
+  }
+  if (OTA_VERIFY_SIGNED) return false;
+  char url[128];
+  if (!otaHashUrl(url, sizeof(url))) return false;
+  HTTPClient http;
+  bool ok = false;
+  if (clientBegin(http, url)) {
+    char hex[OTA_SHA256_HEX_SIZE + 1];
+    ok = http.GET() == HTTP_CODE_OK && clientReadBody(http, hex, sizeof(hex)) > 0 && OTASha256::fromHex(hex, sha);
+    http.end();
+  }
+  return ok;
+}
+
 /**
  * Shows the status of the OTA update via the LED and serial interface.
  * - On error: LED stays on
  * - No update: LED off
  * - Successful update: LED blinks 5 times
  */
-void indicateUpdateStatus(t_httpUpdate_return ret, String vers) {
+void indicateUpdateStatus(t_httpUpdate_return ret, const char *vers) {
   switch (ret) {
     case HTTP_UPDATE_FAILED:
       digitalWrite(LED_BUILTIN, HIGH); // Error: LED stays on
@@ -136,7 +178,7 @@ void indicateUpdateStatus(t_httpUpdate_return ret, String vers) {
       Serial.println("No OTA Update available!");
       break;
     case HTTP_UPDATE_OK:
-      Serial.println("OTA Update to version " + vers +  " completed!");
+      Serial.printf("OTA Update to version %s completed!\n", vers);
       for (int i = 0; i < 5; i++) { // Success: LED blinks 5 times
         digitalWrite(LED_BUILTIN, HIGH);
         delay(200);
@@ -147,81 +189,283 @@ void indicateUpdateStatus(t_httpUpdate_return ret, String vers) {
   }
 }
 
+/**
+ * Reports a failed download to the progress subscribers (OTA_Progress.h).
+ */
+static t_httpUpdate_return downloadFailed(const char *detail) {
+  progressPhase(OTA_PHASE_FAILED, detail);
+  return HTTP_UPDATE_FAILED;
+}
+
+/**
+ * Downloads the firmware image from the selected OTA server into the update partition.
+ * The image is hashed while it is written and only committed if it matches the
+ * manifest. If the server fails, the download continues on the next mirror with a
+ * Range request (OTA_Mirror.h).
+ */
+static t_httpUpdate_return downloadUpdate() {
+  const OTAManifest &m = verifyManifest();
+  char url[128];
+  char detail[32];
+  size_t size = 0;
+  int code = 0;
+  bool flashOk = true;
+  do {
+    if (!otaFirmwareUrl(url, sizeof(url))) break;
+    Serial.printf("Updating firmware from %s\n", url);
+    HTTPClient http;
+    if (!clientBegin(http, url)) continue;
+    size_t done = verifyWritten();
+    char range[40];
+    if (size) {
+      snprintf(range, sizeof(range), "bytes=%u-%u", (unsigned)done, (unsigned)(size - 1));
+      http.addHeader("Range", range);
+    }
+    code = http.GET();
+    int len = http.getSize();
+    if (!size) {
+      bool sizeOk = code == HTTP_CODE_OK && len > 0 && (!m.valid || (uint32_t)len == m.size);
+      if (sizeOk && Update.begin(len)) {
+        size = len;
+        verifyBegin(size, m.valid ? m.sha : nullptr);
+      } else if (code > 0 && code < HTTP_CODE_INTERNAL_SERVER_ERROR) {
+        Serial.printf("Download not possible, HTTP code %d, size %d\n", code, len);
+        http.end();
+        if (sizeOk) return downloadFailed("no space for image");
+        if (code == HTTP_CODE_OK) return downloadFailed("image size");
+        snprintf(detail, sizeof(detail), "download HTTP %d", code);
+        return downloadFailed(detail);
+      } else {
+        http.end();
+        continue;
+      }
+    } else if (code != HTTP_CODE_PARTIAL_CONTENT || len != (int)(size - done)) {
+      Serial.printf("Download cannot be resumed, HTTP code %d, size %d\n", code, len);
+      http.end();
+      continue;
+    } else {
+      Serial.printf("Download resumed at %u bytes\n", (unsigned)done);
+      mirrorResumed();
+    }
+    progressPhase(OTA_PHASE_DOWNLOADING, mirrorCurrent().host);
+    flashOk = verifyWrite(http.getStreamPtr(), OTA_VERIFY_TIMEOUT);
+    http.end();
+    if (!flashOk || verifyWritten() == size) break;
+  } while (mirrorFailover());
+  if (!size) {
+    if (code > 0) snprintf(detail, sizeof(detail), "download HTTP %d", code);
+    else strcpy(detail, "download connect");
+    return downloadFailed(detail);
+  }
+  switch (verifyEnd()) {
+    case OTA_INSTALL_OK:
+      return HTTP_UPDATE_OK;
+    case OTA_INSTALL_REJECTED:
+      return downloadFailed("hash mismatch");
+    default:
+      return downloadFailed(flashOk ? "download incomplete" : "write");
+  }
+}
+
+/**
+ * Requests the version file; if the OTA server does not answer, from the next mirror
+ * (OTA_Mirror.h). Returns the HTTP code of the last request.
+ */
+static int requestVersion(HTTPClient &http, char *url, size_t size) {
+  while (true) {
+    int code = clientBegin(http, url) ? http.GET() : HTTPC_ERROR_CONNECTION_REFUSED;
+    if ((code > 0 && code < HTTP_CODE_INTERNAL_SERVER_ERROR) || !mirrorFailover()) return code;
+    http.end();
+    if (!otaVersionUrl(url, size)) return code;
+    Serial.printf("Checking firmware version from: %s\n", url);
+  }
+}
+
 /**
  * Checks if a new firmware version is available on the OTA server,
  * and performs the update if necessary. Saves the new version to EEPROM.
  */
 void performOTAUpdate() {
-  String newVersion;
+  char newVersion[sizeof(config.firmware_vers)];
   int comp = -1;
   char path[128];
   char buf[128];
-  sprintf(path, "http://%s:%d/updates/%s", config.otaServer, config.otaPort, config.firmware_name);
-  sprintf(buf, "http://%s:%d/version/%s.version", config.otaServer, config.otaPort, config.firmware_vers);
+  mirrorSelect(); // Fastest healthy OTA server or mirror, probed if due (OTA_Mirror.h)
+  if (!otaFirmwareUrl(path, sizeof(path)) || !otaVersionUrl(buf, sizeof(buf))) {
+    Serial.println("OTA server URL too long.");
+    progressPhase(OTA_PHASE_FAILED, "URL too long");
+    return;
+  }
 
   Serial.printf("Starting OTA update from: %s\n", path);
   Serial.printf("Checking firmware version from: %s\n", buf);
+  progressPhase(OTA_PHASE_CHECKING, config.firmware_vers);
 
   HTTPClient http;
-  if (http.begin(client, buf)) {
-    int httpCode = http.GET();
-    Serial.printf("HTTP response code: %d\n", httpCode);
-    if (httpCode == HTTP_CODE_OK) {
-      newVersion = http.getString();
-      newVersion.trim();
+  int httpCode = coapCheckVersion(newVersion, sizeof(newVersion)); // One datagram each way (OTA_Coap.h)
+  bool coap = httpCode > 0;
+  if (!coap) httpCode = requestVersion(http, buf, sizeof(buf));
+  if (httpCode != HTTPC_ERROR_CONNECTION_REFUSED) {
+    wifiMarkFirstRequest();
+    Serial.printf("%s response code: %d\n", coap ? "CoAP" : "HTTP", httpCode);
+    if (httpCode == HTTP_CODE_OK && !coap && clientReadBody(http, newVersion, sizeof(newVersion)) < 0) {
+      Serial.println("Version file too long.");
+      progressPhase(OTA_PHASE_FAILED, "version too long");
+    } else if (httpCode == HTTP_CODE_OK) {
       comp = compareVersion(newVersion, config.firmware_vers);
-      Serial.printf("Available firmware version: %s\n", newVersion.c_str());
+      Serial.printf("Available firmware version: %s\n", newVersion);
       if (comp == 0){
         Serial.println("Firmware is already up-to-date.");
+        progressPhase(OTA_PHASE_UP_TO_DATE, config.firmware_vers);
         http.end();
+        fsSyncUpdate(); // Files of the installed firmware (OTA_FileSync.h)
         return;
       }
     } else {
       Serial.printf("Failed to check firmware version, HTTP code: %d\n", httpCode);
+      snprintf(buf, sizeof(buf), "version check HTTP %d", httpCode);
+      progressPhase(OTA_PHASE_FAILED, buf);
     }
     http.end();
   } else {
+    http.end();
     Serial.println("Failed to connect to version check URL.");
+    progressPhase(OTA_PHASE_FAILED, "version check connect");
   }
 
   if(comp > 0) {  // There is a new version on OTA server available
-    Serial.printf("New firmware version %s available, current version is %s\n", newVersion.c_str(), config.firmware_vers);
-    strcpy(config.firmware_vers, newVersion.c_str());
+    Serial.printf("New firmware version %s available, current version is %s\n", newVersion, config.firmware_vers);
+    if (!verifyLoadManifest(newVersion)) { // Size and SHA-256 of the image, signed by the server
+      progressPhase(OTA_PHASE_FAILED, "manifest");
+      indicateUpdateStatus(HTTP_UPDATE_FAILED, newVersion);
+      return;
+    }
+    // Multicast carousel and peers on the LAN first, the OTA server only if they cannot
+    // deliver the verified image (OTA_Multicast.h, OTA_Peer.h)
+    bool installed = mcastUpdate(newVersion);
+    if (!installed) {
+      OTAPeerResult peer = peerUpdate(newVersion);
+      if (peer == OTA_PEER_DEFERRED) return;
+      installed = peer == OTA_PEER_INSTALLED;
+    }
+    if (installed) {
+      strcpy(config.firmware_vers, newVersion);
+      saveConfigToEEPROM();
+      indicateUpdateStatus(HTTP_UPDATE_OK, newVersion);
+      progressPhase(OTA_PHASE_REBOOTING, config.firmware_vers);
+      ESP.restart();
+      return;
+    }
+    strcpy(config.firmware_vers, newVersion);
     saveConfigToEEPROM(); // Save new version to EEPROM
     Serial.println("EEPROM Version updated -> Starting OTA update...");
     unsigned long startTime = millis();
     while (millis() - startTime < config.otaUpdateInterval * 60000) { // Check for updates within the interval
-      Serial.printf("Performing OTA update to version %s...\n", newVersion.c_str());
+      Serial.printf("Performing OTA update to version %s...\n", newVersion);
       // Perform the OTA update
-      strcpy(config.firmware_vers, newVersion.c_str());
+      strcpy(config.firmware_vers, newVersion);
       saveConfigToEEPROM(); // Save new version to EEPROM
       Serial.println("Saving new version to EEPROM...");
-      Serial.printf("Updating firmware from %s\n", path);
-      #if defined(ESP8266)
-        t_httpUpdate_return ret = ESPhttpUpdate.update(client, path);
-      #elif defined(ESP32)
-        HTTPUpdate httpUpdate;
-        t_httpUpdate_return ret = httpUpdate.update(client, path);
-      #endif
+      t_httpUpdate_return ret = downloadUpdate();
       indicateUpdateStatus(ret, newVersion);
       if (ret == HTTP_UPDATE_OK) {
+        progressPhase(OTA_PHASE_REBOOTING, config.firmware_vers);
+        ESP.restart();
         break;
       }
     }
   }
 }
 
+#if OTA_FEATURE_STATUS
+#define STATUS_MIRRORS_SIZE 576
+#define STATUS_JSON_SIZE 2304
+
+/**
+ * Handler of OTA_STATUS_PATH. Returns firmware, heap and connection metrics as JSON.
+ */
+void handleStatus() {
+  const OTAWiFiStats &ws = wifiStats();
+  const OTANotifyStats &ns = notifyStats();
+  const OTAPeerStats &ps = peerStats();
+  const OTAMcastStats &ms = mcastStats();
+  const OTAVerifyStats &vs = verifyStats();
+  const OTAClientStats &cs = clientStats();
+  const OTAMirrorStats &mirror = mirrorStats();
+  const OTADnsStats &ds = dnsStats();
+  const OTAFsStats &ss = fsSyncStats();
+  const OTACoapStats &co = coapStats();
+  const OTAArenaStats &as = arenaStats();
+  // From the arena: too large for the stack of the ESP8266 loop task (OTA_Arena.h)
+  char *mirrors = (char *)arenaAlloc(STATUS_MIRRORS_SIZE);
+  char *json = (char *)arenaAlloc(STATUS_JSON_SIZE);
+  if (!mirrors || !json) {
+    server.send(503, "text/plain", "Out of memory");
+    return;
+  }
+  if (!mirrorListJson(mirrors, STATUS_MIRRORS_SIZE)) strcpy(mirrors, "[]");
+  char firmware[2 * sizeof(config.firmware_vers)];
+  char announced[2 * sizeof(ns.announced)];
+  jsonEscape(firmware, sizeof(firmware), config.firmware_vers);
+  jsonEscape(announced, sizeof(announced), ns.announced);
+  snprintf(json, STATUS_JSON_SIZE,
+           "{\"firmware\":\"%s\",\"uptime\":%lu,\"freeHeap\":%lu,"
+           "\"heap\":{\"maxBlock\":%lu,\"minMaxBlock\":%lu,\"arenaSize\":%u,\"arenaHighWater\":%lu,"
+           "\"arenaFailures\":%lu},"
+           "\"wifi\":{\"connectMs\":%lu,\"fast\":%s,\"fastConnects\":%u,\"scanConnects\":%u,"
+           "\"onlineAt\":%lu,\"firstRequestAt\":%lu,\"channel\":%d,\"rssi\":%d},"
+           "\"power\":{\"mode\":%d,\"boots\":%lu,\"dutyCycle\":%u.%u,\"avgCurrentMa\":%lu.%02lu},"
+           "\"notify\":{\"alive\":%s,\"beacons\":%lu,\"triggers\":%lu,\"announced\":\"%s\"},"
+           "\"peer\":{\"peers\":%u,\"served\":%lu,\"installs\":%lu,\"rejected\":%lu,\"image\":\"%s\"},"
+           "\"mcast\":{\"updates\":%lu,\"passes\":%lu,\"packets\":%lu,\"recovered\":%lu,\"repaired\":%lu},"
+           "\"verify\":{\"signed\":%s,\"verified\":%lu,\"rejected\":%lu,\"hashUs\":%lu,\"bytes\":%lu},"
+           "\"client\":{\"https\":%s,\"connects\":%lu,\"reused\":%lu,\"resumed\":%lu,\"handshakeMs\":%lu,"
+           "\"fullHandshakeMs\":%lu},"
+           "\"mirror\":{\"selected\":%u,\"probes\":%lu,\"failovers\":%lu,\"resumed\":%lu,\"servers\":%s},"
+           "\"dns\":{\"hits\":%lu,\"queries\":%lu,\"stale\":%lu,\"failures\":%lu,\"lookupMs\":%lu,"
+           "\"discoveries\":%lu},"
+           "\"fs\":{\"enabled\":%s,\"syncs\":%lu,\"files\":%lu,\"downloaded\":%lu,\"deleted\":%lu,\"failed\":%lu,"
+           "\"bytes\":%lu,\"lastMs\":%lu},"
+           "\"coap\":{\"enabled\":%s,\"requests\":%lu,\"retransmits\":%lu,\"fallbacks\":%lu,\"rttMs\":%lu}}",
+           firmware, millis(), (unsigned long)ESP.getFreeHeap(),
+           (unsigned long)arenaMaxFreeBlock(), (unsigned long)as.minMaxBlock, (unsigned)OTA_ARENA_SIZE,
+           (unsigned long)as.highWater, (unsigned long)as.failures,
+           ws.connectMs, ws.fastConnect ? "true" : "false", ws.fastConnects, ws.scanConnects,
+           ws.onlineAt, ws.firstRequestAt, (int)WiFi.channel(), (int)WiFi.RSSI(),
+           (int)powerMode(), (unsigned long)powerStats().bootCount, powerDutyCycle() / 10, powerDutyCycle() % 10,
+           (unsigned long)(powerAverageCurrent() / 100), (unsigned long)(powerAverageCurrent() % 100),
+           notifyAlive() ? "true" : "false", (unsigned long)ns.beacons, (unsigned long)ns.triggers, announced,
+           (unsigned)ps.peers, (unsigned long)ps.served, (unsigned long)ps.installs, (unsigned long)ps.rejected,
+           ps.imageHash, (unsigned long)ms.updates, (unsigned long)ms.passes, (unsigned long)ms.packets,
+           (unsigned long)ms.recovered, (unsigned long)ms.repaired,
+           OTA_VERIFY_SIGNED ? "true" : "false", (unsigned long)vs.verified, (unsigned long)vs.rejected,
+           (unsigned long)vs.hashUs, (unsigned long)vs.bytes,
+           OTA_HTTPS ? "true" : "false", (unsigned long)cs.connects, (unsigned long)cs.reused,
+           (unsigned long)cs.resumed, (unsigned long)cs.handshakeMs, (unsigned long)cs.fullMs,
+           (unsigned)mirrorIndex(), (unsigned long)mirror.probes, (unsigned long)mirror.failovers,
+           (unsigned long)mirror.resumed, mirrors,
+           (unsigned long)ds.hits, (unsigned long)ds.queries, (unsigned long)ds.stale, (unsigned long)ds.failures,
+           (unsigned long)ds.lookupMs, (unsigned long)ds.discoveries,
+           OTA_FS_SYNC ? "true" : "false", (unsigned long)ss.syncs, (unsigned long)ss.files,
+           (unsigned long)ss.downloaded, (unsigned long)ss.deleted, (unsigned long)ss.failed, (unsigned long)ss.bytes,
+           (unsigned long)ss.lastMs,
+           OTA_COAP ? "true" : "false", (unsigned long)co.requests, (unsigned long)co.retransmits,
+           (unsigned long)co.fallbacks, (unsigned long)co.rttMs);
+  server.send(200, "application/json", json);
+}
+#endif
+
 /**
  * Initializes the configuration, connects to WiFi, and starts the web server.
  * Loads configuration from EEPROM or uses the provided defaults if not present.
  * Starts the web-based configuration interface.
  */
 void otaSetup(const OTAConfig &defaults) {
+    powerBegin(); // Restore RTC state, continues a split deep sleep before WiFi is started
     loadConfig(&defaults); // Pass address to match loadConfig signature
 
     Serial.println("READY - Connecting to WiFi ..");
     WiFi.mode(WIFI_STA);
-    WiFi.begin(config.ssid, config.password);
 
     ensureWiFiConnection();
 
@@ -229,6 +473,14 @@ void otaSetup(const OTAConfig &defaults) {
     Serial.println(config.firmware_vers);
 
     startWebServer(); // Start web configuration
+    progressBegin();  // Live update progress on /ota/events
+    notifyBegin();    // Listen for update beacons of the OTA server
+    peerBegin();      // Serve the own image to / find updates on peers in the LAN
+    mirrorBegin();    // OTA server and its mirrors
+    fsSyncBegin();    // Mount LittleFS for the file sync (OTA_FS_SYNC)
+#if OTA_FEATURE_STATUS
+    routerAdd(OTA_STATUS_PATH, OTA_METHOD(HTTP_GET), handleStatus);
+#endif
 }
 
 /**
@@ -238,13 +490,29 @@ void otaSetup(const OTAConfig &defaults) {
 void otaLoop() {
   ensureWiFiConnection();
   handleWebServer(); // Handle web server requests
+  progressLoop();    // Send pending progress events
+  notifyLoop();      // Update beacons of the OTA server
+  peerLoop();        // Announcements of peers in the LAN
+  static unsigned long lastUpdateCheck = 0;
+  unsigned long untilCheck = (unsigned long)-1; // No OTA check scheduled
   if(config.otaEnabled) {
-    // Check for OTA updates every configured interval
-    static unsigned long lastUpdateCheck = 0;
-    // initial update after start then every otaUpdateInterval minutes
-    if ((lastUpdateCheck == 0) || (millis() - lastUpdateCheck > config.otaUpdateInterval * 60000)) { // Convert minutes to milliseconds
-      performOTAUpdate();
+    // Check for OTA updates every configured interval, less often while update beacons arrive
+    unsigned long interval = notifyPollInterval(config.otaUpdateInterval * 60000); // Convert minutes to milliseconds
+    // initial update after start, then every interval or when a beacon announces a new version
+    if ((lastUpdateCheck == 0) || (millis() - lastUpdateCheck > interval) || notifyUntilCheck() == 0) {
+      notifyCheckDone(); // performOTAUpdate() may schedule the next check (waiting for a peer)
+      {
+        OTAArenaScope scope; // Scratch buffers of the check (OTA_Arena.h)
+        performOTAUpdate();
+        clientEnd(); // Keeps the TLS session, releases the connection (OTA_Client.h)
+      }
+      OTAPhase phase = progressState().phase;
+      notifyCheckResult(phase == OTA_PHASE_UP_TO_DATE || phase == OTA_PHASE_REBOOTING);
       lastUpdateCheck = millis();
     }
+    unsigned long elapsed = millis() - lastUpdateCheck;
+    untilCheck = elapsed < interval ? interval - elapsed : 0;
+    if (notifyUntilCheck() < untilCheck) untilCheck = notifyUntilCheck();
   }
+  powerIdle(untilCheck); // Sleep until the next scheduled work (OTA_Power.h)
 }
\ No newline at end of file
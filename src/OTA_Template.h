@@ -27,11 +27,27 @@
 #define OTA_TEMPLATE_H
 
 #include "OTA_WebConfig.h" // Include the web configuration header for web server handling
+#include "OTA_Router.h"    // Route parameters for custom endpoints (routeParam() etc.)
+#include "OTA_Progress.h"  // Live update progress (Server-Sent Events)
+#include "OTA_WiFi.h"      // Fast WiFi reconnect and connect metrics
+#include "OTA_Power.h"     // Energy modes and duty cycle estimate
+#include "OTA_Notify.h"    // Update beacons of the OTA server
+#include "OTA_Peer.h"      // Firmware distribution between devices in the LAN
+#include "OTA_Multicast.h" // Firmware distribution by multicast carousel
+#include "OTA_Verify.h"    // Signed manifest and image hash check
+#include "OTA_Client.h"    // Shared (TLS) connection to the OTA server
+#include "OTA_Mirror.h"    // OTA server mirrors, RTT based selection and failover
+#include "OTA_Dns.h"       // DNS cache and DNS-SD discovery of the OTA server
+#include "OTA_FileSync.h"  // Incremental update of the LittleFS files
+#include "OTA_Coap.h"      // Version check by CoAP
+#include "OTA_Arena.h"     // Scratch memory of requests and update checks
 
 #ifndef LED_BUILTIN
 #define LED_BUILTIN 2 // Default to GPIO2 if not defined, adjust as needed for your board
 #endif
 
+#define OTA_STATUS_PATH "/ota/status" // JSON with firmware and connection metrics (OTA_FEATURE_STATUS)
+
 // Initializes configuration, WiFi, and web server
 // See OTA_WebConfig.h for OTAConfig definition
 void otaSetup(const OTAConfig &defaults); // Changed to reference
@@ -39,4 +55,22 @@ void otaSetup(const OTAConfig &defaults); // Changed to reference
 // Main loop function to handle OTA logic and web server requests
 void otaLoop();
 
+#ifndef OTA_VERSION_PARTS
+#define OTA_VERSION_PARTS 8 // Max. numbers of a version string that are compared
+#endif
+
+// Splits a version string (e.g. "1.2.3") into at most max numbers, returns their count
+size_t splitVersion(const char *version, int *parts, size_t max);
+
+// Compares two version strings, returns -1 if v1 < v2, 1 if v1 > v2, 0 if equal
+int compareVersion(const char *v1, const char *v2);
+
+// Build the firmware and version URLs on the selected OTA server, false if buf is too small
+bool otaFirmwareUrl(char *buf, size_t size);
+bool otaVersionUrl(char *buf, size_t size);
+bool otaHashUrl(char *buf, size_t size);
+
+// SHA-256 of the firmware image (manifest or OTA server), false if not available
+bool otaImageHash(uint8_t sha[OTA_SHA256_SIZE]);
+
 #endif // OTA_TEMPLATE_H
\ No newline at end of file
@@ -79,7 +79,8 @@ const OTAConfig defaultOTAConfig = {
     APPNAME,               // appname
     FIRMWARE_NAME,         // firmware_name
     FIRMWARE_VERSION,      // firmware_vers
-    DESCRIPTION            // description
+    DESCRIPTION,           // description
+    OTA_MIRRORS            // otaMirrors
 };
 
 /**
@@ -92,6 +93,13 @@ void userSetup() {
     server.send(200, "text/plain", "Hello, world!");
     }, HTTP_GET);
 
+  // Endpoint with a path parameter, e.g. /hello/Ralf
+  registerCustomEndpoint("/hello/{name}", []() {
+    char name[32];
+    routeParamCopy("name", name, sizeof(name));
+    server.send(200, "text/plain", String("Hello, ") + name + "!");
+    }, HTTP_GET);
+
     pinMode(LED_BUILTIN, OUTPUT);
 }
 
@@ -101,10 +109,15 @@ void userSetup() {
  */
 void userLoop() {
   // TODO: Insert your own cyclic tasks here
-  digitalWrite(LED_BUILTIN, HIGH);  // turn the LED on (HIGH is the voltage level)
-  delay(1000);                      // wait for a second
-  digitalWrite(LED_BUILTIN, LOW);   // turn the LED off by making the voltage LOW
-  delay(1000);                      // wait for a second
+  // Toggle the LED every second without delay(), so the web server is served continuously
+  static unsigned long lastToggle = 0;
+  static bool ledOn = false;
+  if (millis() - lastToggle >= 1000) {
+    lastToggle = millis();
+    ledOn = !ledOn;
+    digitalWrite(LED_BUILTIN, ledOn ? HIGH : LOW);
+  }
+  powerWakeIn(1000 - (millis() - lastToggle)); // Next toggle, used by the energy modes (OTA_Power.h)
 }
 
 /**
@@ -0,0 +1,290 @@
+/**
+ * OTA_Verify.cpp
+ *
+ * Implementation of the manifest check and the verifying installer (see OTA_Verify.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_Verify.h"
+#include "OTA_Template.h"
+#include "OTA_Platform.h"
+
+#if OTA_VERIFY_SIGNED
+  #if defined(OTA_NATIVE)
+    #include <openssl/evp.h>
+    #include <openssl/x509.h>
+  #elif defined(ESP8266)
+    #include <bearssl/bearssl_ec.h>
+  #elif defined(ESP32)
+    #include <mbedtls/pk.h>
+  #endif
+#endif
+
+#define CHUNK_SIZE 1024              // Bytes per download write
+#define MAX_KEY 128                  // DER public key (P-256: 91 bytes)
+#define MAX_SIGNATURE 80             // DER ECDSA signature (P-256: max. 72 bytes)
+#define MAX_MANIFEST 384             // Manifest line and signature as hex
+
+static OTAManifest manifest = { false, false, "", 0, { 0 } };
+static OTAVerifyStats stats = { 0, 0, 0, 0 };
+
+#if OTA_VERIFY_SIGNED
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/**
+ * Decodes a hex string of at most size bytes. Returns the number of bytes, 0 on error.
+ */
+static size_t fromHex(const char *hex, uint8_t *buf, size_t size) {
+  size_t n = 0;
+  for (; hex[0] && hex[1] && n < size; hex += 2) {
+    int hi = hexValue(hex[0]);
+    int lo = hexValue(hex[1]);
+    if (hi < 0 || lo < 0) return 0;
+    buf[n++] = (uint8_t)(hi << 4 | lo);
+  }
+  return hex[0] ? 0 : n;
+}
+
+/**
+ * Checks the ECDSA P-256 signature (DER) of a SHA-256 hash with OTA_VERIFY_KEY.
+ */
+static bool checkSignature(const uint8_t hash[OTA_SHA256_SIZE], const uint8_t *sig, size_t sigLen) {
+  uint8_t key[MAX_KEY];
+  size_t keyLen = fromHex(OTA_VERIFY_KEY, key, sizeof(key));
+  if (keyLen == 0) {
+    Serial.println("Verify: OTA_VERIFY_KEY is not a valid hex string.");
+    return false;
+  }
+#if defined(OTA_NATIVE)
+  const uint8_t *p = key;
+  EVP_PKEY *pkey = d2i_PUBKEY(nullptr, &p, (long)keyLen);
+  EVP_PKEY_CTX *ctx = pkey ? EVP_PKEY_CTX_new(pkey, nullptr) : nullptr;
+  bool ok = ctx && EVP_PKEY_verify_init(ctx) == 1 && EVP_PKEY_CTX_set_signature_md(ctx, EVP_sha256()) == 1 &&
+            EVP_PKEY_verify(ctx, sig, sigLen, hash, OTA_SHA256_SIZE) == 1;
+  EVP_PKEY_CTX_free(ctx);
+  EVP_PKEY_free(pkey);
+  return ok;
+#elif defined(ESP8266)
+  // The uncompressed point is the last 65 bytes of the SubjectPublicKeyInfo
+  if (keyLen < 65 || key[keyLen - 65] != 0x04) return false;
+  br_ec_public_key pk = { BR_EC_secp256r1, key + keyLen - 65, 65 };
+  return br_ecdsa_i15_vrfy_asn1(br_ec_get_default(), hash, OTA_SHA256_SIZE, &pk, sig, sigLen) == 1;
+#elif defined(ESP32)
+  mbedtls_pk_context pk;
+  mbedtls_pk_init(&pk);
+  bool ok = mbedtls_pk_parse_public_key(&pk, key, keyLen) == 0 &&
+            mbedtls_pk_verify(&pk, MBEDTLS_MD_SHA256, hash, OTA_SHA256_SIZE, sig, sigLen) == 0;
+  mbedtls_pk_free(&pk);
+  return ok;
+#endif
+}
+
+#endif // OTA_VERIFY_SIGNED
+
+bool verifySignature(const uint8_t hash[OTA_SHA256_SIZE], const char *sigHex) {
+#if OTA_VERIFY_SIGNED
+  uint8_t sig[MAX_SIGNATURE];
+  size_t sigLen = fromHex(sigHex, sig, sizeof(sig));
+  return sigLen > 0 && checkSignature(hash, sig, sigLen);
+#else
+  (void)hash;
+  (void)sigHex;
+  return false;
+#endif
+}
+
+/**
+ * Parses and checks a manifest, see OTA_Verify.h for the format.
+ */
+static bool parseManifest(char *text, const char *version) {
+  char *eol = strchr(text, '\n');
+  if (eol) *eol = '\0'; // text is the manifest line now, the signature follows
+  char name[32];
+  char vers[16];
+  char hex[OTA_SHA256_HEX_SIZE];
+  unsigned long size;
+  if (sscanf(text, "OTA1M %31s %15s %lu %64s", name, vers, &size, hex) != 4 ||
+      !OTASha256::fromHex(hex, manifest.sha)) {
+    Serial.println("Verify: manifest not readable.");
+    return false;
+  }
+  // A signed manifest must name the expected version, otherwise an older signed image
+  // could be offered as update; "-" (no version on the server) is only accepted unsigned
+  bool versionOk = strcmp(version, vers) == 0 || (!OTA_VERIFY_SIGNED && strcmp(vers, "-") == 0);
+  if (strcmp(name, config.firmware_name) != 0 || !versionOk) {
+    Serial.printf("Verify: manifest is for %s %s, expected %s %s\n", name, vers, config.firmware_name, version);
+    return false;
+  }
+#if OTA_VERIFY_SIGNED
+  const char *sigHex = eol ? eol + 1 : "";
+  while (isspace((unsigned char)*sigHex)) sigHex++;
+  uint8_t hash[OTA_SHA256_SIZE];
+  OTASha256 lineHash;
+  lineHash.update((const uint8_t *)text, strlen(text));
+  lineHash.finish(hash);
+  if (!verifySignature(hash, sigHex)) {
+    Serial.println("Verify: manifest signature not valid.");
+    return false;
+  }
+  manifest.authentic = true;
+#endif
+  strcpy(manifest.version, vers);
+  manifest.size = size;
+  manifest.valid = true;
+  return true;
+}
+
+bool verifyLoadManifest(const char *version) {
+  memset(&manifest, 0, sizeof(manifest));
+  OTAArenaScope scope; // The text is only needed until it is parsed (OTA_Arena.h)
+  char *text = (char *)arenaAlloc(MAX_MANIFEST);
+  if (!text) return false;
+  char url[128];
+  const OTAMirror &m = mirrorCurrent();
+  int n = snprintf(url, sizeof(url), OTA_SCHEME "://%s:%d%s%s", m.host, m.port, OTA_MANIFEST_PATH, config.firmware_name);
+  if (n <= 0 || (size_t)n >= sizeof(url)) return false;
+  HTTPClient http;
+  int code = -1;
+  int len = -1;
+  if (clientBegin(http, url)) {
+    code = http.GET();
+    if (code == HTTP_CODE_OK) len = clientReadBody(http, text, MAX_MANIFEST);
+    http.end();
+  }
+  if (code == HTTP_CODE_OK && len >= 0 && parseManifest(text, version)) {
+    Serial.printf("Verify: manifest of version %s, %lu bytes, %s\n", version, (unsigned long)manifest.size,
+                  manifest.authentic ? "signature valid" : "unsigned");
+    return true;
+  }
+  manifest.valid = false;
+  if (code == HTTP_CODE_OK || OTA_VERIFY_SIGNED) {
+    if (code != HTTP_CODE_OK) Serial.printf("Verify: no manifest on the OTA server, HTTP code %d\n", code);
+    stats.rejected++;
+    return false;
+  }
+  Serial.println("Verify: OTA server provides no manifest, image not verified.");
+  return true;
+}
+
+const OTAManifest &verifyManifest() {
+  return manifest;
+}
+
+/**
+ * Discards a started update, the old firmware stays active.
+ */
+static void abortUpdate() {
+  OTAPlatform::updateAbort();
+}
+
+// Image between verifyBegin() and verifyEnd()
+static OTASha256 imageHash;
+static const uint8_t *imageSha = nullptr;
+static size_t imageSize = 0;
+static size_t imageDone = 0;
+static size_t imageTail = 0;         // Bytes of the last chunk held back in imageBuf
+static uint32_t imageHashUs = 0;
+static uint8_t imageBuf[CHUNK_SIZE];
+
+void verifyBegin(size_t size, const uint8_t *sha) {
+  imageHash.begin();
+  imageSha = sha;
+  imageSize = size;
+  imageDone = 0;
+  imageTail = 0;
+  imageHashUs = 0;
+}
+
+bool verifyWrite(WiFiClient *stream, unsigned long timeout) {
+  unsigned long lastData = millis();
+  while (imageDone < imageSize && millis() - lastData < timeout) {
+    size_t avail = stream->available();
+    if (!avail) {
+      if (!stream->connected()) break;
+      delay(1);
+      continue;
+    }
+    size_t want = imageSize - imageDone;
+    if (want > sizeof(imageBuf)) want = sizeof(imageBuf);
+    if (avail < want) want = avail;
+    size_t n = stream->readBytes(imageBuf, want);
+    if (!n) continue;
+    unsigned long start = micros();
+    imageHash.update(imageBuf, n);
+    imageHashUs += micros() - start;
+    lastData = millis();
+    if (imageDone + n == imageSize) {
+      imageTail = n;
+    } else if (Update.write(imageBuf, n) != n) {
+      Serial.printf("Verify: flash write failed, error %d\n", (int)Update.getError());
+      imageSize = 0;                 // Not resumable, verifyEnd() discards the update
+      return false;
+    }
+    imageDone += n;
+    progressUpdate(imageDone, imageSize);
+  }
+  return true;
+}
+
+size_t verifyWritten() {
+  return imageDone;
+}
+
+OTAInstallResult verifyEnd() {
+  stats.hashUs = imageHashUs;
+  stats.bytes = imageDone;
+
+  uint8_t digest[OTA_SHA256_SIZE];
+  imageHash.finish(digest);
+  if (imageSize == 0 || imageDone != imageSize) {
+    Serial.printf("Verify: download incomplete (%u of %u bytes)\n", (unsigned)imageDone, (unsigned)imageSize);
+    abortUpdate();
+    return OTA_INSTALL_FAILED;
+  }
+  if (imageSha && memcmp(digest, imageSha, OTA_SHA256_SIZE) != 0) {
+    Serial.println("Verify: image hash does not match, update rejected.");
+    abortUpdate();
+    stats.rejected++;
+    return OTA_INSTALL_REJECTED;
+  }
+  if (Update.write(imageBuf, imageTail) != imageTail || !Update.end()) {
+    Serial.printf("Verify: update failed, error %d\n", (int)Update.getError());
+    abortUpdate();
+    return OTA_INSTALL_FAILED;
+  }
+  if (imageSha) stats.verified++;
+  Serial.printf("Verify: %u bytes hashed in %lu us\n", (unsigned)imageDone, (unsigned long)imageHashUs);
+  return OTA_INSTALL_OK;
+}
+
+OTAInstallResult verifyInstall(WiFiClient *stream, size_t size, const uint8_t *sha, unsigned long timeout) {
+  verifyBegin(size, sha);
+  verifyWrite(stream, timeout);
+  return verifyEnd();
+}
+
+const OTAVerifyStats &verifyStats() {
+  return stats;
+}
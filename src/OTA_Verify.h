@@ -0,0 +1,124 @@
+/**
+ * OTA_Verify.h
+ *
+ * Image verification for the OTA Template. Before an update the device loads a
+ * small manifest of the new image from the OTA server (GET /manifest/<firmware>):
+ *
+ *   OTA1M <firmware name> <version> <size> <sha256>
+ *   <ECDSA P-256 signature of the first line, DER as hex>
+ *
+ * If the firmware is built with the public key of the server (OTA_VERIFY_KEY), only
+ * manifests with a valid signature are accepted and updates without one are refused.
+ * Without a key the manifest is used unsigned, for integrity only.
+ *
+ * verifyInstall() writes a downloaded image to the update partition and hashes it
+ * chunk by chunk on the way, so no second pass over the flash is needed (the ESP32
+ * hashes with its SHA accelerator through mbedTLS). The last chunk is held back: it is
+ * only written, and Update.end() only called, if the hash matches the manifest.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_VERIFY_H
+#define OTA_VERIFY_H
+
+#include <Arduino.h>
+#include "OTA_Sha256.h"
+
+#if defined(ESP8266)
+  #include <ESP8266WiFi.h>
+#elif defined(ESP32)
+  #include <WiFi.h>
+#endif
+
+// OTA_VERIFY_KEY: public key of the server as hex string (DER SubjectPublicKeyInfo of a
+// P-256 key, printed by ota-server.js at startup), e.g. -DOTA_VERIFY_KEY=\"3059...\"
+#ifdef OTA_VERIFY_KEY
+#define OTA_VERIFY_SIGNED 1                // Manifest signature required
+#else
+#define OTA_VERIFY_SIGNED 0
+#endif
+#ifndef OTA_VERIFY_TIMEOUT
+#define OTA_VERIFY_TIMEOUT 8000            // Download aborted without data for this time (ms)
+#endif
+
+#define OTA_MANIFEST_PATH "/manifest/"
+
+struct OTAManifest {
+  bool valid;                        // Manifest loaded for the current update
+  bool authentic;                    // Signature checked with OTA_VERIFY_KEY
+  char version[16];                  // "-" if the server does not know the version
+  uint32_t size;
+  uint8_t sha[OTA_SHA256_SIZE];
+};
+
+enum OTAInstallResult {
+  OTA_INSTALL_OK,                    // Image verified and committed (restart required)
+  OTA_INSTALL_FAILED,                // Download or flash error
+  OTA_INSTALL_REJECTED               // Complete image with wrong hash
+};
+
+struct OTAVerifyStats {
+  uint32_t verified;      // Images committed after the hash check
+  uint32_t rejected;      // Images and manifests rejected
+  uint32_t hashUs;        // Time spent hashing the last image (us)
+  uint32_t bytes;         // Size of the last image
+};
+
+/**
+ * Loads and checks the manifest of version from the OTA server.
+ * @return false if the update must not be installed: manifest missing (OTA_VERIFY_SIGNED)
+ *         or signature, firmware name or version do not match
+ */
+bool verifyLoadManifest(const char *version);
+
+/**
+ * Checks an ECDSA P-256 signature (DER as hex) of a SHA-256 hash with OTA_VERIFY_KEY,
+ * e.g. of the file manifest (OTA_FileSync.h). Always false without OTA_VERIFY_KEY.
+ */
+bool verifySignature(const uint8_t hash[OTA_SHA256_SIZE], const char *sigHex);
+
+/**
+ * Returns the manifest of the current update (valid = false: server has none).
+ */
+const OTAManifest &verifyManifest();
+
+/**
+ * Writes size bytes from stream to the update partition while hashing them. The
+ * caller has called Update.begin(size). With sha == nullptr (no manifest) the image
+ * is committed unchecked.
+ */
+OTAInstallResult verifyInstall(WiFiClient *stream, size_t size, const uint8_t *sha, unsigned long timeout);
+
+/**
+ * verifyInstall() in steps, for images loaded from several streams (download resumed
+ * on a mirror, OTA_Mirror.h): verifyBegin(), verifyWrite() for each stream, which
+ * continues at verifyWritten(), and verifyEnd() to check and commit the image.
+ * verifyWrite() returns false on a flash error, the update cannot be resumed then.
+ */
+void verifyBegin(size_t size, const uint8_t *sha);
+bool verifyWrite(WiFiClient *stream, unsigned long timeout);
+size_t verifyWritten();
+OTAInstallResult verifyEnd();
+
+/**
+ * Returns the verification statistics of the current boot.
+ */
+const OTAVerifyStats &verifyStats();
+
+#endif // OTA_VERIFY_H
@@ -43,9 +43,10 @@
  */
 
 
-#include <EEPROM.h>
-#include "OTA_WebConfig.h"
+#include "OTA_WebConfig.h" // Platform layer and EEPROM (OTA_Platform.h)
 #include "OTA_WebForm.h"  // HTML form for the web interface
+#include "OTA_Router.h"   // Prefix trie router for all endpoints
+#include "OTA_Arena.h"    // Scratch memory of the requests
 
 
 
@@ -53,27 +54,181 @@
 OTAConfig config; // Global configuration structure
 const OTAConfig *defaults; // Pointer to default configuration structure
 
-#if defined(ESP8266)
-  ESP8266WebServer server(config.webServerPort);
-#elif defined(ESP32)
-  WebServer server(config.webServerPort);
-#endif
+// The port is set in startWebServer(), the configuration is not loaded yet at this point
+WebConfigServer server(80);
+
 
+// EEPROM.put() silently ignores objects that do not fit, so check the layout at compile time
+static_assert(sizeof(OTAConfig) <= EEPROM_WIFI_CACHE_START - EEPROM_START, "OTAConfig does not fit into EEPROM");
 
 // Call this function in setup() to check if OTAConfig struct fits in EEPROM
 void checkConfigSize() {
-    if (sizeof(OTAConfig) > EEPROM_SIZE) {
+    if (sizeof(OTAConfig) > EEPROM_WIFI_CACHE_START - EEPROM_START) {
         Serial.println("WARNING: OTAConfig struct size exceeds EEPROM_SIZE! Data may be lost.");
     }
 }
 
+#if defined(OTA_ASYNC_WEBSERVER)
+/**
+ * Print that keeps the bytes [offset, offset + size) of its output in buf.
+ */
+class RangePrint : public Print {
+public:
+  RangePrint(char *buf, size_t size, size_t offset) : buf(buf), size(size), offset(offset), pos(0), len(0) {}
+  using Print::write;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *data, size_t n) override {
+    size_t skip = pos < offset ? offset - pos : 0; // Bytes before the range
+    if (skip > n) skip = n;
+    size_t k = n - skip < size - len ? n - skip : size - len;
+    memcpy(buf + len, data + skip, k);
+    len += k;
+    pos += n;
+    return n;
+  }
+  size_t length() const { return len; }
+  size_t total() const { return pos; }
+  bool complete() const { return pos <= offset + len; } // The output ended within the range
+
+private:
+  char *buf;
+  size_t size;
+  size_t offset;
+  size_t pos;
+  size_t len;
+};
+
+// Form values of the responses in progress, a slot is free when its count drops to 0
+static HtmlFormValues formValues[OTA_WEB_FORMS];
+static uint8_t formRefs[OTA_WEB_FORMS];
+
+/**
+ * Reference to a slot of formValues, held by the content filler of a form. The slot
+ * is released with the filler, also if the connection is closed before the end.
+ */
+class FormSlot {
+public:
+  explicit FormSlot(uint8_t slot) : slot(slot) { formRefs[slot]++; }
+  FormSlot(const FormSlot &other) : slot(other.slot) { formRefs[slot]++; }
+  ~FormSlot() { formRefs[slot]--; }
+  const HtmlFormValues &values() const { return formValues[slot]; }
+
+private:
+  FormSlot &operator=(const FormSlot &);
+  uint8_t slot;
+};
+
+/**
+ * Sends the HTML form piece by piece as the transmit queue of the event driven server
+ * has room. The values are copied once when the response starts; each piece continues
+ * at the part of the form (htmlFormPart()) it starts in, only that part is written
+ * again and the requested range kept, so the page is never held in memory.
+ */
+static void sendForm() {
+  uint8_t slot = 0;
+  while (slot < OTA_WEB_FORMS && formRefs[slot]) ++slot;
+  if (slot == OTA_WEB_FORMS) {
+    server.send(503, "text/plain", "Busy");
+    return;
+  }
+  htmlFormValues(formValues[slot]);
+  FormSlot form(slot);
+  uint8_t part = 0;
+  size_t partStart = 0; // Body offset of part
+  sendContentFiller(200, "text/html", CONTENT_LENGTH_UNKNOWN,
+                    [form, part, partStart](char *buf, size_t size, size_t offset) mutable {
+    size_t len = 0;
+    while (len < size && part < HTML_FORM_PARTS) {
+      RangePrint out(buf + len, size - len, offset + len - partStart);
+      htmlFormPart(out, form.values(), part);
+      len += out.length();
+      if (!out.complete()) break;
+      partStart += out.total();
+      part++;
+    }
+    return len;
+  });
+}
+#else
+/**
+ * Print that collects the output in a buffer and sends it as a chunk of the response
+ * whenever the buffer is full.
+ */
+class ChunkPrint : public Print {
+public:
+  ChunkPrint(char *buf, size_t size) : buf(buf), size(size), len(0) {}
+  using Print::write;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *data, size_t n) override {
+    for (size_t left = n; left;) {
+      if (len == size) flush();
+      size_t k = left < size - len ? left : size - len;
+      memcpy(buf + len, data, k);
+      len += k;
+      data += k;
+      left -= k;
+    }
+    return n;
+  }
+  void flush() override {
+    if (len) server.sendContent(buf, len); // Never empty, that would end the response
+    len = 0;
+  }
+
+private:
+  char *buf;
+  size_t size;
+  size_t len;
+};
+
+/**
+ * Sends the HTML form in chunks of OTA_WEB_CHUNK bytes from the arena (OTA_Arena.h),
+ * so the page never needs a large contiguous block of the heap.
+ */
+static void sendForm() {
+  char *buf = (char *)arenaAlloc(OTA_WEB_CHUNK);
+  HtmlFormValues *values = (HtmlFormValues *)arenaAlloc(sizeof(HtmlFormValues));
+  if (!buf || !values) {
+    server.send(503, "text/plain", "Out of memory");
+    return;
+  }
+  htmlFormValues(*values);
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/html", "");
+  ChunkPrint out(buf, OTA_WEB_CHUNK);
+  htmlForm(out, *values);
+  out.flush();
+}
+#endif
+
+/**
+ * Copies the form field name into buf (empty if it is missing), truncated to size.
+ */
+static void argCopy(const char *name, char *buf, size_t size) {
+#if defined(OTA_ASYNC_WEBSERVER)
+  const char *value = server.argValue(name); // Points into the request, no String
+  snprintf(buf, size, "%s", value ? value : "");
+#else
+  snprintf(buf, size, "%s", server.arg(name).c_str()); // The String is released right away
+#endif
+}
+
+/**
+ * Returns the form field name as number, 0 if it is missing.
+ */
+static long argInt(const char *name) {
+  char number[12];
+  argCopy(name, number, sizeof(number));
+  return atol(number);
+}
+
 /**
  * handleRoot()
  * Called when the root page ("/") is opened in the browser.
  * Sends the HTML configuration form to the client.
  */
 void handleRoot() {
-  server.send(200, "text/html", htmlForm());
+  sendForm();
 }
 
 /**
@@ -81,36 +236,30 @@ void handleRoot() {
  * Called when the configuration form is submitted (POST to "/set").
  * Reads the form data, stores it in the OTAConfig structure, and writes it to EEPROM.
  * Detects if a restart is requested and restarts the device if necessary.
+ * The fields are copied one by one into the configuration, no Strings are kept.
  */
 void handleSet() {
   // Check for reset to defaults
-  if (server.hasArg("resetDefaults") && server.arg("resetDefaults") == "1") {
+  if (argInt("resetDefaults") == 1) {
     // Set all config fields to defaults
     setDefaultConfig(config, defaults);
     // Save defaults to EEPROM using the helper function
     saveConfigToEEPROM();
 
     // Redisplay the form with default values
-    server.send(200, "text/html", htmlForm());
+    sendForm();
     return;
   }
 
-  String ssid = server.arg("ssid");
-  String password = server.arg("password");
-  String otaServer = server.arg("otaServer");
-  String otaPort = server.arg("otaPort");
-  String otaEnabled = server.arg("otaEnabled");
-  String otaUpdateInterval = server.arg("otaUpdateInterval");
-  String webServerPort = server.arg("webServerPort");
-
   // Copy values into the OTAConfig structure
-  ssid.toCharArray(config.ssid, sizeof(config.ssid));
-  password.toCharArray(config.password, sizeof(config.password));
-  otaServer.toCharArray(config.otaServer, sizeof(config.otaServer));
-  config.otaPort = otaPort.toInt();
-  config.otaEnabled = (otaEnabled == "1");
-  config.otaUpdateInterval = otaUpdateInterval.toInt();
-  config.webServerPort = webServerPort.toInt();
+  argCopy("ssid", config.ssid, sizeof(config.ssid));
+  argCopy("password", config.password, sizeof(config.password));
+  argCopy("otaServer", config.otaServer, sizeof(config.otaServer));
+  config.otaPort = argInt("otaPort");
+  config.otaEnabled = argInt("otaEnabled") == 1;
+  config.otaUpdateInterval = argInt("otaUpdateInterval");
+  config.webServerPort = argInt("webServerPort");
+  argCopy("otaMirrors", config.otaMirrors, sizeof(config.otaMirrors));
 
   // Write configuration to EEPROM
   saveConfigToEEPROM();
@@ -118,7 +267,7 @@ void handleSet() {
   Serial.println("Configuration saved to EEPROM.");
 
   // Check if a restart is requested
-  if (server.hasArg("restart") && server.arg("restart") == "1") {
+  if (argInt("restart") == 1) {
     server.send(200, "text/plain", "Configuration saved. Restarting...");
     delay(500);
     ESP.restart();
@@ -145,13 +294,14 @@ void setDefaultConfig(OTAConfig &cfg, const OTAConfig *defaults) {
     strcpy(cfg.appname, defaults->appname);
     strcpy(cfg.firmware_name, defaults->firmware_name);
     strcpy(cfg.description, defaults->description);
+    strcpy(cfg.otaMirrors, defaults->otaMirrors);
 }
 
 /**
  * loadConfig()
  * Loads the configuration from EEPROM into the global OTAConfig structure.
  * If no valid data is present, default values are set.
- * Prints the loaded values to the serial interface.
+ * Prints the loaded values to the serial interface (OTA_FEATURE_CONFIG_DUMP).
  */
 void loadConfig(const OTAConfig *default_config) {
   defaults = default_config; // Set the defaults pointer to the provided default config
@@ -159,33 +309,44 @@ void loadConfig(const OTAConfig *default_config) {
   config = readConfigFromEEPROM();
 
   // Check if the SSID is valid (simple check)
-  if (config.ssid[0] == '\0' || config.ssid[0] == 0xFF) {
+  if (config.ssid[0] == '\0' || (uint8_t)config.ssid[0] == 0xFF) {
     setDefaultConfig(config, defaults);
     Serial.println("EEPROM empty, loaded default values.");
   } else {
     Serial.println("Configuration loaded from EEPROM.");
   }
+  // Configurations saved before the mirror list was added have no valid string there
+  if ((uint8_t)config.otaMirrors[0] == 0xFF || !memchr(config.otaMirrors, '\0', sizeof(config.otaMirrors))) {
+    strcpy(config.otaMirrors, defaults ? defaults->otaMirrors : "");
+  }
 
+#if OTA_FEATURE_CONFIG_DUMP
   Serial.printf("SSID: %s\n", config.ssid);
   Serial.printf("Password: %s\n", config.password);
   Serial.printf("OTA Server: %s\n", config.otaServer);
   Serial.printf("OTA Port: %d\n", config.otaPort);
+  if (config.otaMirrors[0]) Serial.printf("OTA Mirrors: %s\n", config.otaMirrors);
   Serial.printf("OTA Enabled: %s\n", config.otaEnabled ? "true" : "false");
   Serial.printf("Firmware Version: %s\n", config.firmware_vers);
   Serial.printf("App Name: %s\n", config.appname);
   Serial.printf("Firmware Name: %s\n", config.firmware_name);
+#if OTA_FEATURE_DESCRIPTION
   Serial.printf("Description: %s\n", config.description);
+#endif
+#endif
 }
 
 /**
  * startWebServer()
  * Initializes the web server, registers the handlers for the root page and setting the configuration.
- * Starts the web server.
+ * All endpoints are routed by the router (OTA_Router.cpp), which is installed as the only
+ * handler of the web server. Starts the web server.
  */
 void startWebServer() {
-  server.on(OTA_CONFIG_ROOT, handleRoot); // Use OTA_CONFIG_ROOT for the root page
-  server.on(OTA_CONFIG_SET, HTTP_POST, handleSet); // Use OTA_CONFIG_SET for the config set endpoint
-  server.begin();
+  routerAdd(OTA_CONFIG_ROOT, OTA_METHOD_ANY, handleRoot); // Use OTA_CONFIG_ROOT for the root page
+  routerAdd(OTA_CONFIG_SET, OTA_METHOD(HTTP_POST), handleSet); // Use OTA_CONFIG_SET for the config set endpoint
+  server.onNotFound(routerDispatch);
+  server.begin(config.webServerPort);
   Serial.println("Web server started.");
 }
 
@@ -203,19 +364,12 @@ void handleWebServer() {
  * Saves the current configuration to EEPROM.
  */
 void saveConfigToEEPROM() {
-#if defined(ESP8266)
-  EEPROM.begin(EEPROM_SIZE);
-  EEPROM.put(EEPROM_START, config);
-  EEPROM.commit();
-#elif defined(ESP32)
-  if (!EEPROM.begin(EEPROM_SIZE)) {
-    Serial.println("Failed to initialise EEPROM for ESP32");
+  if (!OTAPlatform::eepromBegin(EEPROM_SIZE)) {
+    Serial.println("Failed to initialise EEPROM");
     return;
   }
   EEPROM.put(EEPROM_START, config);
-  EEPROM.commit();
-  EEPROM.end();
-#endif
+  OTAPlatform::eepromEnd(true);
 }
 
 /**
@@ -224,26 +378,23 @@ void saveConfigToEEPROM() {
  */
 OTAConfig readConfigFromEEPROM() {
   OTAConfig cfg;
-#if defined(ESP8266)
-  EEPROM.begin(EEPROM_SIZE);
-  EEPROM.get(EEPROM_START, cfg);
-#elif defined(ESP32)
-  if (!EEPROM.begin(EEPROM_SIZE)) {
-    Serial.println("Failed to initialise EEPROM for ESP32");
+  if (!OTAPlatform::eepromBegin(EEPROM_SIZE)) {
+    Serial.println("Failed to initialise EEPROM");
     memset(&cfg, 0, sizeof(cfg));
     return cfg;
   }
   EEPROM.get(EEPROM_START, cfg);
-  EEPROM.end();
-#endif
+  OTAPlatform::eepromEnd(false);
   return cfg;
 }
 
 /**
  * registerCustomEndpoint
  * Registers an additional endpoint and its handler function with the web server.
+ * The URI may contain parameter segments, e.g. "/sensor/{id}", which are read in
+ * the handler with routeParam()/routeParamCopy()/routeParamInt() (see OTA_Router.h).
  * 
- * @param uri The URI path for the endpoint (e.g. "/custom")
+ * @param uri The URI path or pattern for the endpoint (e.g. "/custom")
  * @param handler The function to handle requests to this endpoint
  * @param method (optional) HTTP method (default: HTTP_GET)
  *
@@ -251,5 +402,67 @@ OTAConfig readConfigFromEEPROM() {
  *   registerCustomEndpoint("/custom", []() { server.send(200, "text/plain", "Hello from custom endpoint!"); });
  */
 void registerCustomEndpoint(const String& uri, std::function<void(void)> handler, HTTPMethod method) {
-    server.on(uri.c_str(), method, handler);
-}
\ No newline at end of file
+    routerAdd(uri.c_str(), routeMethodBit(method), handler);
+}
+
+/**
+ * registerCustomEndpoint
+ * Same as above, but accepts a mask of several methods,
+ * e.g. OTA_METHOD(HTTP_GET) | OTA_METHOD(HTTP_POST).
+ */
+void registerCustomEndpoint(const String& uri, std::function<void(void)> handler, uint32_t methodMask) {
+    routerAdd(uri.c_str(), methodMask, handler);
+}
+
+/**
+ * sendContentFiller
+ * Sends a response whose body is produced by filler (see OTA_WebConfig.h).
+ */
+void sendContentFiller(int code, const char *contentType, size_t length, ContentFiller filler) {
+#if defined(OTA_ASYNC_WEBSERVER)
+  server.sendContentFiller(code, contentType, length, filler);
+#else
+  char *buf = (char *)arenaAlloc(OTA_WEB_CHUNK);
+  if (!buf) {
+    server.send(503, "text/plain", "Out of memory");
+    return;
+  }
+  server.setContentLength(length);
+  server.send(code, contentType, "");
+  for (size_t offset = 0; length == CONTENT_LENGTH_UNKNOWN || offset < length;) {
+    size_t max = OTA_WEB_CHUNK;
+    if (length != CONTENT_LENGTH_UNKNOWN && length - offset < max) max = length - offset;
+    size_t n = filler(buf, max, offset);
+    if (n == 0 || n > max) break;
+    server.sendContent(buf, n);
+    offset += n;
+  }
+#endif
+}
+
+/**
+ * jsonEscape
+ * Escapes text for a JSON string (see OTA_WebConfig.h).
+ */
+const char *jsonEscape(char *buf, size_t size, const char *text) {
+  size_t used = 0;
+  for (; *text; ++text) {
+    unsigned char c = (unsigned char)*text;
+    char esc[8];
+    size_t n = 1;
+    if (c == '"' || c == '\\') {
+      esc[0] = '\\';
+      esc[1] = (char)c;
+      n = 2;
+    } else if (c < 0x20) {
+      n = snprintf(esc, sizeof(esc), "\\u%04x", c);
+    } else {
+      esc[0] = (char)c;
+    }
+    if (used + n >= size) break;
+    memcpy(buf + used, esc, n);
+    used += n;
+  }
+  buf[used] = '\0';
+  return buf;
+}
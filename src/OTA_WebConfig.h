@@ -37,22 +37,29 @@
 #ifndef OTA_WEBCONFIG_H
 #define OTA_WEBCONFIG_H
 
-#if defined(ESP8266)
-  #include <ESP8266WebServer.h>
-  #include <functional>
-  typedef ESP8266WebServer WebConfigServer;
-#elif defined(ESP32)
-  #include <WebServer.h>
-  #include <functional>
-  typedef WebServer WebConfigServer;
+#include <functional>
+#include "OTA_Platform.h"        // Platform traits, core headers of the target
+
+#if defined(OTA_ASYNC_WEBSERVER)
+  #include "OTA_AsyncServer.h"   // Event driven backend, selected in platformio.ini
+  typedef OTAAsyncServer WebConfigServer;
+#else
+  typedef OTAPlatform::HttpServer WebConfigServer;
 #endif
 
 // Static configurations and constants used
 #define OTA_CONFIG_VERSION "1.0.0"      // Version of the OTA configuration system
 #define OTA_CONFIG_ROOT "/ota"          // Root path for OTA updates on the ota-server
 #define OTA_CONFIG_SET "/ota/set"       // Path for setting OTA configuration via web interface
-#define EEPROM_SIZE 256                 // Size of the EEPROM region used for storing configuration
+#define EEPROM_SIZE 1024                // Size of the EEPROM region used for storing configuration
 #define EEPROM_START 0                  // Start address in EEPROM for storing configuration data
+#define EEPROM_WIFI_CACHE_START 960     // Start address of the cached WiFi connection data (OTA_WiFi.h)
+#ifndef OTA_WEB_CHUNK
+#define OTA_WEB_CHUNK 512               // Chunk size of the HTML form, taken from the arena (OTA_Arena.h)
+#endif
+#ifndef OTA_WEB_FORMS
+#define OTA_WEB_FORMS 2                 // Forms the event driven server sends at the same time
+#endif
 
 struct OTAConfig {
   char ssid[32];               // WiFi SSID for network connection
@@ -66,6 +73,7 @@ struct OTAConfig {
   char firmware_name[32];      // Firmware binary file name on the OTA server
   char firmware_vers[16];      // Current firmware version string
   char description[256];       // Description of the device/application for the web interface
+  char otaMirrors[96];         // Further OTA servers "host[:port]", comma separated (OTA_Mirror.h)
 };
 
 typedef struct OTAConfig OTAConfig;
@@ -129,7 +137,31 @@ void handleWebServer();
 
 /**
  * Registers a custom web endpoint for the configuration server.
+ * The URI may contain parameter segments like "/sensor/{id}".
  */
 void registerCustomEndpoint(const String& uri, std::function<void(void)> handler, HTTPMethod method);
 
+/**
+ * Registers a custom web endpoint for a mask of HTTP methods (see OTA_METHOD() in OTA_Router.h).
+ */
+void registerCustomEndpoint(const String& uri, std::function<void(void)> handler, uint32_t methodMask);
+
+// Writes the body bytes from offset on into buf (at most size, at least 64 unless fewer
+// are left) and returns their number; 0 ends a body of unknown length
+typedef std::function<size_t(char *buf, size_t size, size_t offset)> ContentFiller;
+
+/**
+ * Sends a response whose body of length bytes (CONTENT_LENGTH_UNKNOWN: chunked) is
+ * produced piece by piece by filler. The event driven server (OTA_AsyncServer.h) calls
+ * the filler whenever its transmit queue has room, the synchronous servers right away.
+ */
+void sendContentFiller(int code, const char *contentType, size_t length, ContentFiller filler);
+
+/**
+ * Copies text into buf (size bytes, terminated) as the content of a JSON string:
+ * quote, backslash and control characters are escaped, a text that does not fit is
+ * cut before the escape that would overflow. Returns buf.
+ */
+const char *jsonEscape(char *buf, size_t size, const char *text);
+
 #endif // OTA_WEBCONFIG_H
@@ -2,9 +2,10 @@
  * OTA_WebForm.h
  *
  * Provides the HTML form and related logic for the web-based configuration interface
- * of the OTA Template project. The htmlForm() function generates and returns the complete
- * HTML page as a string, including all input fields for WiFi, OTA server, firmware information,
- * and control buttons. The form reflects the current values from the global OTAConfig instance.
+ * of the OTA Template project. The htmlForm() function writes the complete
+ * HTML page to a Print, including all input fields for WiFi, OTA server, firmware information,
+ * and control buttons. The form reflects the values of the global OTAConfig instance and the
+ * server selection, copied by htmlFormValues() when the response starts.
  *
  * Any changes to this file directly affect the device's web configuration interface.
  *
@@ -31,19 +32,53 @@
 #define OTA_WEBFORM_H
 
 #include "OTA_WebConfig.h" // For OTAConfig definition
+#include "OTA_Mirror.h"    // Server selection and RTT of the mirrors
 
 
-// Returns the HTML form as a String
-inline String htmlForm() {
-  String form = R"rawliteral(
+#define HTML_FORM_PARTS 10
+
+/**
+ * Values shown on the form, copied once per response by htmlFormValues(). A page sent
+ * in pieces shows one state of the configuration even if it is changed meanwhile.
+ */
+struct HtmlFormValues {
+  OTAConfig config;
+  OTAMirror mirrors[OTA_MIRROR_MAX];
+  uint8_t mirrorCount;
+  uint8_t mirrorIndex;
+};
+
+/**
+ * Copies the configuration and the server selection into v.
+ */
+inline void htmlFormValues(HtmlFormValues &v) {
+  v.config = config;
+  v.mirrorCount = mirrorCount();
+  for (uint8_t i = 0; i < v.mirrorCount; ++i) v.mirrors[i] = mirrorAt(i);
+  v.mirrorIndex = mirrorIndex();
+}
+
+/**
+ * Writes part (0 .. HTML_FORM_PARTS - 1) of the HTML form to out. The event driven
+ * server resumes the page at the part of the next piece instead of writing it again
+ * from the start (OTA_WebConfig.cpp).
+ */
+inline void htmlFormPart(Print &out, const HtmlFormValues &v, uint8_t part) {
+  switch (part) {
+  case 0:
+    out.print(R"rawliteral(
 <!DOCTYPE html>
 <html>
 <head>
   <meta charset="UTF-8">
-  <title>)rawliteral";
-  form += String(config.appname); // Use appname as title
-  form += R"rawliteral(</title>
-  <style>
+  <title>)rawliteral");
+    out.print(v.config.appname); // Use appname as title
+    out.print(R"rawliteral(</title>
+)rawliteral");
+    break;
+  case 1:
+#if OTA_FEATURE_FORM_STYLE
+    out.print(R"rawliteral(  <style>
     body {
       background-color: #f0f0f0; /* light grey */
       font-family: Arial, sans-serif;
@@ -93,7 +128,11 @@ inline String htmlForm() {
       background-color: #b71c1c;
     }
   </style>
-  <script>
+)rawliteral");
+#endif
+    break;
+  case 2:
+    out.print(R"rawliteral(  <script>
     function resetDefaults() {
       if(confirm('Reset all settings to default values?')) {
         var form = document.forms[0];
@@ -109,13 +148,17 @@ inline String htmlForm() {
 </head>
 <body>
   <div class="form-frame">
-    <h1 style="text-align:center;">)rawliteral";
-  form += String(config.appname); // Use appname as main heading
-  form += R"rawliteral(</h1>
-    <h2 style="text-align:center; color:#003366; font-size:1.2em; margin-top:-10px; margin-bottom:24px;">)rawliteral";
-  form += String(config.firmware_vers); // Firmware version as subtitle
-  form += R"rawliteral(</h2>
-    <div style="text-align:center; margin-bottom:20px;">
+    <h1 style="text-align:center;">)rawliteral");
+    out.print(v.config.appname); // Use appname as main heading
+    out.print(R"rawliteral(</h1>
+    <h2 style="text-align:center; color:#003366; font-size:1.2em; margin-top:-10px; margin-bottom:24px;">)rawliteral");
+    out.print(v.config.firmware_vers); // Firmware version as subtitle
+    out.print(R"rawliteral(</h2>
+)rawliteral");
+    break;
+  case 3:
+#if OTA_FEATURE_DESCRIPTION
+    out.print(R"rawliteral(    <div style="text-align:center; margin-bottom:20px;">
       <textarea readonly 
         style="width:100%;text-align:center;
                background:#fff;
@@ -127,72 +170,116 @@ inline String htmlForm() {
                border-radius:6px;
                resize:none;"
         rows="3"
-        >)rawliteral";
-  form += String(config.description); // Use description
-  form += R"rawliteral(</textarea>
+        >)rawliteral");
+    out.print(v.config.description); // Use description
+    out.print(R"rawliteral(</textarea>
     </div>
-    <form action="/ota/set" method="POST">
+)rawliteral");
+#endif
+    break;
+  case 4:
+    out.print(R"rawliteral(    <form action="/ota/set" method="POST">
       <table>
         <tr>
           <td class="label"><label for="ssid">WiFi SSID:</label></td>
-          <td class="input"><input type="text" id="ssid" name="ssid" value=")rawliteral";
-  form += String(config.ssid);
-  form += R"rawliteral("></td>
+          <td class="input"><input type="text" id="ssid" name="ssid" value=")rawliteral");
+    out.print(v.config.ssid);
+    out.print(R"rawliteral("></td>
         </tr>
         <tr>
           <td class="label"><label for="password">WiFi Key:</label></td>
-          <td class="input"><input type="password" id="password" name="password" value=")rawliteral";
-  form += String(config.password);
-  form += R"rawliteral("></td>
+          <td class="input"><input type="password" id="password" name="password" value=")rawliteral");
+    out.print(v.config.password);
+    out.print(R"rawliteral("></td>
         </tr>
         <tr>
           <td class="label"><label for="otaServer">OTA Server:</label></td>
-          <td class="input"><input type="text" id="otaServer" name="otaServer" value=")rawliteral";
-  form += String(config.otaServer);
-  form += R"rawliteral("></td>
+          <td class="input"><input type="text" id="otaServer" name="otaServer" value=")rawliteral");
+    break;
+  case 5:
+    out.print(v.config.otaServer);
+    out.print(R"rawliteral("></td>
         </tr>
         <tr>
           <td class="label"><label for="otaPort">OTA Port:</label></td>
-          <td class="input"><input type="number" id="otaPort" name="otaPort" value=")rawliteral";
-  form += String(config.otaPort);
-  form += R"rawliteral("></td>
+          <td class="input"><input type="number" id="otaPort" name="otaPort" value=")rawliteral");
+    out.print(v.config.otaPort);
+    out.print(R"rawliteral("></td>
+        </tr>
+        <tr>
+          <td class="label"><label for="otaMirrors">OTA Mirrors:</label></td>
+          <td class="input"><input type="text" id="otaMirrors" name="otaMirrors" placeholder="host[:port],..." value=")rawliteral");
+    out.print(v.config.otaMirrors);
+    out.print(R"rawliteral("></td>
+        </tr>
+        <tr>
+          <td class="label">Server Selection:</td>
+          <td class="input"><b>)rawliteral");
+    break;
+  case 6:
+    for (uint8_t i = 0; i < v.mirrorCount; ++i) { // RTT of the last probes, selected server marked
+      const OTAMirror &m = v.mirrors[i];
+      out.print(m.host);
+      out.print(':');
+      out.print(m.port);
+      if (m.rttMs == OTA_MIRROR_NO_RTT) {
+        out.print(" -");
+      } else {
+        out.print(' ');
+        out.print((unsigned long)m.rttMs);
+        out.print(" ms");
+      }
+      if (m.discover) out.print(" (mDNS)");
+      if (!m.healthy) out.print(" (down)");
+      if (i == v.mirrorIndex) out.print(" &#10004;");
+      out.print("<br>");
+    }
+    out.print(R"rawliteral(</b></td>
         </tr>
         <tr>
           <td class="label"><label for="otaTemplateVersion">OTA Template Version:</label></td>
-          <td class="input"><input type="text" id="otaTemplateVersion" name="otaTemplateVersion" value=")rawliteral";
-  form += String(OTA_CONFIG_VERSION);
-  form += R"rawliteral(" readonly></td>
+          <td class="input"><input type="text" id="otaTemplateVersion" name="otaTemplateVersion" value=")rawliteral");
+    break;
+  case 7:
+    out.print(OTA_CONFIG_VERSION);
+    out.print(R"rawliteral(" readonly></td>
         </tr>
         <tr>
           <td class="label"><label for="otaEnabled">OTA Service:</label></td>
           <td class="input">
             <select id="otaEnabled" name="otaEnabled">
-              <option value="1")rawliteral";
-  if (config.otaEnabled) form += " selected";
-  form += R"rawliteral(>Enabled</option>
-              <option value="0")rawliteral";
-  if (!config.otaEnabled) form += " selected";
-  form += R"rawliteral(>Disabled</option>
+              <option value="1")rawliteral");
+    if (v.config.otaEnabled) out.print(" selected");
+    out.print(R"rawliteral(>Enabled</option>
+              <option value="0")rawliteral");
+    if (!v.config.otaEnabled) out.print(" selected");
+    out.print(R"rawliteral(>Disabled</option>
             </select>
           </td>
         </tr>
         <tr>
           <td class="label"><label for="otaUpdateInterval">OTA Update Interval (min):</label></td>
-          <td class="input"><input type="number" id="otaUpdateInterval" name="otaUpdateInterval" min="1" value=")rawliteral";
-  form += String(config.otaUpdateInterval);
-  form += R"rawliteral("></td>
+          <td class="input"><input type="number" id="otaUpdateInterval" name="otaUpdateInterval" min="1" value=")rawliteral");
+    break;
+  case 8:
+    out.print(v.config.otaUpdateInterval);
+    out.print(R"rawliteral("></td>
         </tr>
         <tr>
           <td class="label">Firmware Name:</td>
-          <td class="input"><b>)rawliteral";
-  form += String(config.firmware_name); // Use config.ssid as firmware name (or another attribute if you have one)
-  form += R"rawliteral(</b></td>
+          <td class="input"><b>)rawliteral");
+    out.print(v.config.firmware_name); // Use config.ssid as firmware name (or another attribute if you have one)
+    out.print(R"rawliteral(</b></td>
         </tr>
         <tr>
           <td class="label">Firmware Version:</td>
-          <td class="input"><b>)rawliteral";
-  form += String(config.firmware_vers);
-  form += R"rawliteral(</b></td>
+          <td class="input"><b>)rawliteral");
+    out.print(v.config.firmware_vers);
+    out.print(R"rawliteral(</b></td>
+        </tr>
+        <tr>
+          <td class="label">Update Status:</td>
+          <td class="input"><b id="otaProgress">-</b></td>
         </tr>
         <tr>
           <td class="label">Web Server IP:</td>
@@ -200,15 +287,17 @@ inline String htmlForm() {
         </tr>
         <tr>
           <td class="label"><label for="webServerPort">Web Server Port:</label></td>
-          <td class="input"><input type="number" id="webServerPort" name="webServerPort" min="1" max="65535" value=")rawliteral";
-  form += String(config.webServerPort);
-  form += R"rawliteral("></td>
+          <td class="input"><input type="number" id="webServerPort" name="webServerPort" min="1" max="65535" value=")rawliteral");
+    out.print(v.config.webServerPort);
+    out.print(R"rawliteral("></td>
         </tr>
         <tr>
           <td class="label"><label for="firmware_name">Firmware File:</label></td>
-          <td class="input"><input type="text" id="firmware_name" name="firmware_name" value=")rawliteral";
-  form += String(config.firmware_name);
-  form += R"rawliteral("></td>
+          <td class="input"><input type="text" id="firmware_name" name="firmware_name" value=")rawliteral");
+    break;
+  case 9:
+    out.print(v.config.firmware_name);
+    out.print(R"rawliteral("></td>
         </tr>
         <tr>
           <td></td>
@@ -238,10 +327,31 @@ inline String htmlForm() {
       var ipField = document.getElementById("webServerIp");
       if(ipField) ipField.textContent = ip;
     });
+    // Live update progress from /ota/events
+    if (window.EventSource) {
+      new EventSource("/ota/events").addEventListener("progress", function(e) {
+        var p = JSON.parse(e.data);
+        var text = p.phase + (p.detail ? " " + p.detail : "");
+        if (p.phase == "downloading") {
+          text += " " + (p.total ? Math.floor(p.bytes * 100 / p.total) + "% " : "") +
+                  Math.round(p.rate / 1024) + " kB/s, " + p.eta + " s left";
+        }
+        document.getElementById("otaProgress").textContent = text;
+      });
+    }
   </script>
 </body>
 </html>
-)rawliteral";
-  return form;
+)rawliteral");
+    break;
+  }
+}
+
+/**
+ * Writes the HTML form to out, e.g. a buffer that is sent in chunks (handleRoot()).
+ * The page is never held in memory as a whole.
+ */
+inline void htmlForm(Print &out, const HtmlFormValues &v) {
+  for (uint8_t part = 0; part < HTML_FORM_PARTS; ++part) htmlFormPart(out, v, part);
 }
 #endif // OTA_WEBFORM_H
\ No newline at end of file
@@ -0,0 +1,162 @@
+/**
+ * OTA_WiFi.cpp
+ *
+ * Implementation of the fast WiFi connect (see OTA_WiFi.h).
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OTA_WiFi.h"
+#include "OTA_WebConfig.h"
+#include "OTA_Platform.h"
+
+#define OTA_WIFI_CACHE_MAGIC 0x5746414FUL  // "OAFW"
+
+static_assert(EEPROM_WIFI_CACHE_START + sizeof(OTAWiFiCache) <= EEPROM_SIZE, "OTAWiFiCache does not fit into EEPROM");
+
+static OTAWiFiStats stats = { 0, 0, 0, false, 0, 0 };
+
+/**
+ * FNV-1a hash over len bytes.
+ */
+static uint32_t hashBytes(const uint8_t *data, size_t len) {
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < len; ++i) {
+    h ^= data[i];
+    h *= 16777619UL;
+  }
+  return h;
+}
+
+static uint32_t cacheChecksum(const OTAWiFiCache &cache) {
+  return hashBytes((const uint8_t *)&cache, offsetof(OTAWiFiCache, checksum));
+}
+
+static uint32_t ssidHash() {
+  return hashBytes((const uint8_t *)config.ssid, strnlen(config.ssid, sizeof(config.ssid)));
+}
+
+/**
+ * Reads the cache from EEPROM. Returns false if it is invalid or belongs to another SSID.
+ */
+static bool readCache(OTAWiFiCache &cache) {
+  if (!OTAPlatform::eepromBegin(EEPROM_SIZE)) return false;
+  EEPROM.get(EEPROM_WIFI_CACHE_START, cache);
+  OTAPlatform::eepromEnd(false);
+  return cache.magic == OTA_WIFI_CACHE_MAGIC && cache.checksum == cacheChecksum(cache) &&
+         cache.ssidHash == ssidHash() && cache.channel > 0;
+}
+
+static void writeCache(const OTAWiFiCache &cache) {
+  if (!OTAPlatform::eepromBegin(EEPROM_SIZE)) return;
+  EEPROM.put(EEPROM_WIFI_CACHE_START, cache);
+  OTAPlatform::eepromEnd(true);
+}
+
+void wifiClearCache() {
+  OTAWiFiCache cache;
+  memset(&cache, 0, sizeof(cache));
+  writeCache(cache);
+}
+
+/**
+ * Stores the data of the current connection if it differs from the cache (saves flash writes).
+ */
+static void updateCache(const OTAWiFiCache &old, bool oldValid) {
+  OTAWiFiCache cache;
+  memset(&cache, 0, sizeof(cache));
+  cache.magic = OTA_WIFI_CACHE_MAGIC;
+  cache.ssidHash = ssidHash();
+  memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+  cache.channel = (uint8_t)WiFi.channel();
+#if OTA_WIFI_CACHE_IP
+  cache.hasIp = 1;
+  cache.ip = (uint32_t)WiFi.localIP();
+  cache.gateway = (uint32_t)WiFi.gatewayIP();
+  cache.subnet = (uint32_t)WiFi.subnetMask();
+  cache.dns = (uint32_t)WiFi.dnsIP();
+#endif
+  cache.checksum = cacheChecksum(cache);
+  if (!oldValid || memcmp(&cache, &old, sizeof(cache)) != 0) writeCache(cache);
+}
+
+/**
+ * Waits until connected or timeout. Returns true if connected.
+ */
+static bool waitConnected(unsigned long timeoutMs) {
+  unsigned long start = millis();
+  while (WiFi.status() != WL_CONNECTED) {
+    if (millis() - start > timeoutMs) return false;
+    delay(10);
+  }
+  return true;
+}
+
+bool wifiConnect() {
+  OTAWiFiCache cache;
+  bool cached = readCache(cache);
+  unsigned long start = millis();
+  bool connected = false;
+
+  if (cached) {
+    // Fast path: known access point and channel, no scan
+    if (cache.hasIp) {
+      WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+    }
+    WiFi.begin(config.ssid, config.password, cache.channel, cache.bssid);
+    connected = waitConnected(OTA_WIFI_FAST_TIMEOUT);
+    if (!connected) {
+      Serial.println("Fast WiFi connect failed, scanning ...");
+      WiFi.disconnect();
+      if (cache.hasIp) WiFi.config(IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0));
+      cached = false;
+    }
+  }
+  if (!connected) {
+    WiFi.begin(config.ssid, config.password);
+    connected = waitConnected(OTA_WIFI_SCAN_TIMEOUT);
+  }
+  if (!connected) {
+    Serial.println("WiFi connect failed.");
+    return false;
+  }
+
+  stats.connectMs = millis() - start;
+  stats.fastConnect = cached;
+  if (cached) stats.fastConnects++;
+  else stats.scanConnects++;
+  if (stats.onlineAt == 0) stats.onlineAt = millis();
+  Serial.printf("Connected to WiFi in %lu ms (%s), channel %d\n", stats.connectMs,
+                cached ? "cached BSSID" : "full scan", (int)WiFi.channel());
+  Serial.print("IP address: ");
+  Serial.println(WiFi.localIP());
+
+  updateCache(cache, cached);
+  return true;
+}
+
+void wifiMarkFirstRequest() {
+  if (stats.firstRequestAt == 0) {
+    stats.firstRequestAt = millis();
+    Serial.printf("Boot to first request: %lu ms\n", stats.firstRequestAt);
+  }
+}
+
+const OTAWiFiStats &wifiStats() {
+  return stats;
+}
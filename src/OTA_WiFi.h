@@ -0,0 +1,93 @@
+/**
+ * OTA_WiFi.h
+ *
+ * Fast WiFi (re)connect for the OTA Template.
+ * After a successful connect the BSSID and channel of the access point (and
+ * optionally the IP lease) are stored in EEPROM behind the configuration. The
+ * next boot connects directly to this access point without a channel scan and,
+ * with OTA_WIFI_CACHE_IP enabled, without waiting for DHCP. If the fast connect
+ * does not succeed within OTA_WIFI_FAST_TIMEOUT, the cache is dropped and a
+ * normal connect with full scan is done.
+ *
+ * The connect time and the boot-to-first-request latency are measured and
+ * reported on the serial interface and in the /ota/status JSON.
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef OTA_WIFI_H
+#define OTA_WIFI_H
+
+#include <Arduino.h>
+
+#ifndef OTA_WIFI_FAST_TIMEOUT
+#define OTA_WIFI_FAST_TIMEOUT 3000      // Max. time for a connect with cached BSSID/channel in milliseconds
+#endif
+#ifndef OTA_WIFI_SCAN_TIMEOUT
+#define OTA_WIFI_SCAN_TIMEOUT 20000     // Max. time for a connect with full scan in milliseconds
+#endif
+#ifndef OTA_WIFI_CACHE_IP
+#define OTA_WIFI_CACHE_IP 0             // 1: reuse the last DHCP lease as static IP (skips DHCP)
+#endif
+
+// Connection data of the last successful connect, stored at EEPROM_WIFI_CACHE_START
+struct OTAWiFiCache {
+  uint32_t magic;          // OTA_WIFI_CACHE_MAGIC if valid
+  uint32_t ssidHash;       // Hash of the SSID the data belongs to
+  uint8_t bssid[6];        // MAC address of the access point
+  uint8_t channel;         // WiFi channel of the access point
+  uint8_t hasIp;           // 1 if the IP fields are valid
+  uint32_t ip;             // IP lease (IPAddress as uint32_t)
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  uint32_t checksum;       // Checksum over all fields before
+};
+
+// Connect metrics of the current boot
+struct OTAWiFiStats {
+  unsigned long connectMs;       // Duration of the last connect
+  unsigned long onlineAt;        // millis() when the first connect succeeded (boot-to-online)
+  unsigned long firstRequestAt;  // millis() when the first request to the OTA server completed
+  bool fastConnect;              // Last connect used the cached BSSID/channel
+  uint16_t fastConnects;         // Connects with cached data since boot
+  uint16_t scanConnects;         // Connects with full scan since boot
+};
+
+/**
+ * Connects to config.ssid, using the cached access point data if available.
+ * Falls back to a full scan. Returns true if connected.
+ */
+bool wifiConnect();
+
+/**
+ * Invalidates the cached access point data (e.g. after changing the SSID).
+ */
+void wifiClearCache();
+
+/**
+ * Records the completion of the first request to the OTA server (boot-to-first-request metric).
+ */
+void wifiMarkFirstRequest();
+
+/**
+ * Returns the connect metrics of the current boot.
+ */
+const OTAWiFiStats &wifiStats();
+
+#endif // OTA_WIFI_H
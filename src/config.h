@@ -41,11 +41,12 @@
 /*
 **  OTA Server Configuration Details  
 */
-#define OTA_SERVER "your IP"     // OTA server IP or hostname for firmware updates
+#define OTA_SERVER "your IP"     // OTA server IP or hostname for firmware updates, "auto": found by mDNS
 #define OTA_VERSION "1.0.0.0"          // Version number of the OTA template (not firmware)
 #define OTA_PORT 3000                  // Port number used to connect to the OTA server
 #define OTA_UPDATE_INTERVAL 60         // Interval (in minutes) to check for OTA updates
 #define OTA_ENABLED false              // Enable (true) or disable (false) OTA update functionality by default
+#define OTA_MIRRORS ""                 // Mirrors of the OTA server "host[:port],..." in order of preference
 #define OTA_CONFIG_ROOT "/ota"         // Root path for OTA updates on the ota-#server
 #define OTA_CONFIG_SET "/ota/set"      // Path for setting OTA configuration via web interface
 
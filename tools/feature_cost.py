@@ -0,0 +1,107 @@
+# feature_cost.py
+#
+# Reports the flash and RAM cost of the optional features of the OTA Template.
+# The features are the OTA_FEATURE_* switches defined in src/OTA_Features.h (default 1). The
+# firmware is built once with all features, once without each feature and once
+# without any; the differences are the cost of the features:
+# - PlatformIO environments print "RAM:" and "Flash:" after the build, these are used
+# - otherwise (native) the sizes are read from the binary with size(1):
+#   flash = text + data, RAM = data + bss
+#
+# Usage: python3 tools/feature_cost.py [--env ENV] [--build-cmd CMD --binary PATH] [--json FILE]
+#   e.g. python3 tools/feature_cost.py --env esp8266-Lolin-NodeMCU-V3
+# --build-cmd builds without PlatformIO, {flags} is replaced by the -D options.
+#
+# Author: R. Zuehlsdorff
+# Copyright 2025
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+# See the GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+FEATURES_H = os.path.join(ROOT, "src", "OTA_Features.h")
+FEATURE = re.compile(r"^#define (OTA_FEATURE_\w+) 1\b", re.M)
+PIO_SIZE = re.compile(r"^(RAM|Flash):.*\(used (\d+) bytes", re.M)
+
+
+def features():
+    with open(FEATURES_H) as f:
+        return FEATURE.findall(f.read())
+
+
+def binary_size(path, size_tool):
+    out = subprocess.check_output([size_tool, path], universal_newlines=True).splitlines()
+    text, data, bss = (int(v) for v in out[1].split()[:3])
+    return {"flash": text + data, "ram": data + bss}
+
+
+def build(args, off):
+    flags = " ".join("-D%s=0" % name for name in off)
+    if args.build_cmd:
+        cmd = args.build_cmd.replace("{flags}", flags)
+        env = os.environ
+    else:
+        cmd = "pio run -e %s" % args.env
+        env = dict(os.environ, PLATFORMIO_BUILD_FLAGS=flags)
+    proc = subprocess.run(cmd, shell=True, cwd=ROOT, env=env, universal_newlines=True,
+                          stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    if proc.returncode != 0:
+        sys.stdout.write(proc.stdout)
+        sys.exit("Build failed: %s %s" % (cmd, flags))
+    sizes = dict((k.lower(), int(v)) for k, v in PIO_SIZE.findall(proc.stdout))
+    if "flash" in sizes and "ram" in sizes:
+        return sizes
+    binary = args.binary or os.path.join(ROOT, ".pio", "build", args.env, "program")
+    return binary_size(binary, args.size_tool)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flash and RAM cost of the OTA_FEATURE_* switches")
+    parser.add_argument("--env", default="native", help="PlatformIO environment (default: %(default)s)")
+    parser.add_argument("--build-cmd", help="build command instead of PlatformIO, {flags} is replaced")
+    parser.add_argument("--binary", help="built binary, if the build does not print its size")
+    parser.add_argument("--size-tool", default="size", help="size(1) of the toolchain (default: %(default)s)")
+    parser.add_argument("--json", metavar="FILE", help="write the results to FILE")
+    args = parser.parse_args()
+
+    names = features()
+    if not names:
+        sys.exit("No OTA_FEATURE_* switches found in src/OTA_Features.h")
+    full = build(args, [])
+    none = build(args, names)
+    rows = []
+    for name in names:
+        without = build(args, [name])
+        rows.append({"feature": name, "flash": full["flash"] - without["flash"], "ram": full["ram"] - without["ram"]})
+
+    print("%-26s %10s %10s" % ("Feature", "Flash", "RAM"))
+    for row in rows:
+        print("%-26s %10d %10d" % (row["feature"], row["flash"], row["ram"]))
+    print("%-26s %10d %10d" % ("all features", full["flash"] - none["flash"], full["ram"] - none["ram"]))
+    print("%-26s %10d %10d" % ("image with all features", full["flash"], full["ram"]))
+    print("%-26s %10d %10d" % ("image without features", none["flash"], none["ram"]))
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"features": rows, "full": full, "minimal": none}, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,640 @@
+/**
+ * fleet_sim.cpp
+ *
+ * Fleet simulator: load test of the OTA server with many simulated devices.
+ *
+ * Every simulated device follows the protocol of performOTAUpdate(): a GET of
+ * /version/<version>.version and, if the server announces a newer version, a GET of
+ * /updates/<firmware> (one connection per request, as with http.end() on the device).
+ * After a successful download the device "reboots" with the new version; a failed
+ * download is retried like the update loop of performOTAUpdate(). Devices check again
+ * after the check interval.
+ *
+ * All devices are served by one thread with an epoll event loop, so a single machine
+ * simulates thousands of devices. Options:
+ *   --host H --port P       OTA server (default 127.0.0.1:3000)
+ *   --devices N             Number of devices (default 1000)
+ *   --firmware NAME         Firmware file name (default ota_test_app.bin)
+ *   --version V             Installed version of the devices (default 1.1.0)
+ *   --interval S            Check interval in seconds (default 60)
+ *   --jitter PCT            Random deviation of the interval in percent (default 0)
+ *   --boot-window MS        Devices boot within this time (default: interval, 0 = all at once)
+ *   --duration S            Duration of the simulation in seconds (default 60)
+ *   --rate KBPS             Link speed per device in kB/s, 0 = unlimited (default 0)
+ *   --timeout MS            Inactivity timeout of requests (default 5000, like HTTPClient)
+ *   --retry-delay MS        Delay before retrying a failed download (default 0, like performOTAUpdate())
+ *   --fail-connect PCT      Percentage of requests failing before the connect (WiFi/DNS failure)
+ *   --drop PCT              Percentage of downloads aborted at a random offset
+ *   --no-install            Devices keep their version (every check downloads the image again)
+ *   --json                  Print the report as JSON
+ *   --seed N                Seed of the random generator
+ *
+ * The report contains latency percentiles of version checks, time to first byte and
+ * duration of downloads, throughput and error rates.
+ *
+ * Build: g++ -O2 -std=gnu++11 -o fleet_sim tools/fleet_sim/fleet_sim.cpp  (or pio run -e fleet-sim)
+ *
+ * Author: R. Zuehlsdorff
+ * Copyright 2025
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define READ_BUFFER 16384       // Max. bytes per read()
+#define MAX_HEADER 4096         // Max. size of the response header
+
+// --- Options ---
+
+struct Options {
+  std::string host = "127.0.0.1";
+  int port = 3000;
+  int devices = 1000;
+  std::string firmware = "ota_test_app.bin";
+  std::string version = "1.1.0";
+  double interval = 60;
+  double jitter = 0;
+  double bootWindow = -1;       // -1: interval
+  double duration = 60;
+  double rateKBps = 0;
+  int timeoutMs = 5000;
+  int retryDelayMs = 0;
+  double failConnect = 0;
+  double drop = 0;
+  bool install = true;
+  bool json = false;
+  unsigned seed = 1;
+};
+
+static Options opt;
+static sockaddr_in serverAddr;
+static std::mt19937 rng;
+static int epfd;
+
+static uint64_t nowUs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static bool chance(double percent) {
+  return percent > 0 && std::uniform_real_distribution<double>(0, 100)(rng) < percent;
+}
+
+/**
+ * Compares two version strings like compareVersion() in OTA_Template.cpp.
+ */
+static int compareVersion(const std::string &v1, const std::string &v2) {
+  const char *a = v1.c_str(), *b = v2.c_str();
+  while (*a || *b) {
+    long x = strtol(a, (char **)&a, 10), y = strtol(b, (char **)&b, 10);
+    if (x != y) return x < y ? -1 : 1;
+    while (*a && *a != '.') ++a;
+    while (*b && *b != '.') ++b;
+    if (*a) ++a;
+    if (*b) ++b;
+  }
+  return 0;
+}
+
+// --- Statistics ---
+
+struct Stats {
+  std::vector<uint32_t> versionUs;    // Duration of successful version checks
+  std::vector<uint32_t> ttfbUs;       // Time to the response header of downloads
+  std::vector<uint32_t> downloadUs;   // Duration of successful downloads
+  uint64_t bytes = 0;                 // Received bytes (header and body)
+  uint32_t checks = 0, attempts = 0;  // Started version checks and download attempts
+  uint32_t upToDate = 0, downloads = 0, installs = 0;
+  uint32_t connectErrors = 0, httpErrors = 0, timeouts = 0, resets = 0;
+  uint32_t injectedConnect = 0, injectedDrops = 0;
+  uint32_t maxActive = 0;
+};
+
+static Stats stats;
+static uint32_t active = 0;
+
+// --- Devices ---
+
+enum Phase : uint8_t { IDLE, CONNECTING, SENDING, HEADER, BODY };
+enum Request : uint8_t { VERSION, IMAGE };
+enum TimerKind : uint8_t { TIMER_WAKE, TIMER_DEADLINE, TIMER_RESUME };
+
+struct Device {
+  std::string version;
+  Phase phase = IDLE;
+  Request request = VERSION;
+  Request next = VERSION;         // Request started by the next wake-up
+  int fd = -1;
+  std::string out;                // Request being sent
+  size_t outOff = 0;
+  std::string header;
+  std::string body;               // Body of version responses
+  long contentLength = -1;
+  uint64_t received = 0;          // Body bytes received
+  uint64_t dropAt = 0;            // Injected abort offset, 0 = none
+  uint64_t startUs = 0;
+  uint64_t activityUs = 0;        // Last connect/send/receive, for the inactivity timeout
+  uint64_t updateStartUs = 0;     // Start of the update loop (retries end after the interval)
+  uint64_t ttfbUs = 0;
+  uint64_t allowedUs = 0;         // Link throttle: next read allowed at
+  bool paused = false;
+  uint32_t gen[3] = {0, 0, 0};    // Timer generations (lazy deletion)
+  std::string newVersion;
+};
+
+static std::vector<Device> devices;
+
+struct Timer {
+  uint64_t at;
+  uint32_t device;
+  uint32_t gen;
+  TimerKind kind;
+  bool operator>(const Timer &o) const { return at > o.at; }
+};
+
+static std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer> > timers;
+
+static void setTimer(uint32_t id, TimerKind kind, uint64_t at) {
+  Timer t = { at, id, ++devices[id].gen[kind], kind };
+  timers.push(t);
+}
+
+static void cancelTimer(uint32_t id, TimerKind kind) {
+  ++devices[id].gen[kind];
+}
+
+static uint64_t endUs = 0;        // End of the simulation, no new checks afterwards
+
+/**
+ * Schedules a request of a device in ms milliseconds.
+ */
+static void schedule(uint32_t id, double ms, Request request) {
+  uint64_t at = nowUs() + (uint64_t)(ms * 1000);
+  devices[id].next = request;
+  if (at < endUs) setTimer(id, TIMER_WAKE, at);
+}
+
+/**
+ * Schedules the next version check after the check interval.
+ */
+static void nextCheck(uint32_t id) {
+  double ms = opt.interval * 1000;
+  if (opt.jitter > 0) ms *= 1 + std::uniform_real_distribution<double>(-opt.jitter, opt.jitter)(rng) / 100;
+  schedule(id, ms, VERSION);
+}
+
+/**
+ * Retries a failed download like the update loop of performOTAUpdate(), which
+ * gives up when the check interval has passed.
+ */
+static void retryDownload(uint32_t id) {
+  if (nowUs() - devices[id].updateStartUs < (uint64_t)(opt.interval * 1e6)) schedule(id, opt.retryDelayMs, IMAGE);
+  else nextCheck(id);
+}
+
+static void closeConnection(Device &d) {
+  if (d.fd >= 0) {
+    close(d.fd); // Also removes it from the epoll set
+    d.fd = -1;
+    active--;
+  }
+  d.phase = IDLE;
+  d.paused = false;
+}
+
+static void startRequest(uint32_t id, Request request);
+
+/**
+ * Ends the current request with an error. A failed download is retried,
+ * a failed version check waits for the next interval.
+ */
+static void fail(uint32_t id, uint32_t &counter) {
+  Device &d = devices[id];
+  counter++;
+  cancelTimer(id, TIMER_DEADLINE);
+  cancelTimer(id, TIMER_RESUME);
+  closeConnection(d);
+  if (d.request == IMAGE) retryDownload(id);
+  else nextCheck(id);
+}
+
+/**
+ * Handles a complete response.
+ */
+static void complete(uint32_t id) {
+  Device &d = devices[id];
+  uint32_t elapsed = (uint32_t)(nowUs() - d.startUs);
+  cancelTimer(id, TIMER_DEADLINE);
+  cancelTimer(id, TIMER_RESUME);
+  closeConnection(d);
+  if (d.request == VERSION) {
+    stats.versionUs.push_back(elapsed);
+    size_t b = d.body.find_first_not_of(" \r\n\t");
+    size_t e = d.body.find_last_not_of(" \r\n\t");
+    d.newVersion = b == std::string::npos ? "" : d.body.substr(b, e - b + 1);
+    if (compareVersion(d.newVersion, d.version) > 0) {
+      d.updateStartUs = nowUs();
+      startRequest(id, IMAGE);
+    } else {
+      stats.upToDate++;
+      nextCheck(id);
+    }
+  } else {
+    stats.downloadUs.push_back(elapsed);
+    stats.downloads++;
+    if (opt.install) {
+      d.version = d.newVersion; // Reboot with the new firmware, checks again right away
+      stats.installs++;
+      schedule(id, 0, VERSION);
+    } else {
+      nextCheck(id);
+    }
+  }
+}
+
+static void startRequest(uint32_t id, Request request) {
+  Device &d = devices[id];
+  d.request = request;
+  if (request == VERSION) stats.checks++;
+  else stats.attempts++;
+  if (chance(opt.failConnect)) {
+    stats.injectedConnect++;
+    if (request == IMAGE) retryDownload(id);
+    else nextCheck(id);
+    return;
+  }
+  d.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (d.fd < 0) {
+    perror("socket");
+    exit(1);
+  }
+  active++;
+  if (active > stats.maxActive) stats.maxActive = active;
+  int one = 1;
+  setsockopt(d.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  d.startUs = d.activityUs = nowUs();
+  d.header.clear();
+  d.body.clear();
+  d.received = 0;
+  d.contentLength = -1;
+  d.allowedUs = d.startUs;
+  d.dropAt = 0;
+  char path[160];
+  if (request == VERSION) snprintf(path, sizeof(path), "/version/%s.version", d.version.c_str());
+  else snprintf(path, sizeof(path), "/updates/%s", opt.firmware.c_str());
+  d.out = std::string("GET ") + path + " HTTP/1.1\r\nHost: " + opt.host + ":" + std::to_string(opt.port) +
+          "\r\nUser-Agent: ESP32HTTPClient\r\nConnection: close\r\n";
+  if (request == IMAGE) d.out += "x-ESP32-version: " + d.version + "\r\n";
+  d.out += "\r\n";
+  d.outOff = 0;
+  d.phase = CONNECTING;
+  setTimer(id, TIMER_DEADLINE, d.startUs + (uint64_t)opt.timeoutMs * 1000);
+
+  epoll_event ev;
+  ev.events = EPOLLOUT;
+  ev.data.u32 = id;
+  if (connect(d.fd, (sockaddr *)&serverAddr, sizeof(serverAddr)) < 0 && errno != EINPROGRESS) {
+    fail(id, stats.connectErrors);
+    return;
+  }
+  epoll_ctl(epfd, EPOLL_CTL_ADD, d.fd, &ev);
+}
+
+static void watch(Device &d, uint32_t id, uint32_t events) {
+  epoll_event ev;
+  ev.events = events;
+  ev.data.u32 = id;
+  epoll_ctl(epfd, EPOLL_CTL_MOD, d.fd, &ev);
+}
+
+/**
+ * Parses the response header. Returns false on errors (counted).
+ */
+static bool parseHeader(uint32_t id) {
+  Device &d = devices[id];
+  int code = 0;
+  if (sscanf(d.header.c_str(), "HTTP/%*d.%*d %d", &code) != 1 || code != 200) {
+    fail(id, stats.httpErrors);
+    return false;
+  }
+  std::string lower(d.header);
+  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  size_t p = lower.find("\r\ncontent-length:");
+  if (p != std::string::npos) d.contentLength = strtol(lower.c_str() + p + 17, nullptr, 10);
+  d.ttfbUs = nowUs() - d.startUs;
+  if (d.request == IMAGE) {
+    stats.ttfbUs.push_back((uint32_t)d.ttfbUs);
+    if (chance(opt.drop) && d.contentLength > 0) {
+      d.dropAt = 1 + std::uniform_int_distribution<uint64_t>(0, (uint64_t)d.contentLength - 1)(rng);
+    }
+  }
+  return true;
+}
+
+static void onBody(uint32_t id, const char *data, size_t len) {
+  Device &d = devices[id];
+  d.received += len;
+  if (d.request == VERSION && d.body.size() < 64) d.body.append(data, std::min(len, 64 - d.body.size()));
+}
+
+static void onReadable(uint32_t id) {
+  Device &d = devices[id];
+  static char buf[READ_BUFFER];
+  size_t chunk = READ_BUFFER;
+  if (opt.rateKBps > 0) {
+    // Read in slices of ~20 ms of link time
+    chunk = std::max((size_t)512, std::min((size_t)READ_BUFFER, (size_t)(opt.rateKBps * 1024 / 50)));
+  }
+  ssize_t n = read(d.fd, buf, chunk);
+  if (n < 0) {
+    if (errno == EAGAIN || errno == EINTR) return;
+    fail(id, stats.resets);
+    return;
+  }
+  stats.bytes += (uint64_t)n;
+  d.activityUs = nowUs();
+  if (n == 0) {
+    // Connection closed: complete if the length was unknown or reached
+    if (d.phase == BODY && (d.contentLength < 0 || (long)d.received >= d.contentLength)) complete(id);
+    else fail(id, stats.resets);
+    return;
+  }
+  const char *p = buf;
+  size_t len = (size_t)n;
+  if (d.phase == HEADER) {
+    d.header.append(p, len);
+    size_t end = d.header.find("\r\n\r\n");
+    if (end == std::string::npos) {
+      if (d.header.size() > MAX_HEADER) fail(id, stats.httpErrors);
+      return;
+    }
+    std::string rest = d.header.substr(end + 4);
+    d.header.resize(end + 2);
+    if (!parseHeader(id)) return;
+    d.phase = BODY;
+    onBody(id, rest.data(), rest.size());
+  } else {
+    onBody(id, p, len);
+  }
+  if (d.dropAt && d.received >= d.dropAt) {
+    fail(id, stats.injectedDrops);
+    return;
+  }
+  if (d.contentLength >= 0 && (long)d.received >= d.contentLength) {
+    complete(id);
+    return;
+  }
+  if (opt.rateKBps > 0) {
+    // Link throttle: the next read is allowed when the link has transferred this one
+    d.allowedUs += (uint64_t)(n * 1e6 / (opt.rateKBps * 1024));
+    uint64_t now = nowUs();
+    if (d.allowedUs > now) {
+      d.paused = true;
+      watch(d, id, 0);
+      setTimer(id, TIMER_RESUME, d.allowedUs);
+    } else if (now - d.allowedUs > 100000) {
+      d.allowedUs = now - 100000; // No unlimited credit after idle phases
+    }
+  }
+}
+
+static void onEvent(uint32_t id, uint32_t events) {
+  Device &d = devices[id];
+  if (d.fd < 0) return;
+  if (d.phase == CONNECTING) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    getsockopt(d.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+    if (err || (events & (EPOLLERR | EPOLLHUP))) {
+      fail(id, stats.connectErrors);
+      return;
+    }
+    d.phase = SENDING;
+  }
+  if (d.phase == SENDING) {
+    ssize_t n = send(d.fd, d.out.data() + d.outOff, d.out.size() - d.outOff, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno != EAGAIN && errno != EINTR) fail(id, stats.resets);
+      return;
+    }
+    d.outOff += (size_t)n;
+    d.activityUs = nowUs();
+    if (d.outOff < d.out.size()) return;
+    d.phase = HEADER;
+    watch(d, id, EPOLLIN | EPOLLRDHUP);
+    return;
+  }
+  if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) onReadable(id);
+}
+
+static void onTimer(const Timer &t) {
+  Device &d = devices[t.device];
+  if (t.gen != d.gen[t.kind]) return; // Cancelled or replaced
+  switch (t.kind) {
+    case TIMER_WAKE:
+      if (d.phase == IDLE) startRequest(t.device, d.next);
+      break;
+    case TIMER_DEADLINE:
+      if (d.phase == IDLE) break;
+      if (d.paused || t.at < d.activityUs + (uint64_t)opt.timeoutMs * 1000) {
+        // Active (or waiting for the link): check again one timeout after the last activity
+        setTimer(t.device, TIMER_DEADLINE, std::max(t.at, d.activityUs) + (uint64_t)opt.timeoutMs * 1000);
+      } else {
+        fail(t.device, stats.timeouts);
+      }
+      break;
+    case TIMER_RESUME:
+      if (d.paused && d.fd >= 0) {
+        d.paused = false;
+        d.activityUs = nowUs();
+        watch(d, t.device, EPOLLIN | EPOLLRDHUP);
+      }
+      break;
+  }
+}
+
+// --- Report ---
+
+static uint32_t percentile(std::vector<uint32_t> &v, double p) {
+  if (v.empty()) return 0;
+  size_t i = (size_t)(p / 100 * (v.size() - 1) + 0.5);
+  return v[i];
+}
+
+static void printLatency(const char *name, std::vector<uint32_t> &v, bool json, bool last) {
+  std::sort(v.begin(), v.end());
+  double ms[5] = { percentile(v, 50) / 1000.0, percentile(v, 90) / 1000.0, percentile(v, 99) / 1000.0,
+                   percentile(v, 99.9) / 1000.0, v.empty() ? 0 : v.back() / 1000.0 };
+  if (json) {
+    printf("    \"%s\": {\"count\": %zu, \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"p999\": %.2f, \"max\": %.2f}%s\n",
+           name, v.size(), ms[0], ms[1], ms[2], ms[3], ms[4], last ? "" : ",");
+  } else {
+    printf("  %-14s %8zu %9.2f %9.2f %9.2f %9.2f %9.2f\n", name, v.size(), ms[0], ms[1], ms[2], ms[3], ms[4]);
+  }
+}
+
+static void report(double seconds) {
+  uint32_t requests = stats.checks + stats.attempts;
+  uint32_t errors = stats.connectErrors + stats.httpErrors + stats.timeouts + stats.resets;
+  double errorRate = requests ? 100.0 * errors / requests : 0;
+  double mbps = stats.bytes / seconds / (1024 * 1024);
+  if (opt.json) {
+    printf("{\n  \"devices\": %d,\n  \"seconds\": %.2f,\n  \"latency_ms\": {\n", opt.devices, seconds);
+    printLatency("version", stats.versionUs, true, false);
+    printLatency("download_ttfb", stats.ttfbUs, true, false);
+    printLatency("download", stats.downloadUs, true, true);
+    printf("  },\n  \"checks\": %u, \"up_to_date\": %u, \"downloads\": %u, \"installs\": %u,\n",
+           stats.checks, stats.upToDate, stats.downloads, stats.installs);
+    printf("  \"bytes\": %llu, \"throughput_mib_s\": %.2f, \"requests_per_s\": %.1f, \"max_active\": %u,\n",
+           (unsigned long long)stats.bytes, mbps, requests / seconds, stats.maxActive);
+    printf("  \"errors\": {\"connect\": %u, \"http\": %u, \"timeout\": %u, \"reset\": %u, "
+           "\"injected_connect\": %u, \"injected_drop\": %u, \"rate_pct\": %.2f}\n}\n",
+           stats.connectErrors, stats.httpErrors, stats.timeouts, stats.resets, stats.injectedConnect,
+           stats.injectedDrops, errorRate);
+    return;
+  }
+  printf("Fleet simulation: %d devices, %.1f s against %s:%d\n", opt.devices, seconds, opt.host.c_str(), opt.port);
+  printf("  %-14s %8s %9s %9s %9s %9s %9s\n", "latency [ms]", "count", "p50", "p90", "p99", "p99.9", "max");
+  printLatency("version", stats.versionUs, false, false);
+  printLatency("download ttfb", stats.ttfbUs, false, false);
+  printLatency("download", stats.downloadUs, false, true);
+  printf("  checks %u (up-to-date %u), downloads %u, installs %u\n", stats.checks, stats.upToDate,
+         stats.downloads, stats.installs);
+  printf("  received %.1f MiB, %.2f MiB/s, %.1f requests/s, max. %u concurrent connections\n",
+         stats.bytes / (1024.0 * 1024), mbps, requests / seconds, stats.maxActive);
+  printf("  errors: connect %u, http %u, timeout %u, reset %u (%.2f%% of requests); "
+         "injected: connect %u, drop %u\n", stats.connectErrors, stats.httpErrors, stats.timeouts, stats.resets,
+         errorRate, stats.injectedConnect, stats.injectedDrops);
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [--host H] [--port P] [--devices N] [--firmware NAME] [--version V]\n"
+          "          [--interval S] [--jitter PCT] [--boot-window MS] [--duration S] [--rate KBPS]\n"
+          "          [--timeout MS] [--retry-delay MS] [--fail-connect PCT] [--drop PCT]\n"
+          "          [--no-install] [--json] [--seed N]\n", prog);
+  exit(2);
+}
+
+static void parseArgs(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (a == "--no-install") opt.install = false;
+    else if (a == "--json") opt.json = true;
+    else if (!hasValue) usage(argv[0]);
+    else if (a == "--host") opt.host = argv[++i];
+    else if (a == "--port") opt.port = atoi(argv[++i]);
+    else if (a == "--devices") opt.devices = atoi(argv[++i]);
+    else if (a == "--firmware") opt.firmware = argv[++i];
+    else if (a == "--version") opt.version = argv[++i];
+    else if (a == "--interval") opt.interval = atof(argv[++i]);
+    else if (a == "--jitter") opt.jitter = atof(argv[++i]);
+    else if (a == "--boot-window") opt.bootWindow = atof(argv[++i]);
+    else if (a == "--duration") opt.duration = atof(argv[++i]);
+    else if (a == "--rate") opt.rateKBps = atof(argv[++i]);
+    else if (a == "--timeout") opt.timeoutMs = atoi(argv[++i]);
+    else if (a == "--retry-delay") opt.retryDelayMs = atoi(argv[++i]);
+    else if (a == "--fail-connect") opt.failConnect = atof(argv[++i]);
+    else if (a == "--drop") opt.drop = atof(argv[++i]);
+    else if (a == "--seed") opt.seed = (unsigned)atoi(argv[++i]);
+    else usage(argv[0]);
+  }
+  if (opt.devices <= 0 || opt.interval <= 0) usage(argv[0]);
+  if (opt.bootWindow < 0) opt.bootWindow = opt.interval * 1000;
+}
+
+int main(int argc, char **argv) {
+  parseArgs(argc, argv);
+  rng.seed(opt.seed);
+
+  addrinfo hints = {}, *res = nullptr;
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(opt.host.c_str(), nullptr, &hints, &res) != 0 || !res) {
+    fprintf(stderr, "Cannot resolve %s\n", opt.host.c_str());
+    return 1;
+  }
+  serverAddr = *(sockaddr_in *)res->ai_addr;
+  serverAddr.sin_port = htons((uint16_t)opt.port);
+  freeaddrinfo(res);
+
+  // One socket per active device
+  rlimit rl;
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+    if (rl.rlim_cur < (rlim_t)opt.devices + 16) {
+      fprintf(stderr, "Warning: open file limit %lu is below the number of devices\n", (unsigned long)rl.rlim_cur);
+    }
+  }
+
+  epfd = epoll_create1(0);
+  uint64_t start = nowUs();
+  endUs = start + (uint64_t)(opt.duration * 1e6);
+  devices.resize(opt.devices);
+  for (int i = 0; i < opt.devices; ++i) {
+    devices[i].version = opt.version;
+    // Boot: the first check runs right after otaSetup()
+    schedule(i, std::uniform_real_distribution<double>(0, opt.bootWindow)(rng), VERSION);
+  }
+
+  std::vector<epoll_event> events(1024);
+  uint64_t lastProgress = start;
+  for (;;) {
+    uint64_t now = nowUs();
+    while (!timers.empty() && timers.top().at <= now) {
+      Timer t = timers.top();
+      timers.pop();
+      onTimer(t);
+    }
+    if (active == 0 && (timers.empty() || now >= endUs)) break; // Remaining timers are stale deadlines
+    if (now > endUs + (uint64_t)opt.timeoutMs * 1000 * 2) break; // Drain phase exceeded
+    int wait = timers.empty() ? 100 : (int)std::min<uint64_t>(100, (timers.top().at - now + 999) / 1000);
+    int n = epoll_wait(epfd, events.data(), (int)events.size(), wait);
+    for (int i = 0; i < n; ++i) onEvent(events[i].data.u32, events[i].events);
+    if (!opt.json && now - lastProgress >= 1000000) {
+      lastProgress = now;
+      fprintf(stderr, "\r%5.0f s: %u active, %u checks, %u downloads, %u errors   ", (now - start) / 1e6, active,
+              stats.checks, stats.downloads, stats.connectErrors + stats.httpErrors + stats.timeouts + stats.resets);
+    }
+  }
+  if (!opt.json) fprintf(stderr, "\n");
+  report((nowUs() - start) / 1e6);
+  return 0;
+}
@@ -0,0 +1,284 @@
+# native_e2e.py
+#
+# End-to-end run of the OTA update path with the native build (pio run -e native).
+#
+# The script
+# - creates a firmware image and version files in a temporary updates directory
+# - starts OTA-Server/ota-server.js on it (or a built-in stub server with the same
+#   endpoints if node/express is not available)
+# - boots the native program with an erased EEPROM and configures it via /ota/set; the
+#   form is posted in two TCP segments on a keep-alive connection whose receive buffer
+#   holds an earlier request, the stored mirror list must end with the body
+# - boots it again: the program checks the version, downloads the image into the
+#   file backed partition and restarts
+# - boots it a third time: the version check reports "up-to-date", nothing is downloaded
+# and reports wall time and bytes transferred of every phase. The exit code is 0 if
+# the installed image matches the served one.
+#
+# Usage: python3 tools/native_e2e.py [--program PATH] [--size BYTES] [--server auto|node|stub] [--json]
+#
+# Author: R. Zuehlsdorff
+# Copyright 2025
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+# See the GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+import argparse
+import hashlib
+import http.client
+import http.server
+import json
+import os
+import re
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import urllib.parse
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_PROGRAM = os.path.join(ROOT, ".pio", "build", "native", "program")
+FIRMWARE_NAME = "ota_test_app.bin"     # FIRMWARE_NAME in src/config.h
+FIRMWARE_VERSION = "1.1.0"             # FIRMWARE_VERSION in src/config.h
+NEW_VERSION = "1.2.0"
+
+EXIT_DONE = 0                          # HostRuntime.h
+EXIT_RESTART = 3
+
+SUMMARY = re.compile(r"\[host\] exit: (?P<reason>.*?) \| wall time (?P<wall>\d+) ms \| rx (?P<rx>\d+) bytes \| "
+                     r"tx (?P<tx>\d+) bytes \| connections (?P<conn>\d+) \| accepted (?P<acc>\d+) \| "
+                     r"partition written (?P<part>\d+) bytes")
+
+
+def free_port():
+    s = socket.socket()
+    s.bind(("127.0.0.1", 0))
+    port = s.getsockname()[1]
+    s.close()
+    return port
+
+
+def wait_port(port, timeout=10.0):
+    end = time.time() + timeout
+    while time.time() < end:
+        try:
+            socket.create_connection(("127.0.0.1", port), 0.2).close()
+            return True
+        except OSError:
+            time.sleep(0.05)
+    return False
+
+
+class StubHandler(http.server.BaseHTTPRequestHandler):
+    """Same endpoints as ota-server.js: /version/<file>, /firmware/<file>, /updates/<file> and
+    /manifest/<file> (unsigned)."""
+    protocol_version = "HTTP/1.1"
+    updates_dir = "."
+
+    def do_GET(self):
+        parts = self.path.split("?")[0].split("/")
+        if len(parts) != 3 or parts[1] not in ("version", "firmware", "updates", "manifest"):
+            return self.reply(404, b"Not found")
+        file = os.path.join(self.updates_dir, os.path.basename(urllib.parse.unquote(parts[2])))
+        if parts[1] == "version":
+            version = b"unknown"
+            if os.path.isfile(file):
+                with open(file, "rb") as f:
+                    version = f.read().strip()
+            return self.reply(200, version, "text/html; charset=utf-8")
+        if not os.path.isfile(file):
+            return self.reply(404, b"Firmware file not found.")
+        if parts[1] == "manifest":
+            with open(file, "rb") as f:
+                data = f.read()
+            line = "OTA1M %s - %d %s\n\n" % (os.path.basename(file), len(data), hashlib.sha256(data).hexdigest())
+            return self.reply(200, line.encode())
+        with open(file, "rb") as f:
+            self.reply(200, f.read(), "application/octet-stream")
+
+    def reply(self, code, body, ctype="text/plain"):
+        self.send_response(code)
+        self.send_header("Content-Type", ctype)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, *args):
+        pass
+
+
+def start_server(kind, updates_dir, port):
+    """Starts the OTA server. Returns (name, stop function)."""
+    node = shutil.which("node")
+    if kind in ("auto", "node") and node:
+        env = dict(os.environ, OTA_PORT=str(port), OTA_UPDATES_DIR=updates_dir)
+        proc = subprocess.Popen([node, os.path.join(ROOT, "OTA-Server", "ota-server.js")], env=env,
+                                stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        if wait_port(port, 5.0):
+            return "ota-server.js", proc.terminate
+        proc.kill()
+        lines = proc.stderr.read().decode(errors="replace").splitlines()
+        err = next((l for l in lines if l.startswith("Error")), lines[0] if lines else "?")
+        if kind == "node":
+            sys.exit("ota-server.js did not start: %s" % err)
+        print("ota-server.js not usable (%s), using stub server" % err, file=sys.stderr)
+    elif kind == "node":
+        sys.exit("node not found")
+    StubHandler.updates_dir = updates_dir
+    httpd = http.server.ThreadingHTTPServer(("127.0.0.1", port), StubHandler)
+    threading.Thread(target=httpd.serve_forever, daemon=True).start()
+    return "stub server", httpd.shutdown
+
+
+def run_program(program, workdir, web_port, seconds, action=None):
+    """Runs the native program once. action(web_port) is called when the web server listens."""
+    env = dict(os.environ,
+               OTA_HOST_EEPROM=os.path.join(workdir, "eeprom.bin"),
+               OTA_HOST_PARTITION=os.path.join(workdir, "partition.bin"),
+               OTA_HOST_WEB_PORT=str(web_port),
+               OTA_HOST_SECONDS=str(seconds),
+               OTA_HOST_QUIET="1")
+    start = time.time()
+    proc = subprocess.Popen([program], cwd=workdir, env=env, stdout=subprocess.DEVNULL,
+                            stderr=subprocess.PIPE, universal_newlines=True)
+    summary = None
+    for line in proc.stderr:
+        if action and "[host] listening on port" in line:
+            threading.Thread(target=action, args=(web_port,), daemon=True).start()
+            action = None
+        m = SUMMARY.search(line)
+        if m:
+            summary = m.groupdict()
+    code = proc.wait()
+    result = {"exit": code, "elapsed_ms": int((time.time() - start) * 1000)}
+    if summary:
+        result.update(reason=summary["reason"], wall_ms=int(summary["wall"]), rx=int(summary["rx"]),
+                      tx=int(summary["tx"]), connections=int(summary["conn"]), accepted=int(summary["acc"]),
+                      partition=int(summary["part"]))
+    return result
+
+
+def mirror_of(ota_port):
+    return "127.0.0.1:%d" % ota_port
+
+
+def configure(ota_port):
+    """Returns an action posting the OTA settings to /ota/set with restart. A long request
+    first leaves its bytes in the receive buffer of the connection, then the headers and
+    the body of the form are sent as separate segments; otaMirrors is the last value."""
+    def action(web_port):
+        form = urllib.parse.urlencode([
+            ("ssid", "native"), ("password", "native"), ("otaServer", "127.0.0.1"), ("otaPort", ota_port),
+            ("otaEnabled", "1"), ("otaUpdateInterval", "1"), ("webServerPort", "80"), ("restart", "1"),
+            ("otaMirrors", mirror_of(ota_port))], safe=":").encode()  # Unescaped, decoding keeps the length
+        conn = http.client.HTTPConnection("127.0.0.1", web_port, timeout=5)
+        try:
+            conn.request("GET", "/ota?fill=" + "A" * 600)
+            conn.getresponse().read()
+            conn.putrequest("POST", "/ota/set")
+            conn.putheader("Content-Type", "application/x-www-form-urlencoded")
+            conn.putheader("Content-Length", str(len(form)))
+            conn.endheaders()
+            time.sleep(0.2)
+            conn.send(form)
+            conn.getresponse().read()
+        except (OSError, http.client.HTTPException):
+            pass  # The program exits while answering
+        finally:
+            conn.close()
+    return action
+
+
+def stored_mirror(workdir, ota_port):
+    """True if the EEPROM holds the mirror list of the form, terminated where the body ended."""
+    path = os.path.join(workdir, "eeprom.bin")
+    if not os.path.isfile(path):
+        return False
+    with open(path, "rb") as f:
+        return (mirror_of(ota_port) + "\0").encode() in f.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="End-to-end OTA update run with the native build")
+    parser.add_argument("--program", default=DEFAULT_PROGRAM, help="native program (default: %(default)s)")
+    parser.add_argument("--size", type=int, default=512 * 1024, help="firmware image size in bytes")
+    parser.add_argument("--server", choices=("auto", "node", "stub"), default="auto")
+    parser.add_argument("--timeout", type=int, default=60, help="max. seconds per phase")
+    parser.add_argument("--json", action="store_true", help="print the results as JSON")
+    parser.add_argument("--keep", action="store_true", help="keep the working directory")
+    args = parser.parse_args()
+
+    if not os.path.isfile(args.program):
+        sys.exit("%s not found, build it with: pio run -e native" % args.program)
+    program = os.path.abspath(args.program)
+    workdir = tempfile.mkdtemp(prefix="ota_e2e_")
+    updates = os.path.join(workdir, "updates")
+    os.makedirs(updates)
+    image = bytes([0xE9]) + os.urandom(args.size - 1)   # ESP image magic byte first
+    with open(os.path.join(updates, FIRMWARE_NAME), "wb") as f:
+        f.write(image)
+    # The device asks for /version/<current version>.version
+    for version in (FIRMWARE_VERSION, NEW_VERSION):
+        with open(os.path.join(updates, version + ".version"), "w") as f:
+            f.write(NEW_VERSION)
+
+    ota_port = free_port()
+    server_name, stop_server = start_server(args.server, updates, ota_port)
+    web_port = free_port()
+    phases = []
+    try:
+        phases.append(("configure", EXIT_RESTART,
+                       run_program(program, workdir, web_port, args.timeout, configure(ota_port))))
+        form_ok = stored_mirror(workdir, ota_port)
+        phases.append(("update", EXIT_RESTART, run_program(program, workdir, web_port, args.timeout)))
+        phases.append(("up-to-date", EXIT_DONE, run_program(program, workdir, web_port, 3)))
+    finally:
+        stop_server()
+
+    installed = b""
+    if os.path.isfile(os.path.join(workdir, "partition.bin")):
+        with open(os.path.join(workdir, "partition.bin"), "rb") as f:
+            installed = f.read()
+    ok = installed == image and all(r["exit"] == code for _, code, r in phases)
+    ok = ok and phases[2][2].get("partition", -1) == 0 and form_ok
+
+    if args.json:
+        print(json.dumps({"server": server_name, "image": len(image), "ok": ok, "form": form_ok,
+                          "phases": {name: r for name, _, r in phases}}, indent=2))
+    else:
+        print("Server: %s, image %d bytes" % (server_name, len(image)))
+        print("%-11s %5s %9s %10s %10s %11s  %s" % ("phase", "exit", "wall ms", "rx bytes", "tx bytes",
+                                                   "partition", "rate"))
+        for name, code, r in phases:
+            rate = ""
+            if r.get("partition") and r.get("wall_ms"):
+                rate = "%.1f kB/s" % (r["partition"] / 1024.0 / (r["wall_ms"] / 1000.0))
+            print("%-11s %5s %9s %10s %10s %11s  %s%s" % (name, r["exit"], r.get("wall_ms", "-"), r.get("rx", "-"),
+                                                        r.get("tx", "-"), r.get("partition", "-"), rate,
+                                                        "" if r["exit"] == code else "  (expected exit %d)" % code))
+        print("Form in two segments %s" % ("stored" if form_ok else "NOT STORED AS SENT"))
+        print("Installed image %s" % ("matches" if installed == image else "DIFFERS (%d bytes)" % len(installed)))
+        print("PASS" if ok else "FAIL")
+    if args.keep:
+        print("Working directory: %s" % workdir, file=sys.stderr)
+    else:
+        shutil.rmtree(workdir, ignore_errors=True)
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
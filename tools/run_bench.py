@@ -0,0 +1,98 @@
+# run_bench.py
+#
+# Runs the host microbenchmarks (pio run -e native-bench) and compares the results
+# with the stored baseline bench/baseline.json:
+# - allocations and allocated bytes per call are exact and must not increase
+# - flash writes per call must not increase
+# - the time per call may exceed the baseline by at most --time-tolerance (default 2.0x),
+#   as the baseline was recorded on another machine
+# Regressions let the run fail (exit code 1). --update stores the results as new baseline.
+#
+# Usage: python3 tools/run_bench.py [--program PATH] [--filter NAME] [--update] [--json FILE]
+#
+# Author: R. Zuehlsdorff
+# Copyright 2025
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+# See the GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_PROGRAM = os.path.join(ROOT, ".pio", "build", "native-bench", "program")
+BASELINE = os.path.join(ROOT, "bench", "baseline.json")
+EXACT = ("allocs_per_op", "bytes_per_op", "flash_writes_per_op")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the host microbenchmarks and compare with the baseline")
+    parser.add_argument("--program", default=DEFAULT_PROGRAM, help="benchmark program (default: %(default)s)")
+    parser.add_argument("--baseline", default=BASELINE)
+    parser.add_argument("--filter", help="run only benchmarks containing NAME")
+    parser.add_argument("--time-tolerance", type=float, default=2.0, help="allowed time factor vs. baseline")
+    parser.add_argument("--update", action="store_true", help="store the results as new baseline")
+    parser.add_argument("--json", metavar="FILE", help="write the results to FILE")
+    args = parser.parse_args()
+
+    if not os.path.isfile(args.program):
+        sys.exit("%s not found, build it with: pio run -e native-bench" % args.program)
+    cmd = [args.program] + (["--filter", args.filter] if args.filter else [])
+    results = json.loads(subprocess.check_output(cmd, universal_newlines=True))["benchmarks"]
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"benchmarks": results}, f, indent=2)
+
+    if args.update:
+        with open(args.baseline, "w") as f:
+            json.dump({"benchmarks": results}, f, indent=2)
+            f.write("\n")
+        print("Baseline %s updated (%d benchmarks)" % (os.path.relpath(args.baseline), len(results)))
+        return 0
+
+    baseline = {}
+    if os.path.isfile(args.baseline):
+        with open(args.baseline) as f:
+            baseline = {b["name"]: b for b in json.load(f)["benchmarks"]}
+
+    failed = 0
+    print("%-22s %12s %12s %7s %8s %8s  %s" % ("benchmark", "ns/op", "baseline", "ratio", "allocs", "bytes", "result"))
+    for r in results:
+        base = baseline.get(r["name"])
+        problems = []
+        ratio = ""
+        if base:
+            if base["ns_per_op"] > 0:
+                ratio = "%.2fx" % (r["ns_per_op"] / base["ns_per_op"])
+                if r["ns_per_op"] > base["ns_per_op"] * args.time_tolerance:
+                    problems.append("time")
+            for key in EXACT:
+                if r[key] > base.get(key, 0):
+                    problems.append("%s %d > %d" % (key, r[key], base.get(key, 0)))
+        status = "FAIL: " + ", ".join(problems) if problems else ("ok" if base else "new")
+        failed += bool(problems)
+        print("%-22s %12.1f %12s %7s %8d %8d  %s" % (r["name"], r["ns_per_op"],
+                                                     "%.1f" % base["ns_per_op"] if base else "-", ratio,
+                                                     r["allocs_per_op"], r["bytes_per_op"], status))
+    if failed:
+        print("%d benchmark(s) regressed" % failed)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())